@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Timing loop shared by the benchmark examples. A benchmark
+ *         supplies the operation to time; BENCH_RUN() repeats it in
+ *         batches until BENCH_MEASURE_TIME has passed, and the
+ *         functions below turn the count into rates.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include "contiki.h"
+#include "dev/watchdog.h"
+
+/* How long each measurement runs */
+#ifdef BENCH_CONF_MEASURE_TIME
+#define BENCH_MEASURE_TIME BENCH_CONF_MEASURE_TIME
+#else /* BENCH_CONF_MEASURE_TIME */
+#define BENCH_MEASURE_TIME (CLOCK_SECOND / 2)
+#endif /* BENCH_CONF_MEASURE_TIME */
+
+/* Operations between reads of the clock */
+#ifdef BENCH_CONF_BATCH
+#define BENCH_BATCH BENCH_CONF_BATCH
+#else /* BENCH_CONF_BATCH */
+#define BENCH_BATCH 32
+#endif /* BENCH_CONF_BATCH */
+
+struct bench {
+  unsigned long ops;
+  clock_time_t elapsed;
+};
+
+/**
+ * Runs op BENCH_BATCH times per batch until BENCH_MEASURE_TIME has
+ * passed. In op, i counts from 0 within the batch and (b)->ops + i is
+ * the number of the operation since the start.
+ */
+#define BENCH_RUN(b, i, op)                                     \
+  do {                                                          \
+    clock_time_t bench_start_;                                  \
+    (b)->ops = 0;                                               \
+    bench_start_ = clock_time();                                \
+    do {                                                        \
+      for((i) = 0; (i) < BENCH_BATCH; (i)++) {                  \
+        op;                                                     \
+      }                                                         \
+      (b)->ops += BENCH_BATCH;                                  \
+      watchdog_periodic();                                      \
+      (b)->elapsed = clock_time() - bench_start_;               \
+    } while((b)->elapsed < BENCH_MEASURE_TIME);                 \
+  } while(0)
+
+/** Operations, or units when each operation handles that many, per second */
+unsigned long bench_per_second(const struct bench *b, unsigned long units);
+
+/** Nanoseconds per operation */
+unsigned long bench_ns_per_op(const struct bench *b);
+
+#endif /* BENCH_H_ */
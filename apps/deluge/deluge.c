@@ -71,6 +71,7 @@ static struct broadcast_conn deluge_broadcast;
 static struct unicast_conn deluge_uc;
 static struct deluge_object current_object;
 static process_event_t deluge_event;
+static void (*complete_callback)(unsigned version);
 
 /* Deluge variables. */
 static int deluge_state;
@@ -247,7 +248,8 @@ send_request(void *arg)
   request.cmd = DELUGE_CMD_REQUEST;
   request.pagenum = obj->current_rx_page;
   request.version = obj->pages[request.pagenum].version;
-  request.request_set = ~obj->pages[obj->current_rx_page].packet_set;
+  request.request_set = ~obj->pages[obj->current_rx_page].packet_set &
+    ALL_PACKETS;
   request.object_id = obj->object_id;
 
   PRINTF("Sending request for page %d, version %u, request_set %u\n", 
@@ -296,6 +298,11 @@ handle_summary(struct deluge_msg_summary *msg, const linkaddr_t *sender)
 
   highest_available = highest_available_page(&current_object);
 
+  if(linkaddr_cmp(sender, &current_object.summary_from) &&
+     msg->highest_available > current_object.remote_available) {
+    current_object.remote_available = msg->highest_available;
+  }
+
   if(msg->version != current_object.version ||
       msg->highest_available != highest_available) {
     neighbor_inconsistency = 1;
@@ -322,7 +329,7 @@ handle_summary(struct deluge_msg_summary *msg, const linkaddr_t *sender)
       if(page->last_request < oldest_request) {
 	oldest_request = page->last_request;
       }
-      if(page->last_request < oldest_data) {
+      if(page->last_data < oldest_data) {
 	oldest_data = page->last_data;
       }
     }
@@ -333,6 +340,7 @@ handle_summary(struct deluge_msg_summary *msg, const linkaddr_t *sender)
     }
 
     linkaddr_copy(&current_object.summary_from, sender);
+    current_object.remote_available = msg->highest_available;
     transition(DELUGE_STATE_RX);
 
     if(ctimer_expired(&rx_timer)) {
@@ -361,7 +369,7 @@ send_page(struct deluge_object *obj, unsigned pagenum)
 
   /* Divide the page into packets and send them one at a time. */
   for(cp = buf; cp + S_PKT <= (unsigned char *)&buf[S_PAGE]; cp += S_PKT) {
-    if(obj->tx_set & (1 << pkt.packetnum)) {
+    if(obj->tx_set & ((deluge_packet_set_t)1 << pkt.packetnum)) {
       pkt.crc = crc16_data(cp, S_PKT, 0);
       memcpy(pkt.payload, cp, S_PKT);
       packetbuf_copyfrom(&pkt, sizeof(pkt));
@@ -389,7 +397,9 @@ tx_callback(void *arg)
       packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
 			 PACKETBUF_ATTR_PACKET_TYPE_STREAM_END);
       obj->current_tx_page = -1;
-      transition(DELUGE_STATE_MAINTAIN);
+      if(deluge_state == DELUGE_STATE_TX) {
+	transition(DELUGE_STATE_MAINTAIN);
+      }
     }
   }
 }
@@ -397,6 +407,7 @@ tx_callback(void *arg)
 static void
 handle_request(struct deluge_msg_request *msg)
 {
+  struct deluge_page *page;
   int highest_available;
 
   if(msg->pagenum >= OBJECT_PAGE_COUNT(current_object)) {
@@ -408,10 +419,14 @@ handle_request(struct deluge_msg_request *msg)
   }
 
   highest_available = highest_available_page(&current_object);
-
-  /* Deluge M.6 */
-  if(msg->version == current_object.version &&
-      msg->pagenum <= highest_available) {
+  page = &current_object.pages[msg->pagenum];
+
+  /* Deluge M.6. The page itself must be complete in the requested
+     version: a node that is still receiving an update keeps the old
+     object version, but can already serve the new pages it has.
+     highest_available is the first incomplete page. */
+  if(msg->version == page->version && (page->flags & PAGE_COMPLETE) &&
+      msg->pagenum < highest_available) {
     current_object.pages[msg->pagenum].last_request = clock_time();
 
     /* Deluge T.1 */
@@ -422,11 +437,27 @@ handle_request(struct deluge_msg_request *msg)
       current_object.tx_set = msg->request_set;
     }
 
-    transition(DELUGE_STATE_TX);
+    /* A node that is still receiving later pages keeps its request
+       timer running while it serves the pages it already has, so that
+       different pages travel over different hops at the same time. */
+    if(deluge_state != DELUGE_STATE_RX) {
+      transition(DELUGE_STATE_TX);
+    }
     ctimer_set(&tx_timer, CLOCK_SECOND, tx_callback, &current_object);
   }
 }
 
+static void
+announce_page(struct deluge_object *obj)
+{
+  /* Advertise the new page soon instead of at the end of the round,
+     so that neighbors further away can start requesting it. */
+  neighbor_inconsistency = 1;
+  recv_adv = 0;
+  ctimer_set(&summary_timer, (unsigned)random_rand() % T_R,
+	(void *)(void *)advertise_summary, obj);
+}
+
 static void
 handle_packet(struct deluge_msg_packet *msg)
 {
@@ -440,7 +471,8 @@ handle_packet(struct deluge_msg_packet *msg)
 	(unsigned)packet.object_id, (unsigned)packet.version,
 	(unsigned)packet.pagenum, (unsigned)packet.packetnum);
 
-  if(packet.pagenum != current_object.current_rx_page) {
+  if(packet.pagenum != current_object.current_rx_page ||
+     packet.packetnum >= N_PKT) {
     return;
   }
 
@@ -450,17 +482,19 @@ handle_packet(struct deluge_msg_packet *msg)
 
   page = &current_object.pages[packet.pagenum];
   if(packet.version == page->version && !(page->flags & PAGE_COMPLETE)) {
-    memcpy(&current_object.current_page[S_PKT * packet.packetnum],
-	packet.payload, S_PKT);
-
     crc = crc16_data(packet.payload, S_PKT, 0);
     if(packet.crc != crc) {
       PRINTF("packet crc: %hu, calculated crc: %hu\n", packet.crc, crc);
       return;
     }
 
+    /* Packets are collected in RAM and the page is written to the
+       file system in one operation once it is complete. */
+    memcpy(&current_object.current_page[S_PKT * packet.packetnum],
+	packet.payload, S_PKT);
+
     page->last_data = clock_time();
-    page->packet_set |= (1 << packet.packetnum);
+    page->packet_set |= (deluge_packet_set_t)1 << packet.packetnum;
 
     if(page->packet_set == ALL_PACKETS) {
       /* This is the last packet of the requested page; stop streaming. */
@@ -473,21 +507,31 @@ handle_packet(struct deluge_msg_packet *msg)
       PRINTF("Page %u completed\n", packet.pagenum);
 
       current_object.current_rx_page++;
+      current_object.nrequests = 0;
 
-      if(packet.pagenum == OBJECT_PAGE_COUNT(current_object) - 1) {
+      if(highest_available_page(&current_object) ==
+	 OBJECT_PAGE_COUNT(current_object)) {
 	current_object.version = current_object.update_version;
 	leds_on(LEDS_RED);
 	PRINTF("Update completed for object %u, version %u\n", 
 	       (unsigned)current_object.object_id, packet.version);
-      } else if(current_object.current_rx_page < OBJECT_PAGE_COUNT(current_object)) {
-        if(ctimer_expired(&rx_timer)) {
-	  ctimer_set(&rx_timer,
-		CONST_OMEGA * ESTIMATED_TX_TIME + (random_rand() % T_R),
-		send_request, &current_object);
+	if(complete_callback != NULL) {
+	  complete_callback(current_object.version);
 	}
+	/* Deluge R.3 */
+	transition(DELUGE_STATE_MAINTAIN);
+      } else if(current_object.current_rx_page <
+		current_object.remote_available) {
+	/* The neighbor that served this page has the next one as well;
+	   request it right away instead of waiting for a new summary. */
+	transition(DELUGE_STATE_RX);
+	ctimer_set(&rx_timer, (unsigned)random_rand() % T_PIPELINE,
+		   send_request, &current_object);
+      } else {
+	/* Deluge R.3 */
+	transition(DELUGE_STATE_MAINTAIN);
       }
-      /* Deluge R.3 */
-      transition(DELUGE_STATE_MAINTAIN);
+      announce_page(&current_object);
     } else {
       /* More packets to come. Put lower layers in streaming mode. */
       packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
@@ -626,6 +670,12 @@ broadcast_recv(struct broadcast_conn *c, const linkaddr_t *sender)
   command_dispatcher(sender);
 }
 
+void
+deluge_set_callback(void (*callback)(unsigned version))
+{
+  complete_callback = callback;
+}
+
 int
 deluge_disseminate(char *file, unsigned version)
 {
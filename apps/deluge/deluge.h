@@ -61,9 +61,25 @@ PROCESS_NAME(deluge_process);
 #define PAGE_AVAILABLE	1
 
 #define S_PKT		64		/* Deluge packet size. */
+#ifdef DELUGE_CONF_PACKETS_PER_PAGE
+#define N_PKT		DELUGE_CONF_PACKETS_PER_PAGE
+#else
 #define N_PKT		4		/* Packets per page. */
+#endif
 #define S_PAGE		(S_PKT * N_PKT)	/* Fixed page size. */
 
+/* Bitmap with one bit per packet in a page. Requests carry the
+   bitmap of missing packets so that only those are retransmitted. */
+#if N_PKT <= 8
+typedef uint8_t deluge_packet_set_t;
+#elif N_PKT <= 16
+typedef uint16_t deluge_packet_set_t;
+#elif N_PKT <= 32
+typedef uint32_t deluge_packet_set_t;
+#else
+#error "Deluge supports at most 32 packets per page"
+#endif
+
 /* Bounds for the round time in seconds. */
 #define T_LOW		2
 #define T_HIGH		64
@@ -71,13 +87,18 @@ PROCESS_NAME(deluge_process);
 /* Random interval for request transmissions in jiffies. */
 #define T_R		(CLOCK_SECOND * 2)
 
+/* Random interval before requesting the next page from a neighbor
+   that is known to have it, in jiffies. */
+#define T_PIPELINE	(CLOCK_SECOND / 2)
+
 /* Bound for the number of advertisements. */
 #define CONST_K		1
 
 /* The number of pages in this object. */
 #define OBJECT_PAGE_COUNT(obj)	(((obj).size + (S_PAGE - 1)) / S_PAGE)
 
-#define ALL_PACKETS		((1 << N_PKT) - 1)
+#define ALL_PACKETS \
+  ((deluge_packet_set_t)(((uint32_t)1 << (N_PKT - 1)) * 2 - 1))
 
 #define DELUGE_CMD_SUMMARY	1
 #define DELUGE_CMD_REQUEST	2
@@ -107,7 +128,7 @@ struct deluge_msg_request {
   uint8_t cmd;
   uint8_t version;
   uint8_t pagenum;
-  uint8_t request_set;
+  deluge_packet_set_t request_set;
   deluge_object_id_t object_id;
 };
 
@@ -140,13 +161,15 @@ struct deluge_object {
   int8_t current_tx_page;
   uint8_t nrequests;
   uint8_t current_page[S_PAGE];
-  uint8_t tx_set;
+  deluge_packet_set_t tx_set;
   int cfs_fd;
   linkaddr_t summary_from;
+  /* Highest available page advertised by summary_from. */
+  uint8_t remote_available;
 };
 
 struct deluge_page {
-  uint32_t packet_set;
+  deluge_packet_set_t packet_set;
   uint16_t crc;
   clock_time_t last_request;
   clock_time_t last_data;
@@ -156,4 +179,8 @@ struct deluge_page {
 
 int deluge_disseminate(char *file, unsigned version);
 
+/* Called once every page of the object has been received in a new
+   version, and the whole file holds that version. */
+void deluge_set_callback(void (*callback)(unsigned version));
+
 #endif
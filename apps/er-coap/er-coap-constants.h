@@ -160,7 +160,8 @@ typedef enum {
   APPLICATION_FASTINFOSET = 48,
   APPLICATION_SOAP_FASTINFOSET = 49,
   APPLICATION_JSON = 50,
-  APPLICATION_X_OBIX_BINARY = 51
+  APPLICATION_X_OBIX_BINARY = 51,
+  APPLICATION_CBOR = 60
 } coap_content_format_t;
 
 #endif /* ER_COAP_CONSTANTS_H_ */
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         A compact CBOR (RFC 7049) encoder and decoder.
+ */
+
+#include "cbor.h"
+#include <limits.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+void
+cbor_write_head(int (* putchar)(int), uint8_t major, uint32_t value)
+{
+  int bytes;
+
+  if(value < 24) {
+    putchar(major | value);
+    return;
+  }
+  if(value <= 0xff) {
+    putchar(major | 24);
+    bytes = 1;
+  } else if(value <= 0xffff) {
+    putchar(major | 25);
+    bytes = 2;
+  } else {
+    putchar(major | 26);
+    bytes = 4;
+  }
+  while(bytes-- > 0) {
+    putchar((value >> (bytes * 8)) & 0xff);
+  }
+}
+/*--------------------------------------------------------------------*/
+void
+cbor_write_int(int (* putchar)(int), int32_t value)
+{
+  if(value < 0) {
+    cbor_write_head(putchar, CBOR_MAJOR_NEGINT, -1 - value);
+  } else {
+    cbor_write_head(putchar, CBOR_MAJOR_UINT, value);
+  }
+}
+/*--------------------------------------------------------------------*/
+void
+cbor_write_text(int (* putchar)(int), const char *text)
+{
+  if(text == NULL) {
+    text = "";
+  }
+  cbor_write_head(putchar, CBOR_MAJOR_TEXT, strlen(text));
+  while(*text != '\0') {
+    putchar(*text++);
+  }
+}
+/*--------------------------------------------------------------------*/
+static int
+fail(struct cbor_state *state, char error)
+{
+  state->error = error;
+  return JSON_TYPE_ERROR;
+}
+/*--------------------------------------------------------------------*/
+/* reads the head of an item, with a value of at most 32 bits */
+static int
+read_head(struct cbor_state *state, uint8_t *major, uint32_t *value)
+{
+  uint8_t info;
+  int bytes;
+
+  if(state->pos >= state->len) {
+    return 0;
+  }
+  *major = state->cbor[state->pos] & 0xe0;
+  info = state->cbor[state->pos++] & 0x1f;
+  if(info < 24) {
+    *value = info;
+    return 1;
+  }
+  if(info > 26) {
+    /* 64 bit values and indefinite lengths */
+    return 0;
+  }
+  bytes = 1 << (info - 24);
+  if(state->len - state->pos < bytes) {
+    return 0;
+  }
+  *value = 0;
+  while(bytes-- > 0) {
+    *value = (*value << 8) | state->cbor[state->pos++];
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static int
+read_int(struct cbor_state *state, int32_t *value)
+{
+  uint8_t major;
+  uint32_t v;
+
+  if(!read_head(state, &major, &v) || v > INT32_MAX) {
+    return 0;
+  }
+  if(major == CBOR_MAJOR_UINT) {
+    *value = v;
+  } else if(major == CBOR_MAJOR_NEGINT) {
+    *value = -1 - (int32_t)v;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+void
+cbor_setup(struct cbor_state *state, const uint8_t *cbor, int len)
+{
+  state->cbor = cbor;
+  state->len = len;
+  state->pos = 0;
+  state->depth = 0;
+  state->vtype = 0;
+  state->error = 0;
+}
+/*--------------------------------------------------------------------*/
+int
+cbor_next(struct cbor_state *state)
+{
+  uint8_t major;
+  uint32_t value;
+  int32_t exponent;
+  uint8_t name;
+  int start;
+  int type;
+
+  state->vtype = 0;
+  if(state->error) {
+    return JSON_TYPE_ERROR;
+  }
+
+  if(state->depth > 0 && state->remaining[state->depth - 1] == 0) {
+    state->depth--;
+    return state->stack[state->depth] + 2;
+  }
+  if(state->pos >= state->len) {
+    return state->depth > 0 ? fail(state, JSON_ERROR_SYNTAX) : 0;
+  }
+
+  name = 0;
+  if(state->depth > 0) {
+    name = state->stack[state->depth - 1] == JSON_TYPE_OBJECT &&
+      (state->remaining[state->depth - 1] & 1) == 0;
+    state->remaining[state->depth - 1]--;
+  }
+
+  do {
+    start = state->pos;
+    if(!read_head(state, &major, &value)) {
+      return fail(state, JSON_ERROR_SYNTAX);
+    }
+  } while(major == CBOR_MAJOR_TAG && value != CBOR_TAG_DECIMAL_FRACTION);
+
+  switch(major) {
+  case CBOR_MAJOR_UINT:
+  case CBOR_MAJOR_NEGINT:
+    state->pos = start;
+    if(!read_int(state, &state->value)) {
+      return fail(state, JSON_ERROR_SYNTAX);
+    }
+    state->exponent = 0;
+    type = JSON_TYPE_NUMBER;
+    break;
+  case CBOR_MAJOR_TAG:
+    /* a decimal fraction */
+    if(!read_head(state, &major, &value) ||
+       major != CBOR_MAJOR_ARRAY || value != 2 ||
+       !read_int(state, &exponent) || !read_int(state, &state->value) ||
+       exponent < -128 || exponent > 127) {
+      return fail(state, JSON_ERROR_SYNTAX);
+    }
+    state->exponent = exponent;
+    type = JSON_TYPE_NUMBER;
+    break;
+  case CBOR_MAJOR_BYTES:
+  case CBOR_MAJOR_TEXT:
+    if(value > state->len - state->pos) {
+      return fail(state, JSON_ERROR_SYNTAX);
+    }
+    state->vstart = state->pos;
+    state->vlen = value;
+    state->pos += value;
+    type = name ? JSON_TYPE_PAIR_NAME : JSON_TYPE_STRING;
+    break;
+  case CBOR_MAJOR_ARRAY:
+  case CBOR_MAJOR_MAP:
+    if(name || state->depth >= CBOR_MAX_DEPTH ||
+       value > (major == CBOR_MAJOR_MAP ? 0x7fff : 0xffff)) {
+      return fail(state, major == CBOR_MAJOR_MAP ?
+                  JSON_ERROR_UNEXPECTED_OBJECT :
+                  JSON_ERROR_UNEXPECTED_ARRAY);
+    }
+    if(major == CBOR_MAJOR_MAP) {
+      state->stack[state->depth] = JSON_TYPE_OBJECT;
+      state->remaining[state->depth] = value * 2;
+    } else {
+      state->stack[state->depth] = JSON_TYPE_ARRAY;
+      state->remaining[state->depth] = value;
+    }
+    return state->stack[state->depth++];
+  default:
+    /* simple values and floating point numbers */
+    if(state->cbor[start] == CBOR_FALSE) {
+      type = JSON_TYPE_FALSE;
+    } else if(state->cbor[start] == CBOR_TRUE) {
+      type = JSON_TYPE_TRUE;
+    } else if(state->cbor[start] == CBOR_NULL) {
+      type = JSON_TYPE_NULL;
+    } else {
+      return fail(state, JSON_ERROR_SYNTAX);
+    }
+    break;
+  }
+
+  if(name && type != JSON_TYPE_PAIR_NAME) {
+    /* only text names are supported */
+    return fail(state, JSON_ERROR_SYNTAX);
+  }
+  state->vtype = type;
+  return type;
+}
+/*--------------------------------------------------------------------*/
+int
+cbor_copy_value(struct cbor_state *state, char *str, int size)
+{
+  int i;
+
+  if(state->vtype != JSON_TYPE_STRING && state->vtype != JSON_TYPE_PAIR_NAME) {
+    return 0;
+  }
+  if(size <= 0) {
+    return state->vtype;
+  }
+  size = size <= state->vlen ? (size - 1) : state->vlen;
+  for(i = 0; i < size; i++) {
+    str[i] = state->cbor[state->vstart + i];
+  }
+  str[i] = 0;
+  return state->vtype;
+}
+/*--------------------------------------------------------------------*/
+int
+cbor_get_value_as_int(struct cbor_state *state)
+{
+  int32_t value;
+  int exponent;
+
+  if(state->vtype != JSON_TYPE_NUMBER) {
+    return 0;
+  }
+  value = state->value;
+  for(exponent = state->exponent; exponent < 0 && value != 0; exponent++) {
+    value /= 10;
+  }
+  /* Large numbers saturate instead of overflowing */
+  for(; exponent > 0 && value != 0; exponent--) {
+    if(value > INT_MAX / 10) {
+      return INT_MAX;
+    } else if(value < INT_MIN / 10) {
+      return INT_MIN;
+    }
+    value *= 10;
+  }
+  if(value > INT_MAX) {
+    return INT_MAX;
+  } else if(value < INT_MIN) {
+    return INT_MIN;
+  }
+  return value;
+}
+/*--------------------------------------------------------------------*/
+int
+cbor_get_len(struct cbor_state *state)
+{
+  return state->vtype == JSON_TYPE_STRING ||
+    state->vtype == JSON_TYPE_PAIR_NAME ? state->vlen : 0;
+}
+/*--------------------------------------------------------------------*/
+int
+cbor_strcmp_value(struct cbor_state *state, const char *str)
+{
+  if(state->vtype != JSON_TYPE_STRING && state->vtype != JSON_TYPE_PAIR_NAME) {
+    return -1;
+  }
+  return strncmp(str, (const char *)&state->cbor[state->vstart], state->vlen);
+}
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         A compact CBOR (RFC 7049) encoder and decoder.
+ *
+ *         The encoder writes through a putchar function, like
+ *         jsontree, and jsontree uses it to write its value trees as
+ *         CBOR. The decoder returns the same token types as
+ *         jsonparse, so code that reads JSON with jsonparse can read
+ *         CBOR by calling the cbor_ functions instead.
+ */
+
+#ifndef CBOR_H_
+#define CBOR_H_
+
+#include "contiki-conf.h"
+#include "json.h"
+
+#ifdef CBOR_CONF_MAX_DEPTH
+#define CBOR_MAX_DEPTH CBOR_CONF_MAX_DEPTH
+#else
+#define CBOR_MAX_DEPTH 10
+#endif
+
+/* Major types, in the top three bits of the first byte of an item */
+#define CBOR_MAJOR_UINT   0x00
+#define CBOR_MAJOR_NEGINT 0x20
+#define CBOR_MAJOR_BYTES  0x40
+#define CBOR_MAJOR_TEXT   0x60
+#define CBOR_MAJOR_ARRAY  0x80
+#define CBOR_MAJOR_MAP    0xa0
+#define CBOR_MAJOR_TAG    0xc0
+#define CBOR_MAJOR_SIMPLE 0xe0
+
+#define CBOR_FALSE 0xf4
+#define CBOR_TRUE  0xf5
+#define CBOR_NULL  0xf6
+
+/* Tag of a decimal fraction, an array of an exponent and a mantissa */
+#define CBOR_TAG_DECIMAL_FRACTION 4
+
+struct cbor_state {
+  const uint8_t *cbor;
+  int pos;
+  int len;
+  int depth;
+  /* for handling atomic values */
+  int vstart;
+  int vlen;
+  int32_t value;
+  int8_t exponent;
+  char vtype;
+  char error;
+  char stack[CBOR_MAX_DEPTH];
+  /* items left in each array or map, counting names and values */
+  uint16_t remaining[CBOR_MAX_DEPTH];
+};
+
+/**
+ * \brief      Write the head of an item.
+ * \param putchar The function that writes a byte
+ * \param major One of the CBOR_MAJOR_ types
+ * \param value The value, length or number of items
+ */
+void cbor_write_head(int (* putchar)(int), uint8_t major, uint32_t value);
+
+/**
+ * \brief      Write an integer.
+ * \param putchar The function that writes a byte
+ * \param value The integer
+ */
+void cbor_write_int(int (* putchar)(int), int32_t value);
+
+/**
+ * \brief      Write a text string.
+ * \param putchar The function that writes a byte
+ * \param text The text, which may be NULL for an empty string
+ */
+void cbor_write_text(int (* putchar)(int), const char *text);
+
+/**
+ * \brief      Initialize a CBOR parser state.
+ * \param state A pointer to a CBOR parser state
+ * \param cbor The data to parse as CBOR
+ * \param len  The length of the data
+ *
+ *             Items of indefinite length and floating point numbers
+ *             are not supported and end parsing with an error.
+ */
+void cbor_setup(struct cbor_state *state, const uint8_t *cbor, int len);
+
+/**
+ * \brief      Move to the next item.
+ * \param state A pointer to a CBOR parser state
+ * \return     The type of the item as for jsonparse_next(), 0 at the
+ *             end of the data or JSON_TYPE_ERROR with state->error set
+ *
+ *             Maps are returned as JSON_TYPE_OBJECT followed by
+ *             JSON_TYPE_PAIR_NAME and value pairs, and '}' after the
+ *             last pair. Arrays are returned as JSON_TYPE_ARRAY
+ *             followed by the values and ']'. Integers and decimal
+ *             fractions are returned as JSON_TYPE_NUMBER, text and
+ *             byte strings as JSON_TYPE_STRING. Other tags are
+ *             skipped.
+ */
+int cbor_next(struct cbor_state *state);
+
+/* copy the current string value into the specified buffer */
+int cbor_copy_value(struct cbor_state *state, char *buf, int buf_size);
+
+/* get the current number, without any fraction, as an int; numbers
+   outside the range of an int saturate */
+int cbor_get_value_as_int(struct cbor_state *state);
+
+/* get the length of the current string value */
+int cbor_get_len(struct cbor_state *state);
+
+/* compare the current string value with the specified string */
+int cbor_strcmp_value(struct cbor_state *state, const char *str);
+
+#endif /* CBOR_H_ */
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         A streaming JSON tokenizer with event callbacks.
+ */
+
+#include "jsonsax.h"
+#include <string.h>
+
+enum {
+  STATE_VALUE,
+  STATE_VALUE_OR_END,
+  STATE_NAME,
+  STATE_NAME_OR_END,
+  STATE_COLON,
+  STATE_NEXT,
+  STATE_STRING,
+  STATE_NAME_STRING,
+  STATE_NUMBER,
+  STATE_TRUE,
+  STATE_FALSE,
+  STATE_NULL,
+  STATE_DONE,
+  STATE_ERROR
+};
+
+static const char *const literals[] = { "true", "false", "null" };
+static const char literal_types[] = {
+  JSON_TYPE_TRUE, JSON_TYPE_FALSE, JSON_TYPE_NULL
+};
+/*---------------------------------------------------------------------------*/
+static void
+emit(struct jsonsax_state *state, int type, const char *value, int len,
+     uint8_t partial)
+{
+  state->partial = partial;
+  state->callback(state, type, value, len);
+}
+/*---------------------------------------------------------------------------*/
+static int
+fail(struct jsonsax_state *state, char error)
+{
+  state->error = error;
+  state->state = STATE_ERROR;
+  return error;
+}
+/*---------------------------------------------------------------------------*/
+static int
+in_object(struct jsonsax_state *state)
+{
+  return state->stack[(state->depth - 1) >> 3] & (1 << ((state->depth - 1) & 7));
+}
+/*---------------------------------------------------------------------------*/
+static void
+value_done(struct jsonsax_state *state)
+{
+  state->state = state->depth == 0 ? STATE_DONE : STATE_NEXT;
+}
+/*---------------------------------------------------------------------------*/
+static int
+push(struct jsonsax_state *state, char c)
+{
+  uint8_t bit;
+
+  if(state->depth >= JSONSAX_MAX_DEPTH) {
+    return fail(state, JSON_ERROR_SYNTAX);
+  }
+  bit = 1 << (state->depth & 7);
+  if(c == JSON_TYPE_OBJECT) {
+    state->stack[state->depth >> 3] |= bit;
+    state->state = STATE_NAME_OR_END;
+  } else {
+    state->stack[state->depth >> 3] &= ~bit;
+    state->state = STATE_VALUE_OR_END;
+  }
+  state->depth++;
+  emit(state, c, NULL, 0, 0);
+  return JSON_ERROR_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+pop(struct jsonsax_state *state, char c)
+{
+  if(state->depth == 0 || !in_object(state) != (c == JSONSAX_END_ARRAY)) {
+    return fail(state, c == JSONSAX_END_ARRAY ?
+                JSON_ERROR_UNEXPECTED_END_OF_ARRAY : JSON_ERROR_SYNTAX);
+  }
+  state->depth--;
+  emit(state, c, NULL, 0, 0);
+  value_done(state);
+  return JSON_ERROR_OK;
+}
+/*---------------------------------------------------------------------------*/
+/* Starts the value that begins with c */
+static int
+value(struct jsonsax_state *state, char c)
+{
+  switch(c) {
+  case '{':
+  case '[':
+    return push(state, c);
+  case '"':
+    state->state = STATE_STRING;
+    state->progress = 0;
+    return JSON_ERROR_OK;
+  case 't':
+  case 'f':
+  case 'n':
+    state->state = c == 't' ? STATE_TRUE : c == 'f' ? STATE_FALSE : STATE_NULL;
+    state->progress = 1;
+    return JSON_ERROR_OK;
+  default:
+    if(c == '-' || (c >= '0' && c <= '9')) {
+      state->state = STATE_NUMBER;
+      return JSON_ERROR_OK;
+    }
+  }
+  return fail(state, JSON_ERROR_SYNTAX);
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_number_char(char c)
+{
+  return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+    c == 'e' || c == 'E';
+}
+/*---------------------------------------------------------------------------*/
+void
+jsonsax_setup(struct jsonsax_state *state, jsonsax_callback_t callback,
+              void *ptr)
+{
+  state->callback = callback;
+  state->ptr = ptr;
+  state->partial = 0;
+  state->state = STATE_VALUE;
+  state->depth = 0;
+  state->progress = 0;
+  state->error = JSON_ERROR_OK;
+}
+/*---------------------------------------------------------------------------*/
+int
+jsonsax_feed(struct jsonsax_state *state, const char *json, int len)
+{
+  const char *p, *end, *start;
+  const char *literal;
+  char c;
+
+  p = json;
+  end = json + len;
+
+  while(p < end) {
+    switch(state->state) {
+    case STATE_STRING:
+    case STATE_NAME_STRING:
+      start = p;
+      if(state->progress) {
+        /* The backslash ended the last chunk */
+        state->progress = 0;
+        p++;
+      }
+      while(p < end && *p != '"') {
+        if(*p++ == '\\') {
+          if(p == end) {
+            state->progress = 1;
+            break;
+          }
+          p++;
+        }
+      }
+      c = state->state == STATE_STRING ? JSON_TYPE_STRING : JSON_TYPE_PAIR_NAME;
+      if(p >= end) {
+        if(p > start) {
+          emit(state, c, start, end - start, 1);
+        }
+        return JSON_ERROR_OK;
+      }
+      emit(state, c, start, p - start, 0);
+      p++;
+      if(c == JSON_TYPE_PAIR_NAME) {
+        state->state = STATE_COLON;
+      } else {
+        value_done(state);
+      }
+      continue;
+
+    case STATE_NUMBER:
+      start = p;
+      while(p < end && is_number_char(*p)) {
+        p++;
+      }
+      if(p == end) {
+        if(p > start) {
+          emit(state, JSON_TYPE_NUMBER, start, p - start, 1);
+        }
+        return JSON_ERROR_OK;
+      }
+      /* The character after the number is handled below */
+      emit(state, JSON_TYPE_NUMBER, start, p - start, 0);
+      value_done(state);
+      continue;
+
+    case STATE_TRUE:
+    case STATE_FALSE:
+    case STATE_NULL:
+      literal = literals[state->state - STATE_TRUE];
+      if(*p++ != literal[state->progress++]) {
+        return fail(state, JSON_ERROR_SYNTAX);
+      }
+      if(literal[state->progress] == '\0') {
+        emit(state, literal_types[state->state - STATE_TRUE], literal,
+             state->progress, 0);
+        value_done(state);
+      }
+      continue;
+
+    case STATE_ERROR:
+      return state->error;
+    }
+
+    c = *p++;
+    if(c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+      continue;
+    }
+
+    switch(state->state) {
+    case STATE_VALUE_OR_END:
+      if(c == JSONSAX_END_ARRAY) {
+        pop(state, c);
+        break;
+      }
+      /* Fall through */
+    case STATE_VALUE:
+      value(state, c);
+      if(state->state == STATE_NUMBER) {
+        /* Let the number include its first character */
+        p--;
+      }
+      break;
+    case STATE_NAME_OR_END:
+      if(c == JSONSAX_END_OBJECT) {
+        pop(state, c);
+        break;
+      }
+      /* Fall through */
+    case STATE_NAME:
+      if(c == '"') {
+        state->state = STATE_NAME_STRING;
+        state->progress = 0;
+      } else {
+        fail(state, JSON_ERROR_SYNTAX);
+      }
+      break;
+    case STATE_COLON:
+      if(c == ':') {
+        state->state = STATE_VALUE;
+      } else {
+        fail(state, JSON_ERROR_SYNTAX);
+      }
+      break;
+    case STATE_NEXT:
+      if(c == ',') {
+        state->state = in_object(state) ? STATE_NAME : STATE_VALUE;
+      } else if(c == JSONSAX_END_OBJECT || c == JSONSAX_END_ARRAY) {
+        pop(state, c);
+      } else {
+        fail(state, JSON_ERROR_SYNTAX);
+      }
+      break;
+    default:
+      /* Something after the value */
+      fail(state, JSON_ERROR_SYNTAX);
+      break;
+    }
+  }
+  return state->error;
+}
+/*---------------------------------------------------------------------------*/
+int
+jsonsax_end(struct jsonsax_state *state)
+{
+  if(state->state == STATE_NUMBER) {
+    emit(state, JSON_TYPE_NUMBER, "", 0, 0);
+    value_done(state);
+  }
+  if(state->state != STATE_DONE && state->error == JSON_ERROR_OK) {
+    fail(state, JSON_ERROR_SYNTAX);
+  }
+  return state->error;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         A streaming JSON tokenizer with event callbacks.
+ *
+ *         The input is given in chunks of any size, for example one
+ *         per CoAP block or TCP segment, and is not copied. Each
+ *         value is passed to a callback as a slice of the current
+ *         chunk, so a string or number that continues in the next
+ *         chunk is passed in parts.
+ */
+
+#ifndef JSONSAX_H_
+#define JSONSAX_H_
+
+#include "contiki-conf.h"
+#include "json.h"
+
+#ifdef JSONSAX_CONF_MAX_DEPTH
+#define JSONSAX_MAX_DEPTH JSONSAX_CONF_MAX_DEPTH
+#else
+#define JSONSAX_MAX_DEPTH 32
+#endif
+
+/* Events besides the JSON_TYPE_ values */
+#define JSONSAX_END_OBJECT '}'
+#define JSONSAX_END_ARRAY  ']'
+
+struct jsonsax_state;
+
+/**
+ * \brief      Called for each token.
+ * \param state The parser state
+ * \param type  JSON_TYPE_OBJECT or JSON_TYPE_ARRAY when one starts,
+ *              JSONSAX_END_OBJECT or JSONSAX_END_ARRAY when it ends,
+ *              JSON_TYPE_PAIR_NAME for a name in an object, or
+ *              JSON_TYPE_STRING, JSON_TYPE_NUMBER, JSON_TYPE_TRUE,
+ *              JSON_TYPE_FALSE or JSON_TYPE_NULL for a value
+ * \param value The text of a name or value, without quotes and with
+ *              escapes as they are, or NULL
+ * \param len   The length of the text
+ *
+ *             When state->partial is set, the text continues in the
+ *             next call, which has the same type.
+ */
+typedef void (* jsonsax_callback_t)(struct jsonsax_state *state, int type,
+                                    const char *value, int len);
+
+struct jsonsax_state {
+  jsonsax_callback_t callback;
+  /* for use by the callback */
+  void *ptr;
+  /* set when the text of the current event continues in the next one */
+  uint8_t partial;
+  uint8_t state;
+  uint8_t depth;
+  /* after a backslash in a string, or the characters of true, false
+     or null seen */
+  uint8_t progress;
+  char error;
+  /* one bit per level, set for objects */
+  uint8_t stack[(JSONSAX_MAX_DEPTH + 7) / 8];
+};
+
+/**
+ * \brief      Initialize a streaming JSON parser state.
+ * \param state A pointer to a parser state
+ * \param callback The function to call for each token
+ * \param ptr  A pointer for use by the callback
+ */
+void jsonsax_setup(struct jsonsax_state *state, jsonsax_callback_t callback,
+                   void *ptr);
+
+/**
+ * \brief      Parse the next chunk of input.
+ * \param state A pointer to a parser state
+ * \param json The chunk
+ * \param len  The length of the chunk
+ * \return     JSON_ERROR_OK, or the error that stopped the parser
+ *
+ *             The callback is called for each token in the chunk
+ *             before this function returns, so the chunk need not be
+ *             kept afterwards.
+ */
+int jsonsax_feed(struct jsonsax_state *state, const char *json, int len);
+
+/**
+ * \brief      End the input.
+ * \param state A pointer to a parser state
+ * \return     JSON_ERROR_OK if the input was one complete JSON value,
+ *             or else an error
+ */
+int jsonsax_end(struct jsonsax_state *state);
+
+#endif /* JSONSAX_H_ */
@@ -40,6 +40,7 @@
 #include "contiki.h"
 #include "jsontree.h"
 #include "jsonparse.h"
+#include "cbor.h"
 #include <string.h>
 
 #define DEBUG 0
@@ -50,10 +51,126 @@
 #define PRINTF(...)
 #endif
 
+#if JSONTREE_CBOR
+#define IS_CBOR(js_ctx) ((js_ctx)->format == JSONTREE_FORMAT_CBOR)
+#else
+#define IS_CBOR(js_ctx) 0
+#endif /* JSONTREE_CBOR */
+
+/* js_ctx->skip when jsontree_print_buffer() has written all output */
+#define SKIP_DONE 0xffff
+
+/* The buffer that jsontree_print_buffer() is writing into */
+static struct {
+  char *buf;
+  int size;
+  int pos;
+  uint16_t skip;
+  uint8_t overflow;
+} out;
+
+/*---------------------------------------------------------------------------*/
+/* Writes a number as an integer or a decimal fraction, or else text
+   as a string */
+static void
+write_cbor_atom(const struct jsontree_context *js_ctx, const char *text)
+{
+  const char *p;
+  uint32_t mantissa;
+  uint8_t major;
+  int fraction;
+  int exponent;
+  int exponent_sign;
+
+  if(strcmp(text, "true") == 0) {
+    js_ctx->putchar(CBOR_TRUE);
+    return;
+  } else if(strcmp(text, "false") == 0) {
+    js_ctx->putchar(CBOR_FALSE);
+    return;
+  } else if(strcmp(text, "null") == 0) {
+    js_ctx->putchar(CBOR_NULL);
+    return;
+  }
+
+  p = text;
+  major = CBOR_MAJOR_UINT;
+  if(*p == '-') {
+    major = CBOR_MAJOR_NEGINT;
+    p++;
+  }
+  mantissa = 0;
+  fraction = -1;
+  for(; *p != '\0'; p++) {
+    if(*p == '.' && fraction < 0) {
+      fraction = 0;
+    } else if(*p >= '0' && *p <= '9' && mantissa <= 0x7fffffff / 10) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if(fraction >= 0) {
+        fraction++;
+      }
+    } else {
+      break;
+    }
+  }
+  if(p == text || p[-1] < '0' || p[-1] > '9') {
+    cbor_write_text(js_ctx->putchar, text);
+    return;
+  }
+
+  /* An exponent, as in 1e5 or 2.5E-3 */
+  exponent = 0;
+  exponent_sign = 0;
+  if(*p == 'e' || *p == 'E') {
+    exponent_sign = 1;
+    p++;
+    if(*p == '-' || *p == '+') {
+      exponent_sign = *p == '-' ? -1 : 1;
+      p++;
+    }
+    if(*p < '0' || *p > '9') {
+      cbor_write_text(js_ctx->putchar, text);
+      return;
+    }
+    for(; *p >= '0' && *p <= '9' && exponent <= 128; p++) {
+      exponent = exponent * 10 + (*p - '0');
+    }
+    exponent *= exponent_sign;
+  }
+  if(fraction > 0) {
+    exponent -= fraction;
+  }
+
+  /* Numbers that the decoder cannot read back are written as text */
+  if(*p != '\0' || exponent < -128 || exponent > 127) {
+    cbor_write_text(js_ctx->putchar, text);
+    return;
+  }
+
+  if(mantissa == 0) {
+    major = CBOR_MAJOR_UINT;
+  }
+  if(fraction > 0 || exponent_sign != 0) {
+    cbor_write_head(js_ctx->putchar, CBOR_MAJOR_TAG,
+                    CBOR_TAG_DECIMAL_FRACTION);
+    cbor_write_head(js_ctx->putchar, CBOR_MAJOR_ARRAY, 2);
+    cbor_write_int(js_ctx->putchar, exponent);
+  }
+  cbor_write_head(js_ctx->putchar, major,
+                  major == CBOR_MAJOR_NEGINT ? mantissa - 1 : mantissa);
+}
 /*---------------------------------------------------------------------------*/
 void
 jsontree_write_atom(const struct jsontree_context *js_ctx, const char *text)
 {
+  if(IS_CBOR(js_ctx)) {
+    if(text == NULL) {
+      js_ctx->putchar(0);
+    } else {
+      write_cbor_atom(js_ctx, text);
+    }
+    return;
+  }
   if(text == NULL) {
     js_ctx->putchar('0');
   } else {
@@ -66,6 +183,10 @@ jsontree_write_atom(const struct jsontree_context *js_ctx, const char *text)
 void
 jsontree_write_string(const struct jsontree_context *js_ctx, const char *text)
 {
+  if(IS_CBOR(js_ctx)) {
+    cbor_write_text(js_ctx->putchar, text);
+    return;
+  }
   js_ctx->putchar('"');
   if(text != NULL) {
     while(*text != '\0') {
@@ -84,6 +205,10 @@ jsontree_write_int(const struct jsontree_context *js_ctx, int value)
   char buf[10];
   int l;
 
+  if(IS_CBOR(js_ctx)) {
+    cbor_write_int(js_ctx->putchar, value);
+    return;
+  }
   if(value < 0) {
     js_ctx->putchar('-');
     value = -value;
@@ -107,6 +232,7 @@ jsontree_setup(struct jsontree_context *js_ctx, struct jsontree_value *root,
   js_ctx->values[0] = root;
   js_ctx->putchar = putchar;
   js_ctx->path = 0;
+  js_ctx->format = JSONTREE_FORMAT_JSON;
   jsontree_reset(js_ctx);
 }
 /*---------------------------------------------------------------------------*/
@@ -115,6 +241,7 @@ jsontree_reset(struct jsontree_context *js_ctx)
 {
   js_ctx->depth = 0;
   js_ctx->index[0] = 0;
+  js_ctx->skip = 0;
 }
 /*---------------------------------------------------------------------------*/
 const char *
@@ -143,25 +270,39 @@ jsontree_print_next(struct jsontree_context *js_ctx)
     struct jsontree_value *ov;
 
     index = js_ctx->index[js_ctx->depth];
-    if(index == 0) {
-      js_ctx->putchar(v->type);
-      js_ctx->putchar('\n');
-    }
-    if(index >= o->count) {
-      js_ctx->putchar('\n');
-      js_ctx->putchar(v->type + 2);
-      /* Default operation: back up one level! */
-      break;
-    }
+    if(IS_CBOR(js_ctx)) {
+      /* Definite lengths, without separators or an end */
+      if(index == 0) {
+        cbor_write_head(js_ctx->putchar, v->type == JSON_TYPE_OBJECT ?
+                        CBOR_MAJOR_MAP : CBOR_MAJOR_ARRAY, o->count);
+      }
+      if(index >= o->count) {
+        /* Default operation: back up one level! */
+        break;
+      }
+    } else {
+      if(index == 0) {
+        js_ctx->putchar(v->type);
+        js_ctx->putchar('\n');
+      }
+      if(index >= o->count) {
+        js_ctx->putchar('\n');
+        js_ctx->putchar(v->type + 2);
+        /* Default operation: back up one level! */
+        break;
+      }
 
-    if(index > 0) {
-      js_ctx->putchar(',');
-      js_ctx->putchar('\n');
+      if(index > 0) {
+        js_ctx->putchar(',');
+        js_ctx->putchar('\n');
+      }
     }
     if(v->type == JSON_TYPE_OBJECT) {
       jsontree_write_string(js_ctx,
                             ((struct jsontree_object *)o)->pairs[index].name);
-      js_ctx->putchar(':');
+      if(!IS_CBOR(js_ctx)) {
+        js_ctx->putchar(':');
+      }
       ov = ((struct jsontree_object *)o)->pairs[index].value;
     } else {
       ov = o->values[index];
@@ -212,6 +353,73 @@ jsontree_print_next(struct jsontree_context *js_ctx)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+static int
+buffer_putchar(int c)
+{
+  if(out.skip > 0) {
+    out.skip--;
+  } else if(out.pos < out.size) {
+    out.buf[out.pos++] = c;
+  } else {
+    out.overflow = 1;
+  }
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+int
+jsontree_print_buffer(struct jsontree_context *js_ctx, char *buf, int size)
+{
+  int (* putchar)(int);
+  int callback_state;
+  uint16_t index, parent_index;
+  uint8_t depth;
+  int start, more;
+
+  if(js_ctx->skip == SKIP_DONE) {
+    return 0;
+  }
+
+  putchar = js_ctx->putchar;
+  js_ctx->putchar = buffer_putchar;
+  out.buf = buf;
+  out.size = size;
+  out.pos = 0;
+
+  while(out.pos < size) {
+    /* What a step can change, to run it again if it does not fit */
+    depth = js_ctx->depth;
+    index = js_ctx->index[depth];
+    parent_index = depth > 0 ? js_ctx->index[depth - 1] : 0;
+    callback_state = js_ctx->callback_state;
+
+    out.skip = js_ctx->skip;
+    out.overflow = 0;
+    start = out.pos;
+
+    more = jsontree_print_next(js_ctx);
+
+    if(out.overflow) {
+      js_ctx->depth = depth;
+      js_ctx->index[depth] = index;
+      if(depth > 0) {
+        js_ctx->index[depth - 1] = parent_index;
+      }
+      js_ctx->callback_state = callback_state;
+      js_ctx->skip += out.pos - start;
+      break;
+    }
+
+    js_ctx->skip = 0;
+    if(!more || js_ctx->path > js_ctx->depth) {
+      js_ctx->skip = SKIP_DONE;
+      break;
+    }
+  }
+
+  js_ctx->putchar = putchar;
+  return out.pos;
+}
+/*---------------------------------------------------------------------------*/
 static struct jsontree_value *
 find_next(struct jsontree_context *js_ctx)
 {
@@ -49,6 +49,16 @@
 #define JSONTREE_MAX_DEPTH 10
 #endif /* JSONTREE_CONF_MAX_DEPTH */
 
+/* Set to write value trees as CBOR as well as JSON */
+#ifdef JSONTREE_CONF_CBOR
+#define JSONTREE_CBOR JSONTREE_CONF_CBOR
+#else
+#define JSONTREE_CBOR 0
+#endif /* JSONTREE_CONF_CBOR */
+
+#define JSONTREE_FORMAT_JSON 0
+#define JSONTREE_FORMAT_CBOR 1
+
 struct jsontree_context {
   struct jsontree_value *values[JSONTREE_MAX_DEPTH];
   uint16_t index[JSONTREE_MAX_DEPTH];
@@ -56,6 +66,10 @@ struct jsontree_context {
   uint8_t depth;
   uint8_t path;
   int callback_state;
+  /* output of the current step already written by jsontree_print_buffer() */
+  uint16_t skip;
+  /* JSONTREE_FORMAT_JSON, or JSONTREE_FORMAT_CBOR after jsontree_setup() */
+  uint8_t format;
 };
 
 struct jsontree_value {
@@ -130,12 +144,37 @@ void jsontree_reset(struct jsontree_context *js_ctx);
 const char *jsontree_path_name(const struct jsontree_context *js_ctx,
                                int depth);
 
+/*
+ * In CBOR format, a callback writes exactly one value. Text written
+ * with jsontree_write_atom() is written as a number, true, false or
+ * null when it is one, or else as a string.
+ */
 void jsontree_write_int(const struct jsontree_context *js_ctx, int value);
 void jsontree_write_atom(const struct jsontree_context *js_ctx,
                          const char *text);
 void jsontree_write_string(const struct jsontree_context *js_ctx,
                            const char *text);
 int jsontree_print_next(struct jsontree_context *js_ctx);
+
+/**
+ * \brief      Write the JSON output into a buffer.
+ * \param js_ctx The context, set up as for jsontree_print_next()
+ * \param buf  The buffer, such as a transport buffer
+ * \param size The size of the buffer
+ * \return     The number of bytes written, which is less than size
+ *             only when the output is complete
+ *
+ *             This writes the output up to and including the subtree
+ *             at js_ctx->path, like calling jsontree_print_next()
+ *             while js_ctx->path is not deeper than js_ctx->depth,
+ *             but fills the buffer without a call for each character.
+ *             It is called again with the next buffer to continue.
+ *             A value that does not fit is written again when
+ *             continuing, skipping what was written before, so
+ *             callbacks must write the same output again.
+ */
+int jsontree_print_buffer(struct jsontree_context *js_ctx, char *buf,
+                          int size);
 struct jsontree_value *jsontree_find_next(struct jsontree_context *js_ctx,
                                           int type);
 
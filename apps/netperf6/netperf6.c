@@ -0,0 +1,733 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         Netperf-style measurements of UDP, TCP and CoAP over IPv6.
+ */
+
+#include "contiki.h"
+#include "netperf6.h"
+#include "lib/random.h"
+#include "net/ip/simple-udp.h"
+#include "net/ip/tcp-socket.h"
+#include "sys/energest.h"
+#include "sys/rtimer.h"
+#if NETPERF6_COAP
+#include "er-coap-engine.h"
+#endif /* NETPERF6_COAP */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLIENT_PORT (NETPERF6_PORT + 1)
+
+/* UDP packets start with a type, a session and a sequence number */
+#define MSG_DATA     'd'
+#define MSG_END      'e'
+#define MSG_REPORT   'r'
+#define MSG_REQUEST  'q'
+#define MSG_RESPONSE 'a'
+#define MSG_PING     'p'
+#define MSG_PONG     'o'
+
+#define HDR_LEN    6
+/* followed by the packets and bytes of a stream */
+#define REPORT_LEN 12
+
+/* Stream test closing attempts */
+#define END_ATTEMPTS 3
+
+/* A TCP client starts with its mode and the size of its requests */
+#define HELLO_LEN 4
+
+/* TCP responses may wait for retransmissions */
+#define TCP_TIMEOUT (4 * NETPERF6_TIMEOUT)
+
+process_event_t netperf6_event;
+
+/* The running test */
+static struct netperf6_result result;
+static struct process *client;
+static uip_ipaddr_t peer;
+static uint16_t session;
+static uint16_t seq;
+static rtimer_clock_t sent_at;
+static uint8_t answered;
+static clock_time_t start;
+static clock_time_t stop;
+static unsigned long cpu0, lpm0, tx0, rx0;
+
+static uint8_t payload[NETPERF6_MAX_SIZE];
+static uint8_t reply[NETPERF6_MAX_SIZE];
+
+/* The stream a peer is sending to this node */
+static struct {
+  uint16_t session;
+  uint16_t packets;
+  uint32_t bytes;
+} stream;
+
+static struct simple_udp_connection server_conn;
+static struct simple_udp_connection client_conn;
+
+#if UIP_TCP
+static struct tcp_socket server_socket;
+static uint8_t server_out[NETPERF6_MAX_SIZE];
+static uint8_t server_hello[HELLO_LEN];
+static uint8_t server_hello_len;
+static uint16_t server_received;
+
+static struct tcp_socket client_socket;
+static uint8_t client_out[HELLO_LEN + NETPERF6_MAX_SIZE];
+static uint8_t client_registered;
+static uint8_t client_connected;
+static uint8_t client_closed;
+static uint16_t client_received;
+#endif /* UIP_TCP */
+
+#if NETPERF6_COAP
+static void res_get_handler(void *request, void *response, uint8_t *buffer,
+                            uint16_t preferred_size, int32_t *offset);
+static void res_post_handler(void *request, void *response, uint8_t *buffer,
+                             uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_netperf6, "title=\"netperf6\"",
+         res_get_handler, res_post_handler, NULL, NULL);
+
+static coap_packet_t coap_request;
+static struct {
+  uint16_t packets;
+  uint32_t bytes;
+} coap_stream;
+#endif /* NETPERF6_COAP */
+
+PROCESS(netperf6_process, "netperf6");
+/*---------------------------------------------------------------------------*/
+static void
+put16(uint8_t *p, uint16_t v)
+{
+  p[0] = v >> 8;
+  p[1] = v;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get16(const uint8_t *p)
+{
+  return (p[0] << 8) | p[1];
+}
+/*---------------------------------------------------------------------------*/
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  put16(p, v >> 16);
+  put16(p + 2, v);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return ((uint32_t)get16(p) << 16) | get16(p + 2);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+rtt_bucket(uint32_t us)
+{
+  uint8_t octave;
+  uint8_t b;
+
+  if(us < 4) {
+    return us;
+  }
+  for(octave = 2; (us >> (octave + 1)) != 0; octave++);
+  b = (octave - 1) * 4 + ((us >> (octave - 2)) & 3);
+  return b < NETPERF6_RTT_BUCKETS ? b : NETPERF6_RTT_BUCKETS - 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+bucket_start(uint8_t b)
+{
+  if(b < 4) {
+    return b;
+  }
+  return (uint32_t)(4 + (b & 3)) << (b / 4 - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Counts the answer to the request in flight */
+static void
+answer(void)
+{
+  uint32_t us;
+
+  us = (unsigned long long)(rtimer_clock_t)(RTIMER_NOW() - sent_at) *
+    1000000 / RTIMER_SECOND;
+  if(us < result.rtt_min) {
+    result.rtt_min = us;
+  }
+  if(us > result.rtt_max) {
+    result.rtt_max = us;
+  }
+  result.rtt[rtt_bucket(us)]++;
+  result.completed++;
+  result.bytes += result.size;
+  answered = 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+server_receive(struct simple_udp_connection *c,
+               const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+               const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+               const uint8_t *data, uint16_t datalen)
+{
+  if(datalen < HDR_LEN || datalen > sizeof(reply)) {
+    return;
+  }
+
+  memcpy(reply, data, HDR_LEN);
+  switch(data[0]) {
+  case MSG_DATA:
+    if(get16(data + 2) != stream.session) {
+      stream.session = get16(data + 2);
+      stream.packets = 0;
+      stream.bytes = 0;
+    }
+    stream.packets++;
+    stream.bytes += datalen;
+    return;
+  case MSG_END:
+    reply[0] = MSG_REPORT;
+    if(get16(data + 2) != stream.session) {
+      memset(reply + HDR_LEN, 0, REPORT_LEN - HDR_LEN);
+    } else {
+      put16(reply + HDR_LEN, stream.packets);
+      put32(reply + HDR_LEN + 2, stream.bytes);
+    }
+    datalen = REPORT_LEN;
+    break;
+  case MSG_REQUEST:
+    reply[0] = MSG_RESPONSE;
+    datalen = HDR_LEN;
+    break;
+  case MSG_PING:
+    memcpy(reply, data, datalen);
+    reply[0] = MSG_PONG;
+    break;
+  default:
+    return;
+  }
+  simple_udp_sendto_port(c, reply, datalen, sender_addr, sender_port);
+}
+/*---------------------------------------------------------------------------*/
+static void
+client_receive(struct simple_udp_connection *c,
+               const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+               const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+               const uint8_t *data, uint16_t datalen)
+{
+  if(datalen < HDR_LEN || get16(data + 2) != session || answered ||
+     !process_is_running(&netperf6_process)) {
+    return;
+  }
+
+  if(data[0] == MSG_REPORT && datalen >= REPORT_LEN) {
+    result.completed = get16(data + HDR_LEN);
+    result.bytes = get32(data + HDR_LEN + 2);
+    answered = 1;
+    process_poll(&netperf6_process);
+  } else if((data[0] == MSG_RESPONSE || data[0] == MSG_PONG) &&
+            get16(data + 4) == seq) {
+    answer();
+    process_poll(&netperf6_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_msg(uint8_t type, uint16_t len)
+{
+  payload[0] = type;
+  put16(payload + 2, session);
+  put16(payload + 4, seq);
+  simple_udp_sendto_port(&client_conn, payload, len, &peer, NETPERF6_PORT);
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP
+static int
+server_input(struct tcp_socket *s, void *ptr,
+             const uint8_t *data, int len)
+{
+  uint16_t size;
+
+  while(len > 0 && server_hello_len < sizeof(server_hello)) {
+    server_hello[server_hello_len++] = *data++;
+    len--;
+  }
+  if(len == 0) {
+    return 0;
+  }
+
+  size = get16(server_hello + 2);
+  if(server_hello[0] == NETPERF6_PINGPONG) {
+    tcp_socket_send(s, data, len);
+  } else if(server_hello[0] == NETPERF6_RR && size > 0) {
+    server_received += len;
+    while(server_received >= size) {
+      server_received -= size;
+      tcp_socket_send_str(s, "a");
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+server_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    server_hello_len = 0;
+    server_received = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+client_input(struct tcp_socket *s, void *ptr,
+             const uint8_t *data, int len)
+{
+  client_received += len;
+  process_poll(&netperf6_process);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+client_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    client_connected = 1;
+  } else if(event != TCP_SOCKET_DATA_SENT) {
+    client_connected = 0;
+    client_closed = 1;
+  }
+  process_poll(&netperf6_process);
+}
+#endif /* UIP_TCP */
+/*---------------------------------------------------------------------------*/
+#if NETPERF6_COAP
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer,
+                uint16_t preferred_size, int32_t *offset)
+{
+  /* Report the stream so far, and start a new one */
+  REST.set_header_content_type(response, REST.type.TEXT_PLAIN);
+  REST.set_response_payload(response, buffer,
+                            snprintf((char *)buffer, preferred_size,
+                                     "%u %lu", coap_stream.packets,
+                                     (unsigned long)coap_stream.bytes));
+  coap_stream.packets = 0;
+  coap_stream.bytes = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_post_handler(void *request, void *response, uint8_t *buffer,
+                 uint16_t preferred_size, int32_t *offset)
+{
+  const uint8_t *data;
+  const char *mode;
+  int len;
+
+  len = REST.get_request_payload(request, &data);
+  if(REST.get_query_variable(request, "m", &mode) == 0) {
+    mode = "r";
+  }
+
+  if(mode[0] == 's') {
+    coap_stream.packets++;
+    coap_stream.bytes += len;
+    REST.set_response_status(response, REST.status.CHANGED);
+  } else if(mode[0] == 'p') {
+    len = len < preferred_size ? len : preferred_size;
+    memcpy(buffer, data, len);
+    REST.set_header_content_type(response, REST.type.APPLICATION_OCTET_STREAM);
+    REST.set_response_payload(response, buffer, len);
+  } else {
+    REST.set_response_status(response, REST.status.CHANGED);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+setup_request(coap_message_type_t type, coap_method_t method,
+              const char *query, uint16_t len)
+{
+  coap_init_message(&coap_request, type, method, coap_get_mid());
+  coap_set_header_uri_path(&coap_request, "netperf6");
+  if(query != NULL) {
+    coap_set_header_uri_query(&coap_request, query);
+  }
+  if(len > 0) {
+    coap_set_payload(&coap_request, payload, len);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+coap_answer(void *response)
+{
+  answer();
+}
+/*---------------------------------------------------------------------------*/
+static void
+coap_report(void *response)
+{
+  const uint8_t *data;
+  char text[24];
+  char *next;
+  int len;
+
+  len = coap_get_payload(response, &data);
+  if(len >= sizeof(text)) {
+    return;
+  }
+  memcpy(text, data, len);
+  text[len] = '\0';
+  result.completed = strtoul(text, &next, 10);
+  result.bytes = strtoul(next, NULL, 10);
+  answered = 1;
+}
+#endif /* NETPERF6_COAP */
+/*---------------------------------------------------------------------------*/
+static void
+begin(void)
+{
+  session = random_rand();
+  seq = 0;
+  answered = 0;
+  start = clock_time();
+  stop = 0;
+  energest_flush();
+  cpu0 = energest_type_time(ENERGEST_TYPE_CPU);
+  lpm0 = energest_type_time(ENERGEST_TYPE_LPM);
+  tx0 = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  rx0 = energest_type_time(ENERGEST_TYPE_LISTEN);
+}
+/*---------------------------------------------------------------------------*/
+static void
+end(void)
+{
+  if(stop == 0) {
+    stop = clock_time();
+  }
+  result.time = (unsigned long long)(stop - start) * 1000 / CLOCK_SECOND;
+  energest_flush();
+  result.cpu = energest_type_time(ENERGEST_TYPE_CPU) - cpu0;
+  result.lpm = energest_type_time(ENERGEST_TYPE_LPM) - lpm0;
+  result.tx = energest_type_time(ENERGEST_TYPE_TRANSMIT) - tx0;
+  result.rx = energest_type_time(ENERGEST_TYPE_LISTEN) - rx0;
+  if(result.rtt_min > result.rtt_max) {
+    result.rtt_min = 0;
+  }
+  process_post(client, netperf6_event, &result);
+}
+/*---------------------------------------------------------------------------*/
+static void
+cleanup(void)
+{
+#if UIP_TCP
+  if(client_registered) {
+    tcp_socket_unregister(&client_socket);
+    client_registered = 0;
+  }
+#endif /* UIP_TCP */
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(netperf6_process, ev, data)
+{
+  static struct etimer et;
+#if UIP_TCP
+  static uint32_t left;
+  static uint16_t expect;
+#endif /* UIP_TCP */
+
+  PROCESS_EXITHANDLER(cleanup());
+
+  PROCESS_BEGIN();
+
+  begin();
+
+  if(result.proto == NETPERF6_UDP && result.mode == NETPERF6_STREAM) {
+    for(seq = 0; seq < result.count; seq++) {
+      send_msg(MSG_DATA, result.size);
+      PROCESS_PAUSE();
+    }
+    for(seq = 0; seq < END_ATTEMPTS && !answered; seq++) {
+      send_msg(MSG_END, HDR_LEN);
+      etimer_set(&et, NETPERF6_TIMEOUT);
+      PROCESS_WAIT_UNTIL(answered || etimer_expired(&et));
+    }
+
+  } else if(result.proto == NETPERF6_UDP) {
+    for(seq = 0; seq < result.count; seq++) {
+      answered = 0;
+      sent_at = RTIMER_NOW();
+      send_msg(result.mode == NETPERF6_RR ? MSG_REQUEST : MSG_PING,
+               result.size);
+      etimer_set(&et, NETPERF6_TIMEOUT);
+      PROCESS_WAIT_UNTIL(answered || etimer_expired(&et));
+    }
+
+#if UIP_TCP
+  } else if(result.proto == NETPERF6_TCP) {
+    tcp_socket_register(&client_socket, NULL, NULL, 0,
+                        client_out, sizeof(client_out),
+                        client_input, client_event);
+    client_registered = 1;
+    client_connected = 0;
+    client_closed = 0;
+    client_received = 0;
+    if(result.mode == NETPERF6_STREAM) {
+      tcp_socket_windowed(&client_socket);
+    }
+    tcp_socket_connect(&client_socket, &peer, NETPERF6_PORT);
+    etimer_set(&et, TCP_TIMEOUT);
+    PROCESS_WAIT_UNTIL(client_connected || client_closed ||
+                       etimer_expired(&et));
+
+    if(client_connected) {
+      /* The time is that of the transfer, without the handshakes */
+      start = clock_time();
+      payload[0] = result.mode;
+      payload[1] = 0;
+      put16(payload + 2, result.size);
+      tcp_socket_send(&client_socket, payload, HELLO_LEN);
+
+      if(result.mode == NETPERF6_STREAM) {
+        left = (uint32_t)result.count * result.size;
+        while(client_connected &&
+              (left > 0 ||
+               tcp_socket_max_sendlen(&client_socket) < sizeof(client_out))) {
+          if(left > 0) {
+            left -= tcp_socket_send(&client_socket, payload,
+                                    left < sizeof(payload) ?
+                                    left : sizeof(payload));
+            tcpip_poll_tcp(client_socket.c);
+          }
+          PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+        }
+        if(left == 0 && client_connected) {
+          result.completed = result.count;
+          result.bytes = (uint32_t)result.count * result.size;
+        }
+      } else {
+        expect = result.mode == NETPERF6_RR ? 1 : result.size;
+        for(seq = 0; seq < result.count && client_connected; seq++) {
+          client_received = 0;
+          answered = 0;
+          sent_at = RTIMER_NOW();
+          tcp_socket_send(&client_socket, payload, result.size);
+          /* Send now rather than on the periodic poll */
+          tcpip_poll_tcp(client_socket.c);
+          etimer_set(&et, TCP_TIMEOUT);
+          PROCESS_WAIT_UNTIL(client_received >= expect || !client_connected ||
+                             etimer_expired(&et));
+          if(client_received < expect) {
+            break;
+          }
+          answer();
+        }
+      }
+
+      stop = clock_time();
+      tcp_socket_close(&client_socket);
+      etimer_set(&et, TCP_TIMEOUT);
+      PROCESS_WAIT_UNTIL(!client_connected || etimer_expired(&et));
+    }
+    cleanup();
+#endif /* UIP_TCP */
+
+#if NETPERF6_COAP
+  } else if(result.proto == NETPERF6_COAP_POST &&
+            result.mode == NETPERF6_STREAM) {
+    /* Non-confirmable requests, then a request for what arrived */
+    for(seq = 0; seq < result.count; seq++) {
+      setup_request(COAP_TYPE_NON, COAP_POST, "m=s", result.size);
+      coap_send_message(&peer, UIP_HTONS(COAP_DEFAULT_PORT), reply,
+                        coap_serialize_message(&coap_request, reply));
+      PROCESS_PAUSE();
+    }
+    setup_request(COAP_TYPE_CON, COAP_GET, NULL, 0);
+    COAP_BLOCKING_REQUEST(&peer, UIP_HTONS(COAP_DEFAULT_PORT),
+                          &coap_request, coap_report);
+
+  } else if(result.proto == NETPERF6_COAP_POST) {
+    for(seq = 0; seq < result.count; seq++) {
+      setup_request(COAP_TYPE_CON, COAP_POST,
+                    result.mode == NETPERF6_PINGPONG ? "m=p" : NULL,
+                    result.size);
+      answered = 0;
+      sent_at = RTIMER_NOW();
+      COAP_BLOCKING_REQUEST(&peer, UIP_HTONS(COAP_DEFAULT_PORT),
+                            &coap_request, coap_answer);
+    }
+#endif /* NETPERF6_COAP */
+  }
+
+  end();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+netperf6_init(void)
+{
+  netperf6_event = process_alloc_event();
+  simple_udp_register(&server_conn, NETPERF6_PORT, NULL, 0, server_receive);
+  simple_udp_register(&client_conn, CLIENT_PORT, NULL, 0, client_receive);
+
+#if UIP_TCP
+  tcp_socket_register(&server_socket, NULL, NULL, 0,
+                      server_out, sizeof(server_out),
+                      server_input, server_event);
+  tcp_socket_listen(&server_socket, NETPERF6_PORT);
+#endif /* UIP_TCP */
+
+#if NETPERF6_COAP
+  rest_init_engine();
+  rest_activate_resource(&res_netperf6, "netperf6");
+#endif /* NETPERF6_COAP */
+}
+/*---------------------------------------------------------------------------*/
+int
+netperf6_start(struct process *p, const uip_ipaddr_t *addr,
+               uint8_t proto, uint8_t mode, uint16_t size, uint16_t count)
+{
+  if(process_is_running(&netperf6_process) || mode > NETPERF6_PINGPONG ||
+     size > NETPERF6_MAX_SIZE || count == 0) {
+    return 0;
+  }
+  if(proto == NETPERF6_UDP) {
+    if(size < HDR_LEN) {
+      return 0;
+    }
+#if UIP_TCP
+  } else if(proto == NETPERF6_TCP) {
+    if(size == 0) {
+      return 0;
+    }
+#endif /* UIP_TCP */
+#if NETPERF6_COAP
+  } else if(proto == NETPERF6_COAP_POST) {
+    if(size > REST_MAX_CHUNK_SIZE) {
+      return 0;
+    }
+#endif /* NETPERF6_COAP */
+  } else {
+    return 0;
+  }
+
+  memset(&result, 0, sizeof(result));
+  result.proto = proto;
+  result.mode = mode;
+  result.size = size;
+  result.count = count;
+  result.rtt_min = 0xffffffff;
+  client = p;
+  uip_ipaddr_copy(&peer, addr);
+  process_start(&netperf6_process, NULL);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+netperf6_stop(void)
+{
+  process_exit(&netperf6_process);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+netperf6_rtt_percentile(const struct netperf6_result *r, uint8_t percent)
+{
+  uint32_t target;
+  uint32_t sum;
+  uint32_t end;
+  uint8_t b;
+
+  if(r->rtt_max == 0) {
+    return 0;
+  }
+  target = ((uint32_t)r->completed * percent + 99) / 100;
+  sum = 0;
+  for(b = 0; b < NETPERF6_RTT_BUCKETS - 1; b++) {
+    sum += r->rtt[b];
+    if(sum >= target && sum > 0) {
+      end = bucket_start(b + 1) - 1;
+      return end < r->rtt_max ? end : r->rtt_max;
+    }
+  }
+  return r->rtt_max;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+netperf6_energy(const struct netperf6_result *r)
+{
+  unsigned long long nw_ticks;
+
+  /* Microamperes times millivolts are nanowatts */
+  nw_ticks = ((unsigned long long)r->cpu * NETPERF6_CURRENT_CPU +
+              (unsigned long long)r->lpm * NETPERF6_CURRENT_LPM +
+              (unsigned long long)r->tx * NETPERF6_CURRENT_TX +
+              (unsigned long long)r->rx * NETPERF6_CURRENT_RX) *
+    NETPERF6_VOLTAGE;
+  return nw_ticks / RTIMER_SECOND / 1000;
+}
+/*---------------------------------------------------------------------------*/
+int
+netperf6_format(const struct netperf6_result *r, char *buf, int size)
+{
+  static const char *protos[] = { "udp", "tcp", "coap" };
+  static const char *modes[] = { "stream", "rr", "pingpong" };
+  uint32_t energy;
+
+  energy = netperf6_energy(r);
+  return snprintf(buf, size,
+                  "netperf6 proto=%s mode=%s size=%u count=%u completed=%u"
+                  " bytes=%lu ms=%lu bps=%lu"
+                  " rtt_min=%lu rtt_p50=%lu rtt_p90=%lu rtt_p99=%lu"
+                  " rtt_max=%lu uj=%lu nj_per_byte=%lu",
+                  protos[r->proto], modes[r->mode], r->size, r->count,
+                  r->completed, (unsigned long)r->bytes,
+                  (unsigned long)r->time,
+                  r->time > 0 ? (unsigned long)
+                  ((unsigned long long)r->bytes * 8000 / r->time) : 0UL,
+                  (unsigned long)r->rtt_min,
+                  (unsigned long)netperf6_rtt_percentile(r, 50),
+                  (unsigned long)netperf6_rtt_percentile(r, 90),
+                  (unsigned long)netperf6_rtt_percentile(r, 99),
+                  (unsigned long)r->rtt_max, (unsigned long)energy,
+                  r->bytes > 0 ? (unsigned long)
+                  ((unsigned long long)energy * 1000 / r->bytes) : 0UL);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         Measures throughput, round-trip times and energy of UDP, TCP
+ *         and CoAP between two IPv6 nodes, like netperf does for
+ *         hosts. Each node serves the tests of its peers, and runs
+ *         one test of its own at a time.
+ *
+ *         A stream test sends count packets of size bytes as fast as
+ *         the stack takes them, and reports what reached the peer. A
+ *         request-response test sends count requests of size bytes,
+ *         each answered with a short response, and a ping-pong test
+ *         has the peer echo each request. Both report round-trip
+ *         times.
+ */
+
+#ifndef NETPERF6_H_
+#define NETPERF6_H_
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+
+/* UDP and TCP port of the netperf6 server */
+#ifdef NETPERF6_CONF_PORT
+#define NETPERF6_PORT NETPERF6_CONF_PORT
+#else
+#define NETPERF6_PORT 5001
+#endif /* NETPERF6_CONF_PORT */
+
+/* The largest request, including the netperf6 header for UDP */
+#ifdef NETPERF6_CONF_MAX_SIZE
+#define NETPERF6_MAX_SIZE NETPERF6_CONF_MAX_SIZE
+#else
+#define NETPERF6_MAX_SIZE 128
+#endif /* NETPERF6_CONF_MAX_SIZE */
+
+/* How long to wait for a response before counting it as lost */
+#ifdef NETPERF6_CONF_TIMEOUT
+#define NETPERF6_TIMEOUT NETPERF6_CONF_TIMEOUT
+#else
+#define NETPERF6_TIMEOUT (2 * CLOCK_SECOND)
+#endif /* NETPERF6_CONF_TIMEOUT */
+
+/* Set to serve and run CoAP tests, which needs the er-coap and
+   rest-engine apps */
+#ifdef NETPERF6_CONF_COAP
+#define NETPERF6_COAP NETPERF6_CONF_COAP
+#else
+#define NETPERF6_COAP 0
+#endif /* NETPERF6_CONF_COAP */
+
+/* Currents in microamperes and the supply voltage in millivolts, to
+   turn energest times into energy. The defaults are for Tmote Sky. */
+#ifdef NETPERF6_CONF_CURRENT_CPU
+#define NETPERF6_CURRENT_CPU NETPERF6_CONF_CURRENT_CPU
+#else
+#define NETPERF6_CURRENT_CPU 1800
+#endif /* NETPERF6_CONF_CURRENT_CPU */
+
+#ifdef NETPERF6_CONF_CURRENT_LPM
+#define NETPERF6_CURRENT_LPM NETPERF6_CONF_CURRENT_LPM
+#else
+#define NETPERF6_CURRENT_LPM 55
+#endif /* NETPERF6_CONF_CURRENT_LPM */
+
+#ifdef NETPERF6_CONF_CURRENT_TX
+#define NETPERF6_CURRENT_TX NETPERF6_CONF_CURRENT_TX
+#else
+#define NETPERF6_CURRENT_TX 17700
+#endif /* NETPERF6_CONF_CURRENT_TX */
+
+#ifdef NETPERF6_CONF_CURRENT_RX
+#define NETPERF6_CURRENT_RX NETPERF6_CONF_CURRENT_RX
+#else
+#define NETPERF6_CURRENT_RX 20000
+#endif /* NETPERF6_CONF_CURRENT_RX */
+
+#ifdef NETPERF6_CONF_VOLTAGE
+#define NETPERF6_VOLTAGE NETPERF6_CONF_VOLTAGE
+#else
+#define NETPERF6_VOLTAGE 3000
+#endif /* NETPERF6_CONF_VOLTAGE */
+
+/* Round-trip times are counted in four buckets per power of two
+   microseconds, up to about two seconds */
+#define NETPERF6_RTT_BUCKETS 80
+
+enum {
+  NETPERF6_UDP,
+  NETPERF6_TCP,
+  NETPERF6_COAP_POST
+};
+
+enum {
+  NETPERF6_STREAM,
+  NETPERF6_RR,
+  NETPERF6_PINGPONG
+};
+
+struct netperf6_result {
+  uint8_t proto;
+  uint8_t mode;
+  uint16_t size;
+  /* packets sent, or requests */
+  uint16_t count;
+  /* packets that reached the peer, or requests answered */
+  uint16_t completed;
+  /* bytes that reached the peer */
+  uint32_t bytes;
+  /* milliseconds */
+  uint32_t time;
+  /* microseconds */
+  uint32_t rtt_min;
+  uint32_t rtt_max;
+  uint16_t rtt[NETPERF6_RTT_BUCKETS];
+  /* energest times during the test */
+  unsigned long cpu, lpm, tx, rx;
+};
+
+/* Posted to the process that started a test, with the result */
+extern process_event_t netperf6_event;
+
+/**
+ * \brief      Start serving the tests of other nodes.
+ */
+void netperf6_init(void);
+
+/**
+ * \brief      Start a test.
+ * \param p    The process to post netperf6_event to when done
+ * \param peer The address of the node to test with
+ * \param proto NETPERF6_UDP, NETPERF6_TCP or NETPERF6_COAP_POST
+ * \param mode NETPERF6_STREAM, NETPERF6_RR or NETPERF6_PINGPONG
+ * \param size The size of each packet or request
+ * \param count The number of packets or requests
+ * \return     Non-zero if the test started, or zero if another test
+ *             is running or the arguments are not supported
+ */
+int netperf6_start(struct process *p, const uip_ipaddr_t *peer,
+                   uint8_t proto, uint8_t mode, uint16_t size,
+                   uint16_t count);
+
+/**
+ * \brief      Stop the running test, without posting a result.
+ */
+void netperf6_stop(void);
+
+/**
+ * \brief      A percentile of the round-trip times of a test.
+ * \return     An upper bound in microseconds, or 0 without round trips
+ */
+uint32_t netperf6_rtt_percentile(const struct netperf6_result *r,
+                                 uint8_t percent);
+
+/**
+ * \brief      The energy used during a test.
+ * \return     The energy in microjoules
+ */
+uint32_t netperf6_energy(const struct netperf6_result *r);
+
+/**
+ * \brief      Write a result as one line of name=value fields.
+ * \return     The length of the line, as for snprintf()
+ */
+int netperf6_format(const struct netperf6_result *r, char *buf, int size);
+
+#endif /* NETPERF6_H_ */
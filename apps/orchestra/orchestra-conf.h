@@ -102,4 +102,40 @@
 #define ORCHESTRA_COLLISION_FREE_HASH             0 /* Set to 1 if ORCHESTRA_LINKADDR_HASH returns unique hashes */
 #endif /* ORCHESTRA_CONF_COLLISION_FREE_HASH */
 
+/* Length of the slotframe with extra cells for busy links to the RPL parent,
+ * used by the unicast_adaptive rule */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_PERIOD
+#define ORCHESTRA_ADAPTIVE_PERIOD                 ORCHESTRA_CONF_ADAPTIVE_PERIOD
+#else /* ORCHESTRA_CONF_ADAPTIVE_PERIOD */
+#define ORCHESTRA_ADAPTIVE_PERIOD                 7
+#endif /* ORCHESTRA_CONF_ADAPTIVE_PERIOD */
+
+/* The most extra cells a node uses to its parent */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS
+#define ORCHESTRA_ADAPTIVE_MAX_CELLS              ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS
+#else /* ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS */
+#define ORCHESTRA_ADAPTIVE_MAX_CELLS              3
+#endif /* ORCHESTRA_CONF_ADAPTIVE_MAX_CELLS */
+
+/* How often the queue to the parent is checked */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_INTERVAL
+#define ORCHESTRA_ADAPTIVE_INTERVAL               ORCHESTRA_CONF_ADAPTIVE_INTERVAL
+#else /* ORCHESTRA_CONF_ADAPTIVE_INTERVAL */
+#define ORCHESTRA_ADAPTIVE_INTERVAL               CLOCK_SECOND
+#endif /* ORCHESTRA_CONF_ADAPTIVE_INTERVAL */
+
+/* Queued packets to the parent that make a node ask for one more cell */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_THRESHOLD
+#define ORCHESTRA_ADAPTIVE_THRESHOLD              ORCHESTRA_CONF_ADAPTIVE_THRESHOLD
+#else /* ORCHESTRA_CONF_ADAPTIVE_THRESHOLD */
+#define ORCHESTRA_ADAPTIVE_THRESHOLD              2
+#endif /* ORCHESTRA_CONF_ADAPTIVE_THRESHOLD */
+
+/* The type of the DAO option that announces the cells to the parent */
+#ifdef ORCHESTRA_CONF_ADAPTIVE_DAO_OPTION
+#define ORCHESTRA_ADAPTIVE_DAO_OPTION             ORCHESTRA_CONF_ADAPTIVE_DAO_OPTION
+#else /* ORCHESTRA_CONF_ADAPTIVE_DAO_OPTION */
+#define ORCHESTRA_ADAPTIVE_DAO_OPTION             0x80
+#endif /* ORCHESTRA_CONF_ADAPTIVE_DAO_OPTION */
+
 #endif /* __ORCHESTRA_CONF_H__ */
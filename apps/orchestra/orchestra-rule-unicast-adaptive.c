@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         Orchestra: a slotframe with extra cells for busy links to the RPL
+ *         preferred parent. A node that keeps packets queued to its parent
+ *         asks for up to ORCHESTRA_ADAPTIVE_MAX_CELLS cells, and gives them
+ *         back when its queue stays empty. The number of cells is sent to
+ *         the parent in an option of the node's DAOs. Both ends derive the
+ *         timeslots of the cells from the child's MAC address:
+ *           (hash(child.MAC) * ORCHESTRA_ADAPTIVE_MAX_CELLS + i) % ORCHESTRA_ADAPTIVE_PERIOD
+ *         The child transmits in a cell only once its parent has ACKed the
+ *         DAO announcing it, and stops before announcing fewer cells, so the
+ *         parent always listens when the child may transmit. The count of
+ *         each DAO is kept with the MAC sequence number of its frame, so
+ *         only the ACK of that frame enables the cells it announced. A DAO
+ *         that is not ACKed is sent again. For this, the rule must come
+ *         before the other unicast rules.
+ *
+ */
+
+#include "contiki.h"
+#include "orchestra.h"
+#include "net/packetbuf.h"
+#include "net/nbr-table.h"
+#include "net/ipv6/uip-icmp6.h"
+#include "net/rpl/rpl-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include <string.h>
+
+#define DEBUG DEBUG_PRINT
+#include "net/ip/uip-debug.h"
+
+/* Checks with an empty queue before a node gives back a cell */
+#define IDLE_CHECKS 4
+/* DAOs to our parent we follow until they are ACKed */
+#define DAOS_IN_FLIGHT 4
+
+static uint16_t slotframe_handle = 0;
+static uint16_t channel_offset = 0;
+static struct tsch_slotframe *sf_adaptive;
+
+/* Cells we transmit in to our parent, want, and our parent ACKed last */
+static uint8_t tx_cells;
+static uint8_t wanted_cells;
+static uint8_t announced_cells;
+static uint8_t idle_checks;
+static struct ctimer check_timer;
+
+/* Cells announced in the DAO being sent, and in the queued DAO frames */
+struct dao_cells {
+  uint8_t seqno; /* MAC sequence number of the frame, 0 if unused */
+  uint8_t cells;
+};
+static struct dao_cells daos[DAOS_IN_FLIGHT];
+static uint8_t dao_next;
+static int16_t sending_cells = -1;
+
+/* Cells announced by each of our children */
+NBR_TABLE(uint8_t, child_cells);
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_cell_timeslot(const linkaddr_t *addr, uint8_t cell)
+{
+  return ((uint32_t)ORCHESTRA_LINKADDR_HASH(addr) * ORCHESTRA_ADAPTIVE_MAX_CELLS + cell)
+    % ORCHESTRA_ADAPTIVE_PERIOD;
+}
+/*---------------------------------------------------------------------------*/
+/* Install the links of all our cells, to our parent and from our children */
+static void
+update_links(void)
+{
+  uint8_t options[ORCHESTRA_ADAPTIVE_PERIOD];
+  uint8_t *cells;
+  struct tsch_link *l;
+  uint16_t timeslot;
+  uint8_t i;
+
+  memset(options, 0, sizeof(options));
+  for(i = 0; i < tx_cells; i++) {
+    options[get_cell_timeslot(&linkaddr_node_addr, i)] |= LINK_OPTION_TX | LINK_OPTION_SHARED;
+  }
+  cells = nbr_table_head(child_cells);
+  while(cells != NULL) {
+    linkaddr_t *addr = nbr_table_get_lladdr(child_cells, cells);
+    for(i = 0; i < *cells; i++) {
+      options[get_cell_timeslot(addr, i)] |= LINK_OPTION_RX;
+    }
+    cells = nbr_table_next(child_cells, cells);
+  }
+
+  for(timeslot = 0; timeslot < ORCHESTRA_ADAPTIVE_PERIOD; timeslot++) {
+    l = tsch_schedule_get_link_by_timeslot(sf_adaptive, timeslot);
+    if(options[timeslot] == 0) {
+      if(l != NULL) {
+        tsch_schedule_remove_link(sf_adaptive, l);
+      }
+    } else if(l == NULL || l->link_options != options[timeslot]) {
+      tsch_schedule_add_link(sf_adaptive, options[timeslot],
+          LINK_TYPE_NORMAL, &tsch_broadcast_address,
+          timeslot, channel_offset);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_tx_cells(uint8_t cells)
+{
+  if(cells != tx_cells) {
+    tx_cells = cells;
+    PRINTF("Orchestra: adaptive tx cells %u\n", cells);
+    update_links();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Is a DAO announcing this many cells queued to our parent? */
+static int
+is_announcing(uint8_t cells)
+{
+  uint8_t i;
+
+  for(i = 0; i < DAOS_IN_FLIGHT; i++) {
+    if(daos[i].seqno != 0 && daos[i].cells == cells) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Follow the queue to our parent, and announce changes in a DAO */
+static void
+check(void *ptr)
+{
+  rpl_instance_t *instance;
+  int queued;
+
+  ctimer_reset(&check_timer);
+
+  if(linkaddr_cmp(&orchestra_parent_linkaddr, &linkaddr_null)
+     || !orchestra_parent_knows_us) {
+    return;
+  }
+
+  queued = tsch_queue_packet_count(&orchestra_parent_linkaddr);
+  if(queued >= ORCHESTRA_ADAPTIVE_THRESHOLD) {
+    idle_checks = 0;
+    if(wanted_cells < ORCHESTRA_ADAPTIVE_MAX_CELLS) {
+      wanted_cells++;
+    }
+  } else if(queued == 0) {
+    if(wanted_cells > 0 && ++idle_checks >= IDLE_CHECKS) {
+      idle_checks = 0;
+      wanted_cells--;
+    }
+  } else {
+    idle_checks = 0;
+  }
+
+  /* Fewer cells take effect at once, more when the parent knows */
+  if(wanted_cells < tx_cells) {
+    set_tx_cells(wanted_cells);
+  }
+  /* Until a DAO is ACKed, or if it failed or was dropped, ask again */
+  if(wanted_cells != announced_cells && !is_announcing(wanted_cells)) {
+    instance = rpl_get_default_instance();
+    if(instance != NULL) {
+      rpl_schedule_dao_immediately(instance);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_dao_to_parent(void)
+{
+  return packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID) == UIP_PROTO_ICMP6
+    && packetbuf_attr(PACKETBUF_ATTR_CHANNEL) == (ICMP6_RPL << 8 | RPL_CODE_DAO)
+    && linkaddr_cmp(&orchestra_parent_linkaddr, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(int mac_status)
+{
+  uint8_t seqno;
+  uint8_t i;
+
+  if(!is_dao_to_parent()) {
+    return;
+  }
+  seqno = packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO);
+  for(i = 0; i < DAOS_IN_FLIGHT; i++) {
+    if(daos[i].seqno != 0 && daos[i].seqno == seqno) {
+      daos[i].seqno = 0;
+      /* Our parent ACKed this DAO, so it listens in the cells it announced */
+      if(mac_status == MAC_TX_OK) {
+        announced_cells = daos[i].cells;
+        set_tx_cells(MIN(daos[i].cells, wanted_cells));
+      }
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+orchestra_callback_dao_option_output(struct rpl_parent *parent,
+                                     const uip_ipaddr_t *target, uint8_t *buffer)
+{
+  const linkaddr_t *addr;
+  uint8_t cells;
+
+  /* Only in our own DAOs, not in No-Path DAOs for others */
+  if(!uip_ds6_is_my_addr((uip_ipaddr_t *)target)) {
+    sending_cells = -1;
+    return 0;
+  }
+  addr = (const linkaddr_t *)nbr_table_get_lladdr(rpl_parents, parent);
+  cells = addr != NULL && linkaddr_cmp(addr, &orchestra_parent_linkaddr) ? wanted_cells : 0;
+
+  buffer[0] = ORCHESTRA_ADAPTIVE_DAO_OPTION;
+  buffer[1] = 2;
+  buffer[2] = cells;
+  buffer[3] = 0; /* reserved */
+  /* Kept for the frame of this DAO, see select_packet() */
+  sending_cells = cells;
+  return 4;
+}
+/*---------------------------------------------------------------------------*/
+void
+orchestra_callback_dao_option_input(const uip_ipaddr_t *from,
+                                    const uip_ipaddr_t *target, const uint8_t *option)
+{
+  uip_ds6_nbr_t *nbr;
+  const linkaddr_t *addr;
+  uint8_t *cells;
+  uint8_t wanted;
+
+  if(option[0] != ORCHESTRA_ADAPTIVE_DAO_OPTION || option[1] < 1) {
+    return;
+  }
+  /* Only the child's own DAO tells about the link from it, not the DAOs
+   * it forwards: the target must have the interface ID of the sender */
+  if(memcmp(&from->u8[8], &target->u8[8], 8) != 0) {
+    return;
+  }
+  nbr = uip_ds6_nbr_lookup(from);
+  if(nbr == NULL) {
+    return;
+  }
+  addr = (const linkaddr_t *)uip_ds6_nbr_get_ll(nbr);
+
+  wanted = MIN(option[2], ORCHESTRA_ADAPTIVE_MAX_CELLS);
+  cells = nbr_table_get_from_lladdr(child_cells, addr);
+  if(wanted > 0) {
+    if(cells == NULL) {
+      cells = nbr_table_add_lladdr(child_cells, addr);
+      if(cells == NULL) {
+        return;
+      }
+      nbr_table_lock(child_cells, cells);
+    }
+    *cells = wanted;
+  } else if(cells != NULL) {
+    nbr_table_remove(child_cells, cells);
+  }
+  update_links();
+}
+/*---------------------------------------------------------------------------*/
+static void
+child_removed(const linkaddr_t *linkaddr)
+{
+  uint8_t *cells;
+
+  cells = nbr_table_get_from_lladdr(child_cells, linkaddr);
+  if(cells != NULL) {
+    nbr_table_remove(child_cells, cells);
+    update_links();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+select_packet(uint16_t *slotframe, uint16_t *timeslot)
+{
+  /* Select data packets to our parent once we have cells to it */
+  const linkaddr_t *dest = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+
+  /* The DAO built last is being queued: remember its frame. The oldest
+   * entry is overwritten if that many DAOs are in flight. */
+  if(sending_cells >= 0 && is_dao_to_parent()) {
+    daos[dao_next].seqno = packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO);
+    daos[dao_next].cells = sending_cells;
+    dao_next = (dao_next + 1) % DAOS_IN_FLIGHT;
+    sending_cells = -1;
+  }
+  if(tx_cells > 0
+     && packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) == FRAME802154_DATAFRAME
+     && linkaddr_cmp(dest, &orchestra_parent_linkaddr)) {
+    if(slotframe != NULL) {
+      *slotframe = slotframe_handle;
+    }
+    if(timeslot != NULL) {
+      *timeslot = 0xffff;
+    }
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new)
+{
+  if(new != old) {
+    /* Start over with the new parent */
+    wanted_cells = 0;
+    announced_cells = 0;
+    idle_checks = 0;
+    memset(daos, 0, sizeof(daos));
+    sending_cells = -1;
+    set_tx_cells(0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(uint16_t sf_handle)
+{
+  slotframe_handle = sf_handle;
+  channel_offset = sf_handle;
+  /* Slotframe for the extra cells, empty until a link gets busy */
+  sf_adaptive = tsch_schedule_add_slotframe(slotframe_handle, ORCHESTRA_ADAPTIVE_PERIOD);
+  nbr_table_register(child_cells, NULL);
+  ctimer_set(&check_timer, ORCHESTRA_ADAPTIVE_INTERVAL, check, NULL);
+}
+/*---------------------------------------------------------------------------*/
+struct orchestra_rule unicast_adaptive = {
+  init,
+  new_time_source,
+  select_packet,
+  NULL,
+  child_removed,
+  packet_sent,
+};
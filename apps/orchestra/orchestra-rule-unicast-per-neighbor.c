@@ -191,4 +191,5 @@ struct orchestra_rule unicast_per_neighbor = {
   select_packet,
   child_added,
   child_removed,
+  NULL,
 };
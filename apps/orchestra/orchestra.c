@@ -69,6 +69,8 @@ orchestra_packet_received(void)
 static void
 orchestra_packet_sent(int mac_status)
 {
+  int i;
+
   /* Check if our parent just ACKed a DAO */
   if(orchestra_parent_knows_us == 0
      && mac_status == MAC_TX_OK
@@ -79,6 +81,12 @@ orchestra_packet_sent(int mac_status)
       orchestra_parent_knows_us = 1;
     }
   }
+  /* Only one sniffer can be set, so the rules get their call from ours */
+  for(i = 0; i < NUM_RULES; i++) {
+    if(all_rules[i]->packet_sent != NULL) {
+      all_rules[i]->packet_sent(mac_status);
+    }
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
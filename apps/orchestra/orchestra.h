@@ -41,6 +41,7 @@
 #include "net/mac/tsch/tsch.h"
 #include "net/mac/tsch/tsch-conf.h"
 #include "net/mac/tsch/tsch-schedule.h"
+#include "net/ip/uip.h"
 #include "orchestra-conf.h"
 
 /* The structure of an Orchestra rule */
@@ -50,10 +51,12 @@ struct orchestra_rule {
   int  (* select_packet)(uint16_t *slotframe, uint16_t *timeslot);
   void (* child_added)(const linkaddr_t *addr);
   void (* child_removed)(const linkaddr_t *addr);
+  void (* packet_sent)(int mac_status);
 };
 
 struct orchestra_rule eb_per_time_source;
 struct orchestra_rule unicast_per_neighbor;
+struct orchestra_rule unicast_adaptive;
 struct orchestra_rule default_common;
 
 extern linkaddr_t orchestra_parent_linkaddr;
@@ -70,5 +73,11 @@ void orchestra_callback_new_time_source(const struct tsch_neighbor *old, const s
 void orchestra_callback_child_added(const linkaddr_t *addr);
 /* Set with #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed */
 void orchestra_callback_child_removed(const linkaddr_t *addr);
+/* With the unicast_adaptive rule only, set with
+ * #define RPL_CALLBACK_DAO_OPTION_OUTPUT orchestra_callback_dao_option_output
+ * #define RPL_CALLBACK_DAO_OPTION_INPUT orchestra_callback_dao_option_input */
+struct rpl_parent;
+int orchestra_callback_dao_option_output(struct rpl_parent *parent, const uip_ipaddr_t *target, uint8_t *buffer);
+void orchestra_callback_dao_option_input(const uip_ipaddr_t *from, const uip_ipaddr_t *target, const uint8_t *option);
 
 #endif /* __ORCHESTRA_H__ */
@@ -40,6 +40,7 @@
 #include "contiki.h"
 #include "contiki-lib.h"
 #include "sys/compower.h"
+#include "lib/crc16.h"
 #include "powertrace.h"
 #include "net/rime/rime.h"
 
@@ -64,6 +65,33 @@ struct powertrace_sniff_stats {
 
 #define MAX_NUM_STATS  16
 
+/* Send binary reports instead of text lines from the periodic process */
+#ifdef POWERTRACE_CONF_BINARY
+#define POWERTRACE_BINARY POWERTRACE_CONF_BINARY
+#else /* POWERTRACE_CONF_BINARY */
+#define POWERTRACE_BINARY 0
+#endif /* POWERTRACE_CONF_BINARY */
+
+/* Where the bytes of the binary reports go */
+#ifdef POWERTRACE_CONF_BINARY_PUTCHAR
+#define BINARY_PUTCHAR(c) POWERTRACE_CONF_BINARY_PUTCHAR(c)
+#else /* POWERTRACE_CONF_BINARY_PUTCHAR */
+#define BINARY_PUTCHAR(c) putchar(c)
+#endif /* POWERTRACE_CONF_BINARY_PUTCHAR */
+
+/* How often the process names are sent again, in reports */
+#ifdef POWERTRACE_CONF_BINARY_NAME_INTERVAL
+#define POWERTRACE_BINARY_NAME_INTERVAL POWERTRACE_CONF_BINARY_NAME_INTERVAL
+#else /* POWERTRACE_CONF_BINARY_NAME_INTERVAL */
+#define POWERTRACE_BINARY_NAME_INTERVAL 16
+#endif /* POWERTRACE_CONF_BINARY_NAME_INTERVAL */
+
+#if ENERGEST_CONF_ON && ENERGEST_PROCESS
+#define PROCESS_SLOTS ENERGEST_PROCESS_SLOTS
+#else /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
+#define PROCESS_SLOTS 0
+#endif /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
+
 MEMB(stats_memb, struct powertrace_sniff_stats, MAX_NUM_STATS);
 LIST(stats_list);
 
@@ -190,6 +218,108 @@ powertrace_print(char *str)
   }
   seqno++;
 }
+static uint8_t frame[35 + PROCESS_SLOTS * 17];
+static uint16_t framelen;
+/*---------------------------------------------------------------------------*/
+static void
+put(unsigned long value, int bytes)
+{
+  while(bytes-- > 0) {
+    frame[framelen++] = value & 0xff;
+    value >>= 8;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_frame(void)
+{
+  unsigned short crc;
+  uint16_t i;
+
+  crc = crc16_data(frame, framelen, 0);
+  BINARY_PUTCHAR(POWERTRACE_BINARY_MAGIC0);
+  BINARY_PUTCHAR(POWERTRACE_BINARY_MAGIC1);
+  BINARY_PUTCHAR(framelen & 0xff);
+  BINARY_PUTCHAR(framelen >> 8);
+  for(i = 0; i < framelen; i++) {
+    BINARY_PUTCHAR(frame[i]);
+  }
+  BINARY_PUTCHAR(crc & 0xff);
+  BINARY_PUTCHAR(crc >> 8);
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_frame(char type)
+{
+  framelen = 0;
+  put(type, 1);
+  put(linkaddr_node_addr.u8[0], 1);
+  put(linkaddr_node_addr.u8[1], 1);
+}
+/*---------------------------------------------------------------------------*/
+#if PROCESS_SLOTS
+static void
+send_name(uint8_t slot)
+{
+  const char *name;
+
+  name = PROCESS_NAME_STRING(energest_process_time[slot].p);
+  start_frame('N');
+  put(slot, 1);
+  while(*name != 0 && framelen < sizeof(frame)) {
+    put(*name++, 1);
+  }
+  send_frame();
+}
+#endif /* PROCESS_SLOTS */
+/*---------------------------------------------------------------------------*/
+void
+powertrace_print_binary(void)
+{
+  static unsigned long seqno;
+#if PROCESS_SLOTS
+  static struct process *named[PROCESS_SLOTS];
+  struct energest_process *e;
+  uint8_t i;
+#endif /* PROCESS_SLOTS */
+
+  energest_flush();
+
+#if PROCESS_SLOTS
+  /* Name the slots before the counters that refer to them */
+  for(i = 0; i < PROCESS_SLOTS; i++) {
+    e = &energest_process_time[i];
+    if(e->p != NULL &&
+       (e->p != named[i] || seqno % POWERTRACE_BINARY_NAME_INTERVAL == 0)) {
+      send_name(i);
+    }
+    named[i] = e->p;
+  }
+#endif /* PROCESS_SLOTS */
+
+  start_frame('P');
+  put(seqno++, 4);
+  put(clock_time(), 4);
+  put(energest_type_time(ENERGEST_TYPE_CPU), 4);
+  put(energest_type_time(ENERGEST_TYPE_LPM), 4);
+  put(energest_type_time(ENERGEST_TYPE_TRANSMIT), 4);
+  put(energest_type_time(ENERGEST_TYPE_LISTEN), 4);
+  put(compower_idle_activity.transmit, 4);
+  put(compower_idle_activity.listen, 4);
+#if PROCESS_SLOTS
+  for(i = 0; i < PROCESS_SLOTS; i++) {
+    e = &energest_process_time[i];
+    if(e->p != NULL) {
+      put(i, 1);
+      put(e->events, 4);
+      put(e->cpu, 4);
+      put(e->transmit, 4);
+      put(e->listen, 4);
+    }
+  }
+#endif /* PROCESS_SLOTS */
+  send_frame();
+}
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(powertrace_process, ev, data)
 {
@@ -207,7 +337,11 @@ PROCESS_THREAD(powertrace_process, ev, data)
   while(1) {
     PROCESS_WAIT_UNTIL(etimer_expired(&periodic));
     etimer_reset(&periodic);
+#if POWERTRACE_BINARY
+    powertrace_print_binary();
+#else /* POWERTRACE_BINARY */
     powertrace_print("");
+#endif /* POWERTRACE_BINARY */
   }
 
   PROCESS_END();
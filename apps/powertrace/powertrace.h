@@ -54,4 +54,31 @@ void powertrace_sniff(powertrace_onoff_t onoff);
 
 void powertrace_print(char *str);
 
+/*
+ * The binary report is a compact alternative to the text lines, for
+ * continuous profiling. Each report is a frame of
+ *
+ *   0xaa 0x55, payload length (2 bytes), payload, CRC16 of the payload
+ *
+ * with all numbers little-endian, so that tools/powertrace/
+ * parse-binary-data can pick the frames out of a serial log. A 'P'
+ * payload holds cumulative counters, which wrap at 32 bits:
+ *
+ *   'P', node address (2), seqno (4), clock time (4), cpu, lpm,
+ *   transmit, listen, idle transmit, idle listen (4 each), followed
+ *   for each process slot in use (see ENERGEST_CONF_PROCESS) by
+ *   slot (1), events, cpu, transmit, listen (4 each)
+ *
+ * An 'N' payload names the process in a slot:
+ *
+ *   'N', node address (2), slot (1), process name
+ *
+ * and is sent when the slot changes owner and every
+ * POWERTRACE_BINARY_NAME_INTERVAL reports.
+ */
+#define POWERTRACE_BINARY_MAGIC0 0xaa
+#define POWERTRACE_BINARY_MAGIC1 0x55
+
+void powertrace_print_binary(void);
+
 #endif /* POWERTRACE_H */
@@ -40,6 +40,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "contiki.h"
+#include "lib/memb.h"
 #include "rest-engine.h"
 
 #define DEBUG 0
@@ -54,11 +55,162 @@
 #define PRINTLLADDR(addr)
 #endif
 
+/*
+ * With index nodes, requests are dispatched through a radix tree over
+ * the resource paths, so that the cost of finding a resource depends on
+ * the length of the path rather than on the number of resources. Each
+ * resource takes at most two nodes. The labels point into the path
+ * strings of the resources. If the nodes run out, the requests are
+ * dispatched by walking the list of resources instead, with the same
+ * matching. Off by default: it only pays off with many resources.
+ */
+#ifdef REST_ENGINE_CONF_INDEX_NODES
+#define INDEX_NODES REST_ENGINE_CONF_INDEX_NODES
+#else /* REST_ENGINE_CONF_INDEX_NODES */
+#define INDEX_NODES 0
+#endif /* REST_ENGINE_CONF_INDEX_NODES */
+
 PROCESS(rest_engine_process, "REST Engine");
 /*---------------------------------------------------------------------------*/
 LIST(restful_services);
 LIST(restful_periodic_services);
 /*---------------------------------------------------------------------------*/
+#if INDEX_NODES
+struct index_node {
+  struct index_node *child;   /* first child */
+  struct index_node *sibling; /* next child, starting with another character */
+  const char *label;          /* the part of the path on the edge to this node */
+  uint8_t len;
+  resource_t *resource;       /* the resource whose path ends here */
+};
+
+MEMB(index_memb, struct index_node, INDEX_NODES);
+static struct index_node index_root;
+static uint8_t index_complete = 1;
+/*---------------------------------------------------------------------------*/
+static int
+index_add(resource_t *resource)
+{
+  struct index_node *node, *c, *mid, **link;
+  const char *path;
+  int len, i;
+
+  node = &index_root;
+  path = resource->url;
+  len = strlen(path);
+
+  while(len > 0) {
+    for(link = &node->child; *link != NULL && (*link)->label[0] != *path;
+        link = &(*link)->sibling);
+    c = *link;
+
+    if(c == NULL) {
+      /* Nothing shares the rest of the path, so it becomes a new leaf */
+      if(len > 0xff || (c = memb_alloc(&index_memb)) == NULL) {
+        return 0;
+      }
+      c->child = NULL;
+      c->sibling = node->child;
+      c->label = path;
+      c->len = len;
+      c->resource = resource;
+      node->child = c;
+      return 1;
+    }
+
+    for(i = 1; i < c->len && i < len && c->label[i] == path[i]; i++);
+    if(i < c->len) {
+      /* Split the edge where the paths part */
+      if((mid = memb_alloc(&index_memb)) == NULL) {
+        return 0;
+      }
+      mid->child = c;
+      mid->sibling = c->sibling;
+      mid->label = c->label;
+      mid->len = i;
+      mid->resource = NULL;
+      c->sibling = NULL;
+      c->label += i;
+      c->len -= i;
+      *link = mid;
+      c = mid;
+    }
+    node = c;
+    path += i;
+    len -= i;
+  }
+
+  /* The first resource activated for a path keeps it, as in the list */
+  if(node->resource == NULL) {
+    node->resource = resource;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Finds the resource for a path, or the parent resource with the
+   longest path that the path is a sub-resource of */
+static resource_t *
+index_lookup(const char *url, int url_len)
+{
+  struct index_node *node, *c;
+  resource_t *parent;
+
+  node = &index_root;
+  parent = NULL;
+
+  while(1) {
+    if(node->resource != NULL) {
+      if(url_len == 0) {
+        return node->resource;
+      }
+      if((node->resource->flags & HAS_SUB_RESOURCES) && *url == '/') {
+        parent = node->resource;
+      }
+    }
+    if(url_len == 0) {
+      break;
+    }
+    for(c = node->child; c != NULL && c->label[0] != *url; c = c->sibling);
+    if(c == NULL || c->len > url_len || memcmp(c->label, url, c->len) != 0) {
+      break;
+    }
+    node = c;
+    url += c->len;
+    url_len -= c->len;
+  }
+  return parent;
+}
+#endif /* INDEX_NODES */
+/*---------------------------------------------------------------------------*/
+/* Finds the resource for a path by walking the list, with the same
+   matching as index_lookup(): the first resource activated for the
+   path, or else the parent resource with the longest path */
+static resource_t *
+list_lookup(const char *url, int url_len)
+{
+  resource_t *resource, *parent;
+  int res_url_len, parent_len;
+
+  parent = NULL;
+  parent_len = -1;
+  for(resource = (resource_t *)list_head(restful_services);
+      resource; resource = resource->next) {
+    res_url_len = strlen(resource->url);
+    if(url_len == res_url_len) {
+      if(strncmp(resource->url, url, res_url_len) == 0) {
+        return resource;
+      }
+    } else if(url_len > res_url_len && res_url_len > parent_len
+              && (resource->flags & HAS_SUB_RESOURCES)
+              && url[res_url_len] == '/'
+              && strncmp(resource->url, url, res_url_len) == 0) {
+      parent = resource;
+      parent_len = res_url_len;
+    }
+  }
+  return parent;
+}
+/*---------------------------------------------------------------------------*/
 /*- REST Engine API ---------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 /**
@@ -80,6 +232,9 @@ rest_init_engine(void)
   initialized = 1;
 
   list_init(restful_services);
+#if INDEX_NODES
+  memb_init(&index_memb);
+#endif /* INDEX_NODES */
 
   REST.set_service_callback(rest_invoke_restful_service);
 
@@ -104,6 +259,12 @@ rest_activate_resource(resource_t *resource, char *path)
 {
   resource->url = path;
   list_add(restful_services, resource);
+#if INDEX_NODES
+  if(index_complete && !index_add(resource)) {
+    PRINTF("Resource index full, dispatching through the list\n");
+    index_complete = 0;
+  }
+#endif /* INDEX_NODES */
 
   PRINTF("Activating: %s\n", resource->url);
 
@@ -116,6 +277,39 @@ rest_activate_resource(resource_t *resource, char *path)
   }
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Picks the content-format of a response from the Accept option
+ * \param request The request
+ * \param response The response
+ * \param formats The content-formats the resource can write, the one
+ *        to write when the request accepts any first
+ * \param count The number of content-formats
+ * \return The content-format, which is set in the response, or -1
+ *         when the request accepts none of them
+ *
+ * When the request accepts none of the content-formats, the response
+ * status is set to Not Acceptable.
+ */
+int
+rest_select_content_format(void *request, void *response,
+                           const unsigned int *formats, int count)
+{
+  unsigned int accept;
+  int i;
+
+  if(!REST.get_header_accept(request, &accept)) {
+    accept = formats[0];
+  }
+  for(i = 0; i < count; i++) {
+    if(formats[i] == accept) {
+      REST.set_header_content_type(response, accept);
+      return accept;
+    }
+  }
+  REST.set_response_status(response, REST.status.NOT_ACCEPTABLE);
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 list_t
@@ -133,44 +327,42 @@ rest_invoke_restful_service(void *request, void *response, uint8_t *buffer,
 
   resource_t *resource = NULL;
   const char *url = NULL;
-  int url_len, res_url_len;
+  int url_len;
 
   url_len = REST.get_url(request, &url);
-  for(resource = (resource_t *)list_head(restful_services);
-      resource; resource = resource->next) {
+#if INDEX_NODES
+  if(index_complete) {
+    resource = index_lookup(url, url_len);
+  } else
+#endif /* INDEX_NODES */
+  {
+    resource = list_lookup(url, url_len);
+  }
 
-    /* if the web service handles that kind of requests and urls matches */
-    res_url_len = strlen(resource->url);
-    if((url_len == res_url_len
-        || (url_len > res_url_len
-            && (resource->flags & HAS_SUB_RESOURCES)
-            && url[res_url_len] == '/'))
-       && strncmp(resource->url, url, res_url_len) == 0) {
-      found = 1;
-      rest_resource_flags_t method = REST.get_method_type(request);
-
-      PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
-             (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
+  if(resource != NULL) {
+    found = 1;
+    rest_resource_flags_t method = REST.get_method_type(request);
+
+    PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
+           (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
                                offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
-      }
-      break;
+    } else {
+      allowed = 0;
+      REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
     }
   }
   if(!found) {
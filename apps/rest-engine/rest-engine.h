@@ -248,6 +248,20 @@ void rest_init_engine(void);
  */
 void rest_activate_resource(resource_t *resource, char *path);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Picks the content-format of a response from the Accept
+ *             option of the request and sets it in the response.
+ * \param formats
+ *             The content-formats the resource can write, the one to
+ *             write when the request accepts any first.
+ * \param count
+ *             The number of content-formats.
+ * \return     The content-format, or -1 with the response status set
+ *             to Not Acceptable when the request accepts none of them.
+ */
+int rest_select_content_format(void *request, void *response,
+                               const unsigned int *formats, int count);
+/*---------------------------------------------------------------------------*/
 /**
  * \brief      Returns the list of registered RESTful resources.
  * \return     The resource list.
@@ -115,6 +115,17 @@ PROCESS_THREAD(shell_exec_process, ev, data)
     }
     shell_output_str(&exec_command, print, symbol);
 
+#if ELFLOADER_STATS
+    {
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%lu bytes in %lu ms, %lu reads, %lu relocations",
+	       elfloader_stats.module_size,
+	       elfloader_stats.load_time * 1000 / CLOCK_SECOND,
+	       elfloader_stats.reads, elfloader_stats.relocations);
+      shell_output_str(&exec_command, "exec: loaded ", buf);
+    }
+#endif /* ELFLOADER_STATS */
+
     if(ret == ELFLOADER_OK) {
       int i;
       for(i = 0; elfloader_autostart_processes[i] != NULL; ++i) {
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         The netperf6 shell command: UDP, TCP and CoAP throughput,
+ *         latency and energy towards an IPv6 peer
+ */
+
+#include "contiki.h"
+#include "shell.h"
+#include "shell-netperf6.h"
+#include "netperf6.h"
+#include "net/ip/uiplib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+PROCESS(shell_netperf6_process, "netperf6");
+SHELL_COMMAND(netperf6_command,
+              "netperf6",
+              "netperf6 <udp|tcp|coap> <stream|rr|pingpong> <addr> [size] [count]: measure IPv6 performance",
+              &shell_netperf6_process);
+/*---------------------------------------------------------------------------*/
+static const char *
+next_word(const char *str, char *word, int size)
+{
+  int len;
+
+  while(*str == ' ') {
+    str++;
+  }
+  for(len = 0; str[len] != '\0' && str[len] != ' '; len++);
+  if(len >= size) {
+    len = size - 1;
+  }
+  memcpy(word, str, len);
+  word[len] = '\0';
+  return str + len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+lookup(const char *word, const char * const *names, int count)
+{
+  int i;
+
+  for(i = 0; i < count; i++) {
+    if(strcmp(word, names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_netperf6_process, ev, data)
+{
+  static const char * const protos[] = { "udp", "tcp", "coap" };
+  static const char * const modes[] = { "stream", "rr", "pingpong" };
+  static char buf[200];
+  static uip_ipaddr_t addr;
+  const char *args;
+  int proto, mode;
+  unsigned long size, count;
+
+  PROCESS_EXITHANDLER(netperf6_stop());
+
+  PROCESS_BEGIN();
+
+  args = data;
+  if(args == NULL) {
+    args = "";
+  }
+  args = next_word(args, buf, sizeof(buf));
+  proto = lookup(buf, protos, 3);
+  args = next_word(args, buf, sizeof(buf));
+  mode = lookup(buf, modes, 3);
+  args = next_word(args, buf, sizeof(buf));
+  if(proto < 0 || mode < 0 || uiplib_ipaddrconv(buf, &addr) == 0) {
+    shell_output_str(&netperf6_command,
+                     "netperf6 <udp|tcp|coap> <stream|rr|pingpong> <addr> [size] [count]", "");
+    PROCESS_EXIT();
+  }
+  size = strtoul(args, (char **)&args, 10);
+  count = strtoul(args, NULL, 10);
+
+  if(!netperf6_start(PROCESS_CURRENT(), &addr, proto, mode,
+                     size > 0 ? size : 64, count > 0 ? count : 100)) {
+    shell_output_str(&netperf6_command, "netperf6: cannot start test", "");
+    PROCESS_EXIT();
+  }
+
+  PROCESS_WAIT_EVENT_UNTIL(ev == netperf6_event);
+  netperf6_format(data, buf, sizeof(buf));
+  shell_output_str(&netperf6_command, buf, "");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_netperf6_init(void)
+{
+  shell_register_command(&netperf6_command);
+}
+/*---------------------------------------------------------------------------*/
@@ -37,12 +37,15 @@
 int snprintf(char *str, size_t size, const char *format, ...);
 #endif /* HAVE_SNPRINTF */
 #include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
 
 #include "contiki-net.h"
 
 #include "webserver.h"
 #include "cfs/cfs.h"
 #include "lib/petsciiconv.h"
+#include "lib/crc16.h"
 #include "http-strings.h"
 #include "urlconv.h"
 
@@ -60,17 +63,211 @@ int snprintf(char *str, size_t size, const char *format, ...);
 #define URLCONV WEBSERVER_CONF_CFS_URLCONV
 #endif /* WEBSERVER_CONF_CFS_URLCONV */
 
+/* Keep connections open after a response when the client asks for it
+   (HTTP/1.1, or Connection: keep-alive) and the file size is known. */
+#ifndef WEBSERVER_CONF_CFS_KEEPALIVE
+#define KEEPALIVE 1
+#else /* WEBSERVER_CONF_CFS_KEEPALIVE */
+#define KEEPALIVE WEBSERVER_CONF_CFS_KEEPALIVE
+#endif /* WEBSERVER_CONF_CFS_KEEPALIVE */
+
+#define FILE_CACHE HTTPD_FILE_CACHE
+
 #define STATE_WAITING 0
 #define STATE_OUTPUT  1
+#define STATE_CLOSED  2
+
+#define FLAG_KEEPALIVE 0x01 /* The client wants a persistent connection */
+#define FLAG_CLOSE     0x02 /* Close the connection after the response */
+#define FLAG_ETAG      0x04 /* The request carries an If-None-Match tag */
+#define FLAG_BAD       0x08 /* The request is not a GET request */
 
 #define SEND_STRING(s, str) PSOCK_SEND(s, (uint8_t *)str, strlen(str))
 MEMB(conns, struct httpd_state, CONNS);
 
 #define ISO_nl      0x0a
+#define ISO_cr      0x0d
 #define ISO_space   0x20
+#define ISO_quot    0x22
+#define ISO_dash    0x2d
 #define ISO_period  0x2e
 #define ISO_slash   0x2f
 
+#if FILE_CACHE
+struct file_cache {
+  char name[HTTPD_PATHLEN];
+  int fd;
+  cfs_offset_t size;
+  unsigned short crc;
+  uint8_t refs;
+  uint8_t used;
+};
+
+static struct file_cache files[FILE_CACHE];
+static uint8_t file_clock;
+
+/*---------------------------------------------------------------------------*/
+static int
+validate(struct file_cache *f)
+{
+  static uint8_t buf[32];
+  int len;
+
+  f->size = cfs_seek(f->fd, 0, CFS_SEEK_END);
+  if(f->size == (cfs_offset_t)-1 || cfs_seek(f->fd, 0, CFS_SEEK_SET) != 0) {
+    return 0;
+  }
+  f->crc = 0;
+  while((len = cfs_read(f->fd, buf, sizeof(buf))) > 0) {
+    f->crc = crc16_data(buf, len, f->crc);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+uncache(struct file_cache *f)
+{
+  if(f->fd >= 0) {
+    cfs_close(f->fd);
+    f->fd = -1;
+  }
+  f->name[0] = 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct file_cache *
+cache_open(const char *name)
+{
+  struct file_cache *f;
+  struct file_cache *victim;
+
+  victim = NULL;
+  for(f = files; f < &files[FILE_CACHE]; f++) {
+    if(f->fd >= 0 && strcmp(f->name, name) == 0) {
+      /* A file that has changed size since it was cached gets a new
+         ETag, unless other connections are still sending it. */
+      if(cfs_seek(f->fd, 0, CFS_SEEK_END) != f->size) {
+        if(f->refs > 0) {
+          return NULL;
+        }
+        if(!validate(f)) {
+          uncache(f);
+          return NULL;
+        }
+      }
+      f->refs++;
+      f->used = ++file_clock;
+      return f;
+    }
+    if(f->refs == 0 &&
+       (victim == NULL || f->fd < 0 ||
+        (victim->fd >= 0 &&
+         (uint8_t)(file_clock - f->used) >
+         (uint8_t)(file_clock - victim->used)))) {
+      victim = f;
+    }
+  }
+
+  if(victim == NULL) {
+    return NULL;
+  }
+  uncache(victim);
+  victim->fd = cfs_open(&name[1], CFS_READ);
+  if(victim->fd < 0) {
+    return NULL;
+  }
+  if(!validate(victim)) {
+    uncache(victim);
+    return NULL;
+  }
+  strncpy(victim->name, name, sizeof(victim->name));
+  victim->refs = 1;
+  victim->used = ++file_clock;
+  return victim;
+}
+/*---------------------------------------------------------------------------*/
+static void
+cache_release(struct file_cache *f)
+{
+  if(--f->refs == 0 && f->name[0] == 0) {
+    uncache(f);
+  }
+}
+#endif /* FILE_CACHE */
+/*---------------------------------------------------------------------------*/
+void
+httpd_cfs_flush(void)
+{
+#if FILE_CACHE
+  struct file_cache *f;
+
+  for(f = files; f < &files[FILE_CACHE]; f++) {
+    if(f->refs == 0) {
+      uncache(f);
+    } else {
+      /* Closed when the last connection is done with it */
+      f->name[0] = 0;
+    }
+  }
+#endif /* FILE_CACHE */
+}
+/*---------------------------------------------------------------------------*/
+static void
+open_file(struct httpd_state *s)
+{
+  s->offset = 0;
+  s->file = NULL;
+#if FILE_CACHE
+  s->file = cache_open(s->filename);
+  if(s->file != NULL) {
+    s->fd = ((struct file_cache *)s->file)->fd;
+    s->size = ((struct file_cache *)s->file)->size;
+    return;
+  }
+#endif /* FILE_CACHE */
+  s->fd = cfs_open(&s->filename[1], CFS_READ);
+  s->size = -1;
+  if(s->fd >= 0) {
+    s->size = cfs_seek(s->fd, 0, CFS_SEEK_END);
+    if(s->size != (cfs_offset_t)-1 && cfs_seek(s->fd, 0, CFS_SEEK_SET) != 0) {
+      /* Cannot rewind; read the file from a new handle */
+      cfs_close(s->fd);
+      s->fd = cfs_open(&s->filename[1], CFS_READ);
+      s->size = -1;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+close_file(struct httpd_state *s)
+{
+#if FILE_CACHE
+  if(s->file != NULL) {
+    cache_release((struct file_cache *)s->file);
+    s->file = NULL;
+    s->fd = -1;
+    return;
+  }
+#endif /* FILE_CACHE */
+  if(s->fd >= 0) {
+    cfs_close(s->fd);
+    s->fd = -1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_file(struct httpd_state *s, char *buf, int len)
+{
+  /* A shared handle may have been moved by another connection */
+  if(s->file != NULL &&
+     cfs_seek(s->fd, s->offset, CFS_SEEK_SET) != s->offset) {
+    return 0;
+  }
+  len = cfs_read(s->fd, buf, len);
+  if(len > 0) {
+    s->offset += len;
+  }
+  return len;
+}
 /*---------------------------------------------------------------------------*/
 static
 PT_THREAD(send_file(struct httpd_state *s))
@@ -79,7 +276,7 @@ PT_THREAD(send_file(struct httpd_state *s))
   
   do {
     /* Read data from file system into buffer */
-    s->len = cfs_read(s->fd, s->outputbuf, sizeof(s->outputbuf));
+    s->len = read_file(s, s->outputbuf, sizeof(s->outputbuf));
 
     /* If there is data in the buffer, send it */
     if(s->len > 0) {
@@ -125,102 +322,324 @@ get_content_type(const char *filename)
   return ptr;
 }
 /*---------------------------------------------------------------------------*/
+static int
+append(struct httpd_state *s, const char *str)
+{
+  int len;
+
+  len = strlen(str);
+  if(s->len + len > sizeof(s->outputbuf)) {
+    return 0;
+  }
+  memcpy(&s->outputbuf[s->len], str, len);
+  s->len += len;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Puts the headers of the response in outputbuf. A response that is not
+   followed by the file has an empty body. */
+static int
+make_headers(struct httpd_state *s, const char *statushdr, int with_file)
+{
+  char buf[24];
+
+  s->len = 0;
+  if(!append(s, statushdr)) {
+    return 0;
+  }
+  if(with_file && s->size != (cfs_offset_t)-1) {
+    snprintf(buf, sizeof(buf), "%lu\r\n", (unsigned long)s->size);
+    if(!append(s, http_content_length) || !append(s, buf)) {
+      return 0;
+    }
+  }
+#if FILE_CACHE
+  if(s->file != NULL) {
+    snprintf(buf, sizeof(buf), "\"%lx-%04x\"\r\n",
+             (unsigned long)s->size, ((struct file_cache *)s->file)->crc);
+    if(!append(s, http_etag) || !append(s, buf)) {
+      return 0;
+    }
+  }
+#endif /* FILE_CACHE */
+  return append(s, with_file ? get_content_type(s->filename) : http_crnl);
+}
+/*---------------------------------------------------------------------------*/
 static
-PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
+PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr,
+                       const char *keepalivehdr, int with_file))
 {
   PSOCK_BEGIN(&s->sout);
 
-  SEND_STRING(&s->sout, statushdr);
-  SEND_STRING(&s->sout, get_content_type(s->filename));
+  /* Keep the connection only if the client can tell where the response
+     ends, and leave a free connection for other clients. */
+  if(!KEEPALIVE || !(s->flags & FLAG_KEEPALIVE) ||
+     (with_file && s->size == (cfs_offset_t)-1) ||
+     memb_numfree(&conns) == 0) {
+    s->flags |= FLAG_CLOSE;
+  }
+
+  if(make_headers(s, (s->flags & FLAG_CLOSE) ? statushdr : keepalivehdr,
+                  with_file)) {
+    /* Fill the rest of the segment with the beginning of the file */
+    if(with_file) {
+      s->len += read_file(s, &s->outputbuf[s->len],
+                          sizeof(s->outputbuf) - s->len);
+    }
+    PSOCK_SEND(&s->sout, (uint8_t *)s->outputbuf, s->len);
+  } else {
+    /* The headers do not fit in one segment: send them as before and
+       close the connection to mark the end of the file */
+    s->flags |= FLAG_CLOSE;
+    SEND_STRING(&s->sout, statushdr);
+    SEND_STRING(&s->sout, get_content_type(s->filename));
+  }
 
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
+static int
+not_modified(struct httpd_state *s)
+{
+#if FILE_CACHE
+  return (s->flags & FLAG_ETAG) && s->file != NULL &&
+    s->etag_size == s->size &&
+    s->etag_crc == ((struct file_cache *)s->file)->crc;
+#else /* FILE_CACHE */
+  return 0;
+#endif /* FILE_CACHE */
+}
+/*---------------------------------------------------------------------------*/
 static
 PT_THREAD(handle_output(struct httpd_state *s))
 {
   PT_BEGIN(&s->outputpt);
 
   petsciiconv_topetscii(s->filename, sizeof(s->filename));
-  s->fd = cfs_open(&s->filename[1], CFS_READ);
+  open_file(s);
   petsciiconv_toascii(s->filename, sizeof(s->filename));
   if(s->fd < 0) {
     strcpy(s->filename, "/notfound.htm");
-    s->fd = cfs_open(&s->filename[1], CFS_READ);
+    open_file(s);
     petsciiconv_toascii(s->filename, sizeof(s->filename));
     PT_WAIT_THREAD(&s->outputpt,
-                   send_headers(s, http_header_404));
+                   send_headers(s, http_header_404,
+                                http_header_404_keepalive, 1));
     if(s->fd < 0) {
       PT_WAIT_THREAD(&s->outputpt,
                      send_string(s, "not found"));
-      uip_close();
+      s->flags |= FLAG_CLOSE;
       webserver_log_file(&uip_conn->ripaddr, "404 (no notfound.htm)");
       PT_EXIT(&s->outputpt);
     }
     webserver_log_file(&uip_conn->ripaddr, "404 - notfound.htm");
+  } else if(not_modified(s)) {
+    PT_WAIT_THREAD(&s->outputpt,
+                   send_headers(s, http_header_304,
+                                http_header_304_keepalive, 0));
+    close_file(s);
+    PT_EXIT(&s->outputpt);
   } else {
     PT_WAIT_THREAD(&s->outputpt,
-		   send_headers(s, http_header_200));
+		   send_headers(s, http_header_200,
+                                http_header_200_keepalive, 1));
   }
   PT_WAIT_THREAD(&s->outputpt, send_file(s));
-  cfs_close(s->fd);
-  s->fd = -1;
-  PSOCK_CLOSE(&s->sout);
+  close_file(s);
   PT_END(&s->outputpt);
 }
 /*---------------------------------------------------------------------------*/
-static
-PT_THREAD(handle_input(struct httpd_state *s))
+/* Returns non-zero if str contains token, ignoring case. */
+static int
+has_token(const char *str, const char *token)
 {
-  PSOCK_BEGIN(&s->sin);
+  int i;
 
-  PSOCK_READTO(&s->sin, ISO_space);
-  
-  if(strncmp(s->inputbuf, http_get, 4) != 0) {
-    PSOCK_CLOSE_EXIT(&s->sin);
+  for(; *str != 0; str++) {
+    for(i = 0; token[i] != 0 &&
+          tolower((unsigned char)str[i]) == token[i]; i++);
+    if(token[i] == 0) {
+      return 1;
+    }
   }
-  PSOCK_READTO(&s->sin, ISO_space);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+parse_etag(struct httpd_state *s, char *ptr)
+{
+  char *end;
+
+  ptr = strchr(ptr, ISO_quot);
+  if(ptr == NULL) {
+    return;
+  }
+  s->etag_size = (cfs_offset_t)strtoul(ptr + 1, &end, 16);
+  if(*end == ISO_dash) {
+    s->etag_crc = (unsigned short)strtoul(end + 1, &end, 16);
+    if(*end == ISO_quot) {
+      s->flags |= FLAG_ETAG;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_request_line(struct httpd_state *s)
+{
+  char *ptr;
 
-  if(s->inputbuf[0] != ISO_slash) {
-    PSOCK_CLOSE_EXIT(&s->sin);
+  if(strncmp(s->inputbuf, http_get, 4) != 0 ||
+     s->inputbuf[4] != ISO_slash) {
+    s->flags |= FLAG_BAD;
+    return;
+  }
+
+  /* The path ends at the space before the protocol version */
+  ptr = strchr(&s->inputbuf[4], ISO_space);
+  if(ptr != NULL) {
+    *ptr++ = 0;
+    if(strncmp(ptr, http_11, 8) == 0) {
+      s->flags |= FLAG_KEEPALIVE;
+    }
   }
 
 #if URLCONV
-  s->inputbuf[PSOCK_DATALEN(&s->sin) - 1] = 0;
-  urlconv_tofilename(s->filename, s->inputbuf, sizeof(s->filename));
+  urlconv_tofilename(s->filename, &s->inputbuf[4], sizeof(s->filename));
 #else /* URLCONV */
-  if(s->inputbuf[1] == ISO_space) {
+  if(s->inputbuf[5] == 0) {
     strncpy(s->filename, http_index_htm, sizeof(s->filename));
   } else {
-    s->inputbuf[PSOCK_DATALEN(&s->sin) - 1] = 0;
-    strncpy(s->filename, s->inputbuf, sizeof(s->filename));
+    strncpy(s->filename, &s->inputbuf[4], sizeof(s->filename));
   }
 #endif /* URLCONV */
 
   petsciiconv_topetscii(s->filename, sizeof(s->filename));
   webserver_log_file(&uip_conn->ripaddr, s->filename);
   petsciiconv_toascii(s->filename, sizeof(s->filename));
-  s->state = STATE_OUTPUT;
-
-  while(1) {
-    PSOCK_READTO(&s->sin, ISO_nl);
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_header_line(struct httpd_state *s)
+{
+  if(strncmp(s->inputbuf, http_connection, 11) == 0) {
+    if(has_token(&s->inputbuf[11], http_close)) {
+      s->flags &= ~FLAG_KEEPALIVE;
+    } else if(has_token(&s->inputbuf[11], http_keep_alive)) {
+      s->flags |= FLAG_KEEPALIVE;
+    }
+  } else if(strncmp(s->inputbuf, http_if_none_match, 14) == 0) {
+    parse_etag(s, &s->inputbuf[14]);
+  } else if(strncmp(s->inputbuf, http_referer, 8) == 0) {
+    petsciiconv_topetscii(s->inputbuf, s->inputlen);
+    webserver_log(s->inputbuf);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Feeds request data to the parser until a request is complete. Lines
+   that do not fit in the input buffer are cut short. Returns the number
+   of bytes used. */
+static int
+parse_input(struct httpd_state *s, const char *data, int len)
+{
+  int i;
+  char c;
 
-    if(strncmp(s->inputbuf, http_referer, 8) == 0) {
-      s->inputbuf[PSOCK_DATALEN(&s->sin) - 2] = 0;
-      petsciiconv_topetscii(s->inputbuf, PSOCK_DATALEN(&s->sin) - 2);
-      webserver_log(s->inputbuf);
+  for(i = 0; i < len && s->state == STATE_WAITING &&
+        !(s->flags & FLAG_BAD); i++) {
+    c = data[i];
+    if(c == ISO_nl) {
+      if(s->inputlen > 0 && s->inputbuf[s->inputlen - 1] == ISO_cr) {
+        s->inputlen--;
+      }
+      s->inputbuf[s->inputlen] = 0;
+      if(s->inputlen > 0) {
+        if(s->lines++ == 0) {
+          handle_request_line(s);
+        } else {
+          handle_header_line(s);
+        }
+      } else if(s->lines > 0) {
+        /* The empty line after the headers */
+        s->state = STATE_OUTPUT;
+      }
+      s->inputlen = 0;
+    } else if(s->inputlen < sizeof(s->inputbuf) - 1) {
+      s->inputbuf[s->inputlen++] = c;
     }
   }
-  
-  PSOCK_END(&s->sin);
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/* Keeps data that arrives before the current response is done. */
+static void
+buffer_input(struct httpd_state *s, const char *data, int len)
+{
+  if(len <= 0 || (s->flags & FLAG_CLOSE)) {
+    return;
+  }
+#if HTTPD_PIPELINE_LEN
+  if(s->pipelen + len <= sizeof(s->pipebuf)) {
+    memcpy(&s->pipebuf[s->pipelen], data, len);
+    s->pipelen += len;
+    return;
+  }
+#endif /* HTTPD_PIPELINE_LEN */
+  s->flags |= FLAG_CLOSE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+next_request(struct httpd_state *s)
+{
+#if HTTPD_PIPELINE_LEN
+  int len;
+#endif /* HTTPD_PIPELINE_LEN */
+
+  s->state = STATE_WAITING;
+  s->flags = 0;
+  s->lines = 0;
+  s->inputlen = 0;
+  PT_INIT(&s->outputpt);
+#if HTTPD_PIPELINE_LEN
+  len = parse_input(s, s->pipebuf, s->pipelen);
+  s->pipelen -= len;
+  memmove(s->pipebuf, &s->pipebuf[len], s->pipelen);
+#endif /* HTTPD_PIPELINE_LEN */
 }
 /*---------------------------------------------------------------------------*/
 static void
 handle_connection(struct httpd_state *s)
 {
-  handle_input(s);
-  if(s->state == STATE_OUTPUT) {
-    handle_output(s);
+  int len;
+
+  if(s->state == STATE_CLOSED) {
+    return;
+  }
+
+  /* Parse new data before sending, which overwrites it */
+  if(uip_newdata()) {
+    len = 0;
+    if(s->state == STATE_WAITING) {
+      len = parse_input(s, uip_appdata, uip_datalen());
+    }
+    buffer_input(s, (char *)uip_appdata + len, uip_datalen() - len);
+  }
+
+  while(s->state == STATE_OUTPUT) {
+    if(PT_SCHEDULE(handle_output(s))) {
+      return;
+    }
+    if(s->flags & FLAG_CLOSE) {
+      s->state = STATE_CLOSED;
+      uip_close();
+      return;
+    }
+    /* Serve the next pipelined request, if any */
+    next_request(s);
+  }
+
+  if(s->flags & FLAG_BAD) {
+    s->state = STATE_CLOSED;
+    uip_close();
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -231,10 +650,7 @@ httpd_appcall(void *state)
 
   if(uip_closed() || uip_aborted() || uip_timedout()) {
     if(s != NULL) {
-      if(s->fd >= 0) {
-        cfs_close(s->fd);
-	s->fd = -1;
-      }
+      close_file(s);
       memb_free(&conns, s);
     }
   } else if(uip_connected()) {
@@ -245,23 +661,28 @@ httpd_appcall(void *state)
       return;
     }
     tcp_markconn(uip_conn, s);
-    PSOCK_INIT(&s->sin, (uint8_t *)s->inputbuf, sizeof(s->inputbuf) - 1);
     PSOCK_INIT(&s->sout, (uint8_t *)s->inputbuf, sizeof(s->inputbuf) - 1);
-    PT_INIT(&s->outputpt);
     s->fd = -1;
-    s->state = STATE_WAITING;
+    s->file = NULL;
+#if HTTPD_PIPELINE_LEN
+    s->pipelen = 0;
+#endif /* HTTPD_PIPELINE_LEN */
+    next_request(s);
     timer_set(&s->timer, CLOCK_SECOND * 10);
     handle_connection(s);
   } else if(s != NULL) {
     if(uip_poll()) {
       if(timer_expired(&s->timer)) {
+        if(s->state == STATE_WAITING && s->lines == 0 && s->inputlen == 0) {
+          /* An idle persistent connection */
+          uip_close();
+          return;
+        }
 	uip_abort();
-	if(s->fd >= 0) {
-	  cfs_close(s->fd);
-	  s->fd = -1;
-	}
+	close_file(s);
         memb_free(&conns, s);
         webserver_log_file(&uip_conn->ripaddr, "reset (timeout)");
+        return;
       }
     } else {
       timer_restart(&s->timer);
@@ -275,6 +696,15 @@ httpd_appcall(void *state)
 void
 httpd_init(void)
 {
+#if FILE_CACHE
+  struct file_cache *f;
+
+  for(f = files; f < &files[FILE_CACHE]; f++) {
+    f->fd = -1;
+    f->name[0] = 0;
+    f->refs = 0;
+  }
+#endif /* FILE_CACHE */
   tcp_listen(UIP_HTONS(80));
   memb_init(&conns);
 #if URLCONV
@@ -35,6 +35,7 @@
 #define HTTPD_CFS_H_
 
 #include "contiki-net.h"
+#include "cfs/cfs.h"
 
 #ifndef WEBSERVER_CONF_CFS_PATHLEN
 #define HTTPD_PATHLEN 80
@@ -42,20 +43,66 @@
 #define HTTPD_PATHLEN WEBSERVER_CONF_CFS_PATHLEN
 #endif /* WEBSERVER_CONF_CFS_CONNS */
 
+/* The number of files kept open between requests. Connections that
+   serve the same file share its handle, and cached files carry an
+   ETag so that a conditional request for an unchanged file is answered
+   without opening or reading it. The ETag is the size and CRC of the
+   file, computed by reading the whole file when it enters the cache.
+   A cached file that is rewritten with the same size keeps its old
+   ETag, so applications that enable the cache must call
+   httpd_cfs_flush() after changing files. Off by default. */
+#ifndef WEBSERVER_CONF_CFS_FILE_CACHE
+#define HTTPD_FILE_CACHE 0
+#else /* WEBSERVER_CONF_CFS_FILE_CACHE */
+#define HTTPD_FILE_CACHE WEBSERVER_CONF_CFS_FILE_CACHE
+#endif /* WEBSERVER_CONF_CFS_FILE_CACHE */
+
+/* Room for pipelined requests that arrive while a response is sent. A
+   connection that receives more than this is closed after the current
+   response, and the client sends the rest again on a new one. The
+   buffer is part of every connection, so by default it is only there
+   when the file cache is enabled. */
+#ifndef WEBSERVER_CONF_CFS_PIPELINE
+#if HTTPD_FILE_CACHE
+#define HTTPD_PIPELINE_LEN 128
+#else /* HTTPD_FILE_CACHE */
+#define HTTPD_PIPELINE_LEN 0
+#endif /* HTTPD_FILE_CACHE */
+#else /* WEBSERVER_CONF_CFS_PIPELINE */
+#define HTTPD_PIPELINE_LEN WEBSERVER_CONF_CFS_PIPELINE
+#endif /* WEBSERVER_CONF_CFS_PIPELINE */
+
 struct httpd_state {
   struct timer timer;
-  struct psock sin, sout;
+  struct psock sout;
   struct pt outputpt;
   char inputbuf[HTTPD_PATHLEN + 30];
   char outputbuf[UIP_TCP_MSS];
   char filename[HTTPD_PATHLEN];
   char state;
+  uint8_t flags;
+  uint8_t lines;
+  unsigned short inputlen;
   int fd;
   int len;
+  void *file;
+  cfs_offset_t offset;
+  cfs_offset_t size;
+  cfs_offset_t etag_size;
+  unsigned short etag_crc;
+#if HTTPD_PIPELINE_LEN
+  unsigned short pipelen;
+  char pipebuf[HTTPD_PIPELINE_LEN];
+#endif /* HTTPD_PIPELINE_LEN */
 };
 
 
 void httpd_init(void);
 void httpd_appcall(void *state);
 
+/* Drops the cached file handles and their ETags. With
+   WEBSERVER_CONF_CFS_FILE_CACHE enabled, call this after changing
+   files that the web server may have served. */
+void httpd_cfs_flush(void);
+
 #endif /* HTTPD_CFS_H_ */
@@ -36,6 +36,7 @@
 #include "httpd.h"
 #include "httpd-fs.h"
 #include "httpd-fsdata.h"
+#include "http-strings.h"
 
 #include "httpd-fsdata.c"
 
@@ -65,6 +66,45 @@ loop:
   goto loop;
 }
 /*-----------------------------------------------------------------------------------*/
+#ifdef HTTPD_FS_INDEX
+/* Compares a name that ends at a NUL, CR or LF with a file name. */
+static int
+httpd_fs_namecmp(const char *name, const char *fname)
+{
+  uint8_t i;
+
+  for(i = 0; ; ++i) {
+    if(name[i] == 0 || name[i] == '\r' || name[i] == '\n') {
+      return fname[i] == 0 ? 0 : -1;
+    }
+    if(name[i] != fname[i]) {
+      return (unsigned char)name[i] - (unsigned char)fname[i];
+    }
+  }
+}
+/*-----------------------------------------------------------------------------------*/
+static const struct httpd_fsdata_index *
+httpd_fs_lookup(const char *name)
+{
+  int low, high, mid, cmp;
+
+  low = 0;
+  high = HTTPD_FS_NUMFILES - 1;
+  while(low <= high) {
+    mid = (low + high) / 2;
+    cmp = httpd_fs_namecmp(name, HTTPD_FS_INDEX[mid].file->name);
+    if(cmp == 0) {
+      return &HTTPD_FS_INDEX[mid];
+    } else if(cmp < 0) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return NULL;
+}
+#endif /* HTTPD_FS_INDEX */
+/*-----------------------------------------------------------------------------------*/
 int
 httpd_fs_open(const char *name, struct httpd_fs_file *file)
 {
@@ -72,7 +112,23 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
   uint16_t i = 0;
 #endif /* HTTPD_FS_STATISTICS */
   struct httpd_fsdata_file_noconst *f;
+#ifdef HTTPD_FS_INDEX
+  const struct httpd_fsdata_index *index;
+
+  index = httpd_fs_lookup(name);
+  if(index != NULL) {
+    file->data = (char *)index->file->data;
+    file->len = index->file->len;
+    file->content_type = index->content_type;
+#if HTTPD_FS_STATISTICS
+    ++count[index->num];
+#endif /* HTTPD_FS_STATISTICS */
+    return 1;
+  }
+#endif /* HTTPD_FS_INDEX */
 
+  /* A name that only begins with a file name, such as one followed by
+     a query string, is matched by the list walk below. */
   for(f = (struct httpd_fsdata_file_noconst *)HTTPD_FS_ROOT;
       f != NULL;
       f = (struct httpd_fsdata_file_noconst *)f->next) {
@@ -80,6 +136,7 @@ httpd_fs_open(const char *name, struct httpd_fs_file *file)
     if(httpd_fs_strcmp(name, f->name) == 0) {
       file->data = f->data;
       file->len = f->len;
+      file->content_type = NULL;
 #if HTTPD_FS_STATISTICS
       ++count[i];
 #endif /* HTTPD_FS_STATISTICS */
@@ -110,6 +167,14 @@ httpd_fs_count(char *name)
 {
   struct httpd_fsdata_file_noconst *f;
   uint16_t i;
+#ifdef HTTPD_FS_INDEX
+  const struct httpd_fsdata_index *index;
+
+  index = httpd_fs_lookup(name);
+  if(index != NULL) {
+    return count[index->num];
+  }
+#endif /* HTTPD_FS_INDEX */
 
   i = 0;
   for(f = (struct httpd_fsdata_file_noconst *)HTTPD_FS_ROOT;
@@ -41,6 +41,9 @@
 struct httpd_fs_file {
   char *data;
   int len;
+  /* Content type header line of the file, or NULL if httpd-fsdata.c
+     has no index to take it from. */
+  const char *content_type;
 };
 
 /* file must be allocated by caller and will be filled in
@@ -673,3 +673,18 @@ const struct httpd_fsdata_file       file_style_css[] ={{       file_404_html, d
 #define HTTPD_FS_ROOT  file_style_css
 #define HTTPD_FS_NUMFILES  10
 #define HTTPD_FS_SIZE 6166
+
+const struct httpd_fsdata_index httpd_fs_index[] = {
+  {file_404_html, 1, http_content_type_html},
+  {file_files_shtml, 7, http_content_type_html},
+  {file_footer_html, 8, http_content_type_html},
+  {file_header_html, 3, http_content_type_html},
+  {file_index_html, 2, http_content_type_html},
+  {file_processes_shtml, 9, http_content_type_html},
+  {file_status_shtml, 4, http_content_type_html},
+  {file_style_css, 0, http_content_type_css},
+  {file_tcp_shtml, 5, http_content_type_html},
+  {file_upload_html, 6, http_content_type_html},
+};
+
+#define HTTPD_FS_INDEX httpd_fs_index
@@ -60,4 +60,12 @@ struct httpd_fsdata_file_noconst {
 #endif /* HTTPD_FS_STATISTICS */
 };
 
+/* Entry of the name index appended by makefsdata -x: the files sorted
+   by name, their position in the linked list and their content type. */
+struct httpd_fsdata_index {
+  const struct httpd_fsdata_file *file;
+  uint16_t num;
+  const char *content_type;
+};
+
 #endif /* HTTPD_FSDATA_H_ */
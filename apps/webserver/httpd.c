@@ -86,11 +86,11 @@ PT_THREAD(send_file(struct httpd_state *s))
 {
   PSOCK_BEGIN(&s->sout);
   
-  do {
+  while(s->file.len > 0) {
     PSOCK_GENERATOR_SEND(&s->sout, generate, s);
     s->file.len -= s->len;
     s->file.data += s->len;
-  } while(s->file.len > 0);
+  }
       
   PSOCK_END(&s->sout);
 }
@@ -181,17 +181,14 @@ PT_THREAD(handle_script(struct httpd_state *s))
   PT_END(&s->scriptpt);
 }
 /*---------------------------------------------------------------------------*/
-static
-PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
+static const char *
+content_type(struct httpd_state *s)
 {
-/* gcc warning if not initialized. 
- * If initialized, minimal-net platform segmentation fault if not static...
- */
-  static const char *ptr = NULL;
+  const char *ptr;
 
-  PSOCK_BEGIN(&s->sout);
-
-  SEND_STRING(&s->sout, statushdr);
+  if(s->file.content_type != NULL) {
+    return s->file.content_type;
+  }
 
   ptr = strrchr(s->filename, ISO_period);
   if(ptr == NULL) {
@@ -210,15 +207,67 @@ PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
   } else {
     ptr = http_content_type_plain;
   }
-  SEND_STRING(&s->sout, ptr);
+  return ptr;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_script(struct httpd_state *s)
+{
+  char *ptr;
+
+  ptr = strrchr(s->filename, ISO_period);
+  return ptr != NULL && strncmp(ptr, http_shtml, 6) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+generate_headers(void *state)
+{
+  struct httpd_state *s = (struct httpd_state *)state;
+  const char *type;
+  int len, typelen;
+
+  len = strlen(s->statushdr);
+  type = content_type(s);
+  typelen = strlen(type);
+  memcpy(uip_appdata, s->statushdr, len);
+  memcpy((char *)uip_appdata + len, type, typelen);
+  len += typelen;
+
+  /* Fill the rest of the segment with the beginning of the file, so
+     that the client does not wait a round trip for the first byte.
+     Scripts are left to handle_script(). */
+  s->len = 0;
+  if(!is_script(s)) {
+    s->len = MIN(s->file.len, uip_mss() - len);
+    memcpy((char *)uip_appdata + len, s->file.data, s->len);
+  }
+
+  return len + s->len;
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(send_headers(struct httpd_state *s, const char *statushdr))
+{
+  PSOCK_BEGIN(&s->sout);
+
+  s->statushdr = statushdr;
+  if(strlen(statushdr) + strlen(content_type(s)) <= uip_mss()) {
+    /* The whole header fits in one segment together with as much of
+       the file as there is room for. */
+    PSOCK_GENERATOR_SEND(&s->sout, generate_headers, s);
+    s->file.len -= s->len;
+    s->file.data += s->len;
+  } else {
+    SEND_STRING(&s->sout, statushdr);
+    SEND_STRING(&s->sout, content_type(s));
+  }
+
   PSOCK_END(&s->sout);
 }
 /*---------------------------------------------------------------------------*/
 static
 PT_THREAD(handle_output(struct httpd_state *s))
 {
-  char *ptr;
-  
   PT_BEGIN(&s->outputpt);
  
   if(!httpd_fs_open(s->filename, &s->file)) {
@@ -233,8 +282,7 @@ PT_THREAD(handle_output(struct httpd_state *s))
     PT_WAIT_THREAD(&s->outputpt,
 		   send_headers(s,
 		   http_header_200));
-    ptr = strrchr(s->filename, ISO_period);
-    if(ptr != NULL && strncmp(ptr, http_shtml, 6) == 0) {
+    if(is_script(s)) {
       PT_INIT(&s->scriptpt);
       PT_WAIT_THREAD(&s->outputpt, handle_script(s));
     } else {
@@ -46,6 +46,7 @@ struct httpd_state {
   char filename[20];
   char state;
   struct httpd_fs_file file;  
+  const char *statushdr;
   int len;
   char *scriptptr;
   int scriptlen;
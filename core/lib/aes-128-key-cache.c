@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Bookkeeping of the expanded keys of the software AES-128
+ *         drivers.
+ */
+
+#include "lib/aes-128.h"
+#include <string.h>
+
+#if AES_128_KEY_CACHE_SIZE > 8
+#error AES_128_KEY_CACHE_SIZE must be at most 8
+#endif /* AES_128_KEY_CACHE_SIZE > 8 */
+
+uint32_t aes_128_key_expansions;
+
+/*---------------------------------------------------------------------------*/
+int
+aes_128_key_cache_find(struct aes_128_key_cache *cache, const uint8_t *key)
+{
+  uint8_t i;
+
+  for(i = 0; i < AES_128_KEY_CACHE_SIZE; i++) {
+    if((cache->valid & (1 << i))
+        && memcmp(cache->keys[i], key, AES_128_KEY_LENGTH) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+aes_128_key_cache_add(struct aes_128_key_cache *cache, const uint8_t *key)
+{
+  uint8_t slot;
+
+  /* Replace the slots in turn */
+  slot = cache->next;
+  cache->next = (slot + 1) % AES_128_KEY_CACHE_SIZE;
+  cache->valid |= 1 << slot;
+  memcpy(cache->keys[slot], key, AES_128_KEY_LENGTH);
+  aes_128_key_expansions++;
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
@@ -64,7 +64,9 @@ static const uint8_t sbox[256] =   {
 0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
 0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16 };
 
-static uint8_t round_keys[11][AES_128_KEY_LENGTH];
+static uint8_t cached_round_keys[AES_128_KEY_CACHE_SIZE][11][AES_128_KEY_LENGTH];
+static uint8_t (*round_keys)[AES_128_KEY_LENGTH] = cached_round_keys[0];
+static struct aes_128_key_cache key_cache;
 
 /*---------------------------------------------------------------------------*/
 /* multiplies by 2 in GF(2) */
@@ -81,6 +83,14 @@ set_key(const uint8_t *key)
   uint8_t i;
   uint8_t j;
   uint8_t rcon;
+  int slot;
+  
+  slot = aes_128_key_cache_find(&key_cache, key);
+  if(slot >= 0) {
+    round_keys = cached_round_keys[slot];
+    return;
+  }
+  round_keys = cached_round_keys[aes_128_key_cache_add(&key_cache, key)];
   
   rcon = 0x01;
   memcpy(round_keys[0], key, AES_128_KEY_LENGTH);
@@ -51,6 +51,18 @@
 #define AES_128            aes_128_driver
 #endif /* AES_128_CONF */
 
+/**
+ * Number of expanded keys each software driver keeps, so that
+ * switching between keys does not expand the key schedule each time.
+ * At most 8. Each entry costs 176 bytes of RAM, so only set it above 1
+ * where keys alternate, e.g. TSCH with security (K1 and K2).
+ */
+#ifdef AES_128_CONF_KEY_CACHE_SIZE
+#define AES_128_KEY_CACHE_SIZE AES_128_CONF_KEY_CACHE_SIZE
+#else /* AES_128_CONF_KEY_CACHE_SIZE */
+#define AES_128_KEY_CACHE_SIZE 1
+#endif /* AES_128_CONF_KEY_CACHE_SIZE */
+
 /**
  * Structure of AES drivers.
  */
@@ -67,6 +79,36 @@ struct aes_128_driver {
   void (* encrypt)(uint8_t *plaintext_and_result);
 };
 
+/**
+ * The keys whose schedules a software driver has expanded. A key is
+ * found by its contents, so that a key that changes under the same
+ * key index is expanded anew.
+ */
+struct aes_128_key_cache {
+  uint8_t keys[AES_128_KEY_CACHE_SIZE][AES_128_KEY_LENGTH];
+  uint8_t valid;
+  uint8_t next;
+};
+
+/**
+ * \brief Looks up an expanded key
+ * \return The slot of the key, or -1 if it is not in the cache
+ */
+int aes_128_key_cache_find(struct aes_128_key_cache *cache,
+                           const uint8_t *key);
+
+/**
+ * \brief Makes room for a key whose schedule is about to be expanded
+ * \return The slot in which to expand the key
+ */
+uint8_t aes_128_key_cache_add(struct aes_128_key_cache *cache,
+                              const uint8_t *key);
+
+/**
+ * Number of key schedules the software drivers have expanded.
+ */
+extern uint32_t aes_128_key_expansions;
+
 /**
  * \brief Pads the plaintext with zeroes before calling AES_128.encrypt
  */
@@ -79,4 +121,9 @@ void aes_128_set_padded_key(uint8_t *key, uint8_t key_len);
 
 extern const struct aes_128_driver AES_128;
 
+/* Byte-oriented software implementation */
+extern const struct aes_128_driver aes_128_driver;
+/* Software implementation on a 1 kB lookup table, see aes-128-table.c */
+extern const struct aes_128_driver aes_128_table_driver;
+
 #endif /* AES_H_ */
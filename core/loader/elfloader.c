@@ -123,6 +123,8 @@ struct elf32_sym {
 };
 
 #define ELF32_R_SYM(info)       ((info) >> 8)
+
+#define SYMBOL_NAME_LEN 30
 #define ELF32_R_TYPE(info)      ((unsigned char)(info))
 
 struct relevant_section {
@@ -137,6 +139,50 @@ struct process * const * elfloader_autostart_processes;
 
 static struct relevant_section bss, data, rodata, text;
 
+#if ELFLOADER_STATS
+struct elfloader_stats elfloader_stats;
+#define STATS_ADD(x) elfloader_stats.x++
+#else
+#define STATS_ADD(x)
+#endif
+
+/* Sequential reads of relocation entries and symbols are served from
+   this buffer instead of issuing one CFS read per entry. It holds
+   ELFLOADER_RELOCATION_BUFFER of the larger of the two records. */
+#define READ_RECORD_SIZE (sizeof(struct elf32_rela) > sizeof(struct elf32_sym) ? \
+                          sizeof(struct elf32_rela) : sizeof(struct elf32_sym))
+static char read_buf[ELFLOADER_RELOCATION_BUFFER * READ_RECORD_SIZE];
+static unsigned int read_buf_offset, read_buf_len;
+
+#if ELFLOADER_SYMBOL_CACHE_SIZE > 0
+#define HASH_BUCKETS 16
+#define NO_ENTRY     0xffff
+
+/* One entry per named symbol, chained in symbol table order so that
+   the first match wins, as with find_local_symbol(). */
+struct hash_entry {
+  char *addr;
+  uint32_t hash;
+  elf32_word st_name;
+  uint16_t next;
+};
+
+static uint16_t buckets[HASH_BUCKETS];
+static union {
+  char *align;
+  uint8_t bytes[ELFLOADER_SYMBOL_CACHE_SIZE];
+} cache_mem;
+static struct hash_entry *entries;
+static uint16_t num_entries;
+/* File offset of the first symbol that did not fit in the hash. */
+static unsigned int hashed_end;
+/* Resolved address per symbol index, or UNRESOLVED. */
+static char **resolved;
+static unsigned short num_resolved;
+static char unresolved_marker;
+#define UNRESOLVED (&unresolved_marker)
+#endif /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+
 static const unsigned char elf_magic_header[] =
   {0x7f, 0x45, 0x4c, 0x46,  /* 0x7f, 'E', 'L', 'F' */
    0x01,                    /* Only 32-bit objects. */
@@ -148,6 +194,7 @@ static const unsigned char elf_magic_header[] =
 static void
 seek_read(int fd, unsigned int offset, char *buf, int len)
 {
+  STATS_ADD(reads);
   cfs_seek(fd, offset, CFS_SEEK_SET);
   cfs_read(fd, buf, len);
 #if DEBUG
@@ -163,6 +210,48 @@ seek_read(int fd, unsigned int offset, char *buf, int len)
 #endif /* DEBUG */
 }
 /*---------------------------------------------------------------------------*/
+/* Return a pointer to len bytes at offset, refilling read_buf with as
+   much of the table ending at end as fits. */
+static const char *
+buffered_read(int fd, unsigned int offset, unsigned int end, int len)
+{
+  if(offset < read_buf_offset ||
+     offset + len > read_buf_offset + read_buf_len) {
+    read_buf_offset = offset;
+    read_buf_len = end - offset;
+    if(read_buf_len > sizeof(read_buf)) {
+      read_buf_len = sizeof(read_buf);
+    }
+    if(read_buf_len < len) {
+      /* Never more than one record, which always fits */
+      read_buf_len = len;
+    }
+    seek_read(fd, offset, read_buf, read_buf_len);
+  }
+  return &read_buf[offset - read_buf_offset];
+}
+/*---------------------------------------------------------------------------*/
+static void
+invalidate_read_buf(void)
+{
+  read_buf_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct relevant_section *
+find_section(elf32_half shndx)
+{
+  if(shndx == bss.number) {
+    return &bss;
+  } else if(shndx == data.number) {
+    return &data;
+  } else if(shndx == rodata.number) {
+    return &rodata;
+  } else if(shndx == text.number) {
+    return &text;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 /*
 static void
 seek_write(int fd, unsigned int offset, char *buf, int len)
@@ -188,15 +277,8 @@ find_local_symbol(int fd, const char *symbol,
     if(s.st_name != 0) {
       seek_read(fd, strtab + s.st_name, name, sizeof(name));
       if(strcmp(name, symbol) == 0) {
-	if(s.st_shndx == bss.number) {
-	  sect = &bss;
-	} else if(s.st_shndx == data.number) {
-	  sect = &data;
-  } else if(s.st_shndx == rodata.number) {
-    sect = &rodata;
-	} else if(s.st_shndx == text.number) {
-	  sect = &text;
-	} else {
+	sect = find_section(s.st_shndx);
+	if(sect == NULL) {
 	  return NULL;
 	}
 	return &(sect->address[s.st_value]);
@@ -206,6 +288,176 @@ find_local_symbol(int fd, const char *symbol,
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if ELFLOADER_SYMBOL_CACHE_SIZE > 0
+static uint32_t
+name_hash(const char *name)
+{
+  uint32_t h = 5381;
+  int i;
+
+  for(i = 0; i < SYMBOL_NAME_LEN && name[i] != 0; ++i) {
+    h = (h << 5) + h + (uint8_t)name[i];
+  }
+  return h;
+}
+#endif /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+/*---------------------------------------------------------------------------*/
+/* Set aside room for caching resolved addresses by symbol index, then
+   stream the symbol table once, hashing the name of every symbol until
+   the rest of the RAM budget runs out. */
+static void
+symbol_cache_init(int fd, unsigned int symtab, unsigned short symtabsize,
+		  unsigned int strtab)
+{
+#if ELFLOADER_SYMBOL_CACHE_SIZE > 0
+  struct elf32_sym s;
+  struct hash_entry *e;
+  struct relevant_section *sect;
+  char name[SYMBOL_NAME_LEN];
+  unsigned int a;
+  unsigned short i, nsyms;
+  uint16_t *link;
+  size_t used, room;
+
+  nsyms = symtabsize / sizeof(struct elf32_sym);
+  used = nsyms * sizeof(char *);
+  if(used <= sizeof(cache_mem)) {
+    resolved = (char **)cache_mem.bytes;
+    num_resolved = nsyms;
+    for(i = 0; i < nsyms; ++i) {
+      resolved[i] = UNRESOLVED;
+    }
+  } else {
+    used = 0;
+    num_resolved = 0;
+  }
+
+  for(i = 0; i < HASH_BUCKETS; ++i) {
+    buckets[i] = NO_ENTRY;
+  }
+  entries = (struct hash_entry *)&cache_mem.bytes[used];
+  room = (sizeof(cache_mem) - used) / sizeof(struct hash_entry);
+  num_entries = 0;
+  invalidate_read_buf();
+
+  for(a = symtab; a < symtab + symtabsize; a += sizeof(s)) {
+    memcpy(&s, buffered_read(fd, a, symtab + symtabsize, sizeof(s)),
+	   sizeof(s));
+    if(s.st_name == 0) {
+      continue;
+    }
+    if(num_entries >= room || num_entries == NO_ENTRY - 1) {
+      break;
+    }
+    seek_read(fd, strtab + s.st_name, name, sizeof(name));
+    e = &entries[num_entries];
+    e->hash = name_hash(name);
+    e->st_name = s.st_name;
+    sect = find_section(s.st_shndx);
+    e->addr = sect == NULL ? NULL : &sect->address[s.st_value];
+    e->next = NO_ENTRY;
+    for(link = &buckets[e->hash % HASH_BUCKETS];
+	*link != NO_ENTRY;
+	link = &entries[*link].next);
+    *link = num_entries++;
+  }
+  hashed_end = a;
+  PRINTF("elfloader: hashed %d symbols, %d spilled\n", num_entries,
+	 (symtab + symtabsize - hashed_end) / sizeof(s));
+#endif /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+}
+/*---------------------------------------------------------------------------*/
+static void *
+lookup_local_symbol(int fd, const char *symbol,
+		    unsigned int symtab, unsigned short symtabsize,
+		    unsigned int strtab)
+{
+#if ELFLOADER_SYMBOL_CACHE_SIZE > 0
+  char name[SYMBOL_NAME_LEN];
+  uint32_t h;
+  uint16_t i;
+
+  h = name_hash(symbol);
+  for(i = buckets[h % HASH_BUCKETS]; i != NO_ENTRY; i = entries[i].next) {
+    if(entries[i].hash == h) {
+      seek_read(fd, strtab + entries[i].st_name, name, sizeof(name));
+      if(strncmp(name, symbol, sizeof(name)) == 0) {
+	return entries[i].addr;
+      }
+    }
+  }
+  if(hashed_end >= symtab + symtabsize) {
+    return NULL;
+  }
+  /* Fall back to scanning the part of the symbol table that did not
+     fit in RAM. */
+  STATS_ADD(spilled_lookups);
+  return find_local_symbol(fd, symbol, hashed_end,
+			   symtab + symtabsize - hashed_end, strtab);
+#else /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+  STATS_ADD(spilled_lookups);
+  return find_local_symbol(fd, symbol, symtab, symtabsize, strtab);
+#endif /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+}
+/*---------------------------------------------------------------------------*/
+static int
+resolve_symbol(int fd, unsigned int symbol,
+	       unsigned int strtab,
+	       unsigned int symtab, unsigned short symtabsize,
+	       char **addrp)
+{
+  struct elf32_sym s;
+  char name[SYMBOL_NAME_LEN];
+  char *addr;
+  struct relevant_section *sect;
+
+#if ELFLOADER_SYMBOL_CACHE_SIZE > 0
+  if(symbol < num_resolved && resolved[symbol] != UNRESOLVED) {
+    STATS_ADD(cache_hits);
+    *addrp = resolved[symbol];
+    return ELFLOADER_OK;
+  }
+#endif /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+
+  seek_read(fd, symtab + sizeof(struct elf32_sym) * symbol,
+	    (char *)&s, sizeof(s));
+  if(s.st_name != 0) {
+    seek_read(fd, strtab + s.st_name, name, sizeof(name));
+    PRINTF("name: %s\n", name);
+    addr = (char *)symtab_lookup(name);
+    /* ADDED */
+    if(addr == NULL) {
+      PRINTF("name not found in global: %s\n", name);
+      addr = lookup_local_symbol(fd, name, symtab, symtabsize, strtab);
+      PRINTF("found address %p\n", addr);
+    }
+    if(addr == NULL) {
+      sect = find_section(s.st_shndx);
+      if(sect == NULL) {
+	PRINTF("elfloader unknown name: '%30s'\n", name);
+	memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
+	elfloader_unknown[sizeof(elfloader_unknown) - 1] = 0;
+	return ELFLOADER_SYMBOL_NOT_FOUND;
+      }
+      addr = sect->address;
+    }
+  } else {
+    sect = find_section(s.st_shndx);
+    if(sect == NULL) {
+      return ELFLOADER_SEGMENT_NOT_FOUND;
+    }
+    addr = sect->address;
+  }
+
+#if ELFLOADER_SYMBOL_CACHE_SIZE > 0
+  if(symbol < num_resolved) {
+    resolved[symbol] = addr;
+  }
+#endif /* ELFLOADER_SYMBOL_CACHE_SIZE > 0 */
+  *addrp = addr;
+  return ELFLOADER_OK;
+}
+/*---------------------------------------------------------------------------*/
 static int
 relocate_section(int fd,
 		 unsigned int section, unsigned short size,
@@ -219,11 +471,9 @@ relocate_section(int fd,
   /* sectionbase added; runtime start address of current section */
   struct elf32_rela rela; /* Now used both for rel and rela data! */
   int rel_size = 0;
-  struct elf32_sym s;
   unsigned int a;
-  char name[30];
   char *addr;
-  struct relevant_section *sect;
+  int ret;
 
   /* determine correct relocation entry sizes */
   if(using_relas) {
@@ -231,53 +481,14 @@ relocate_section(int fd,
   } else {
     rel_size = sizeof(struct elf32_rel);
   }
-  
+
+  invalidate_read_buf();
   for(a = section; a < section + size; a += rel_size) {
-    seek_read(fd, a, (char *)&rela, rel_size);
-    seek_read(fd,
-	      symtab + sizeof(struct elf32_sym) * ELF32_R_SYM(rela.r_info),
-	      (char *)&s, sizeof(s));
-    if(s.st_name != 0) {
-      seek_read(fd, strtab + s.st_name, name, sizeof(name));
-      PRINTF("name: %s\n", name);
-      addr = (char *)symtab_lookup(name);
-      /* ADDED */
-      if(addr == NULL) {
-	PRINTF("name not found in global: %s\n", name);
-	addr = find_local_symbol(fd, name, symtab, symtabsize, strtab);
-	PRINTF("found address %p\n", addr);
-      }
-      if(addr == NULL) {
-	if(s.st_shndx == bss.number) {
-	  sect = &bss;
-	} else if(s.st_shndx == data.number) {
-	  sect = &data;
-	} else if(s.st_shndx == rodata.number) {
-	  sect = &rodata;
-	} else if(s.st_shndx == text.number) {
-	  sect = &text;
-	} else {
-	  PRINTF("elfloader unknown name: '%30s'\n", name);
-	  memcpy(elfloader_unknown, name, sizeof(elfloader_unknown));
-	  elfloader_unknown[sizeof(elfloader_unknown) - 1] = 0;
-	  return ELFLOADER_SYMBOL_NOT_FOUND;
-	}
-	addr = sect->address;
-      }
-    } else {
-      if(s.st_shndx == bss.number) {
-	sect = &bss;
-      } else if(s.st_shndx == data.number) {
-	sect = &data;
-      } else if(s.st_shndx == rodata.number) {
-	sect = &rodata;
-      } else if(s.st_shndx == text.number) {
-	sect = &text;
-      } else {
-	return ELFLOADER_SEGMENT_NOT_FOUND;
-      }
-      
-      addr = sect->address;
+    memcpy(&rela, buffered_read(fd, a, section + size, rel_size), rel_size);
+    ret = resolve_symbol(fd, ELF32_R_SYM(rela.r_info),
+			 strtab, symtab, symtabsize, &addr);
+    if(ret != ELFLOADER_OK) {
+      return ret;
     }
 
     if(!using_relas) {
@@ -285,6 +496,7 @@ relocate_section(int fd,
       seek_read(fd, sectionaddr + rela.r_offset, (char *)&rela.r_addend, 4);
     }
 
+    STATS_ADD(relocations);
     elfloader_arch_relocate(fd, sectionaddr, sectionbase, &rela, addr);
   }
   return ELFLOADER_OK;
@@ -335,8 +547,8 @@ print_chars(unsigned char *ptr, int num)
 }
 #endif /* 0 */
 /*---------------------------------------------------------------------------*/
-int
-elfloader_load(int fd)
+static int
+load(int fd)
 {
   struct elf32_ehdr ehdr;
   struct elf32_shdr shdr;
@@ -517,6 +729,8 @@ elfloader_load(int fd)
   PRINTF("text base address: text.address = 0x%08x\n", text.address);
   PRINTF("rodata base address: rodata.address = 0x%08x\n", rodata.address);
 
+  symbol_cache_init(fd, symtaboff, symtabsize, strtaboff);
+
 
   /* If we have text segment relocations, we process them. */
   PRINTF("elfloader: relocate text\n");
@@ -573,7 +787,7 @@ elfloader_load(int fd)
   seek_read(fd, dataoff, data.address, datasize);
 
   PRINTF("elfloader: autostart search\n");
-  process = (struct process **) find_local_symbol(fd, "autostart_processes", symtaboff, symtabsize, strtaboff);
+  process = (struct process **) lookup_local_symbol(fd, "autostart_processes", symtaboff, symtabsize, strtaboff);
   if(process != NULL) {
     PRINTF("elfloader: autostart found\n");
     elfloader_autostart_processes = process;
@@ -588,3 +802,24 @@ elfloader_load(int fd)
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+elfloader_load(int fd)
+{
+#if ELFLOADER_STATS
+  clock_time_t start;
+  int ret;
+
+  memset(&elfloader_stats, 0, sizeof(elfloader_stats));
+  elfloader_stats.module_size = cfs_seek(fd, 0, CFS_SEEK_END);
+  start = clock_time();
+  ret = load(fd);
+  elfloader_stats.load_time = clock_time() - start;
+  PRINTF("elfloader: %lu bytes loaded in %lu ticks, %lu reads\n",
+	 elfloader_stats.module_size, elfloader_stats.load_time,
+	 elfloader_stats.reads);
+  return ret;
+#else /* ELFLOADER_STATS */
+  return load(fd);
+#endif /* ELFLOADER_STATS */
+}
+/*---------------------------------------------------------------------------*/
@@ -175,6 +175,60 @@ extern char elfloader_unknown[30];
 #endif
 #endif /* ELFLOADER_TEXTMEMORY_SIZE */
 
+/**
+ * RAM budget, in bytes, of the temporary symbol cache used while
+ * relocating a module. The symbol and string tables are streamed once
+ * into a name hash and resolved symbol addresses are remembered per
+ * symbol index. Symbols that do not fit are looked up in the file as
+ * before. The memory is static, so it stays allocated between loads;
+ * the cache is off (0) by default. Platforms that load large modules
+ * and have RAM to spare can set it to a few hundred bytes.
+ */
+#ifdef ELFLOADER_CONF_SYMBOL_CACHE_SIZE
+#define ELFLOADER_SYMBOL_CACHE_SIZE ELFLOADER_CONF_SYMBOL_CACHE_SIZE
+#else
+#define ELFLOADER_SYMBOL_CACHE_SIZE 0
+#endif
+
+/**
+ * Number of relocation entries or symbols read from the file at a
+ * time. The static buffer takes 16 bytes per entry, so the default
+ * reads one entry at a time, as the loader always did.
+ */
+#ifdef ELFLOADER_CONF_RELOCATION_BUFFER
+#define ELFLOADER_RELOCATION_BUFFER ELFLOADER_CONF_RELOCATION_BUFFER
+#else
+#define ELFLOADER_RELOCATION_BUFFER 1
+#endif
+
+#ifdef ELFLOADER_CONF_STATS
+#define ELFLOADER_STATS ELFLOADER_CONF_STATS
+#else
+#define ELFLOADER_STATS 0
+#endif
+
+#if ELFLOADER_STATS
+/**
+ * Counters describing the last call to elfloader_load().
+ */
+struct elfloader_stats {
+  /** Size of the ELF file, in bytes. */
+  unsigned long module_size;
+  /** Time spent in elfloader_load(), in clock ticks. */
+  unsigned long load_time;
+  /** Number of file reads issued by the loader. */
+  unsigned long reads;
+  /** Number of relocations applied. */
+  unsigned long relocations;
+  /** Relocations whose symbol address was already cached. */
+  unsigned long cache_hits;
+  /** Local symbol lookups that had to scan the file. */
+  unsigned long spilled_lookups;
+};
+
+extern struct elfloader_stats elfloader_stats;
+#endif /* ELFLOADER_STATS */
+
 typedef unsigned long  elf32_word;
 typedef   signed long  elf32_sword;
 typedef unsigned short elf32_half;
@@ -158,6 +158,34 @@ strcasecmp(const char *s1, const char *s2)
 #define RESOLV_SUPPORTS_RECORD_EXPIRATION 1
 #endif
 
+/* How long to keep a "not found" answer without an SOA record */
+#ifdef RESOLV_CONF_NEGATIVE_TTL
+#define RESOLV_NEGATIVE_TTL RESOLV_CONF_NEGATIVE_TTL
+#else
+#define RESOLV_NEGATIVE_TTL 30
+#endif
+
+/* The longest that a "not found" answer is kept, as in RFC 2308 */
+#define RESOLV_MAX_NEGATIVE_TTL 10800
+
+/* Refresh names that are looked up within this many seconds before
+   they expire, so that they do not go through RESOLV_STATUS_EXPIRED */
+#ifdef RESOLV_CONF_PREFETCH
+#define RESOLV_PREFETCH RESOLV_CONF_PREFETCH
+#else
+#define RESOLV_PREFETCH 0
+#endif
+
+#if RESOLV_PREFETCH && !RESOLV_SUPPORTS_RECORD_EXPIRATION
+#error RESOLV_CONF_PREFETCH needs RESOLV_CONF_SUPPORTS_RECORD_EXPIRATION
+#endif
+
+#if RESOLV_CONF_STATS
+#define RESOLV_STAT(code) (code)
+#else
+#define RESOLV_STAT(code)
+#endif
+
 #if RESOLV_CONF_SUPPORTS_MDNS && !RESOLV_VERIFY_ANSWER_NAMES
 #error RESOLV_CONF_SUPPORTS_MDNS cannot be set without RESOLV_CONF_VERIFY_ANSWER_NAMES
 #endif
@@ -178,6 +206,7 @@ strcasecmp(const char *s1, const char *s2)
 
 #define DNS_TYPE_A      1
 #define DNS_TYPE_CNAME  5
+#define DNS_TYPE_SOA    6
 #define DNS_TYPE_PTR   12
 #define DNS_TYPE_MX    15
 #define DNS_TYPE_TXT   16
@@ -250,6 +279,7 @@ struct namemap {
 #define STATE_ASKING 3
 #define STATE_DONE   4
   uint8_t state;
+  uint8_t hash;
   uint8_t tmr;
   uint16_t id;
   uint8_t retries;
@@ -263,6 +293,10 @@ struct namemap {
 #if RESOLV_CONF_SUPPORTS_MDNS
   int is_mdns:1, is_probe:1;
 #endif
+#if RESOLV_PREFETCH
+  /* Being asked for again, while the address is still valid */
+  uint8_t prefetching;
+#endif /* RESOLV_PREFETCH */
   char name[RESOLV_CONF_MAX_DOMAIN_NAME_SIZE + 1];
 };
 
@@ -282,6 +316,10 @@ static struct etimer retry;
 
 process_event_t resolv_event_found;
 
+#if RESOLV_CONF_STATS
+struct resolv_stats resolv_stats;
+#endif /* RESOLV_CONF_STATS */
+
 PROCESS(resolv_process, "DNS resolver");
 
 static void resolv_found(char *name, uip_ipaddr_t * ipaddr);
@@ -472,6 +510,146 @@ encode_name(unsigned char *query, const char *nameptr)
   return query;
 }
 /*---------------------------------------------------------------------------*/
+/** \internal
+ * A hash of a name that is the same in any case, checked before
+ * comparing names.
+ */
+static uint8_t
+name_hash(const char *name)
+{
+  uint8_t hash = 0;
+
+  while(*name != 0) {
+    /* Only letters differ in bit 5 between cases in host names */
+    hash = (hash << 3) + (hash >> 5) + (*name++ | 0x20);
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ */
+static struct namemap *
+find_name(const char *name)
+{
+  struct namemap *nameptr;
+  uint8_t hash;
+
+  hash = name_hash(name);
+  for(nameptr = names; nameptr < &names[RESOLV_ENTRIES]; ++nameptr) {
+    if(nameptr->state != STATE_UNUSED && nameptr->hash == hash &&
+       strcasecmp(nameptr->name, name) == 0) {
+      return nameptr;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Finds the entry to reuse for a new name: an unused one, else the
+ * answer that expires first, else the oldest question.
+ */
+static struct namemap *
+evict_name(void)
+{
+  struct namemap *nameptr, *oldest, *soonest;
+
+  oldest = soonest = NULL;
+  for(nameptr = names; nameptr < &names[RESOLV_ENTRIES]; ++nameptr) {
+    if(nameptr->state == STATE_UNUSED) {
+      return nameptr;
+    }
+    if(oldest == NULL ||
+       (uint8_t)(seqno - nameptr->seqno) > (uint8_t)(seqno - oldest->seqno)) {
+      oldest = nameptr;
+    }
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+    if((nameptr->state == STATE_DONE || nameptr->state == STATE_ERROR) &&
+       (soonest == NULL || nameptr->expiration < soonest->expiration)) {
+      soonest = nameptr;
+    }
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+  }
+  return soonest != NULL ? soonest : oldest;
+}
+/*---------------------------------------------------------------------------*/
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+/** \internal
+ */
+static uint32_t
+get32(const unsigned char *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+    ((uint16_t)p[2] << 8) | p[3];
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Skips the name and fixed fields of a record, or returns NULL if
+ * they do not fit before \a end.
+ */
+static unsigned char *
+skip_record_header(unsigned char *queryptr, const unsigned char *end)
+{
+  while(queryptr < end && *queryptr != 0 && !(*queryptr & 0xc0)) {
+    queryptr += *queryptr + 1;
+  }
+  if(queryptr >= end) {
+    return NULL;
+  }
+  queryptr += (*queryptr & 0xc0) ? 2 : 1;
+  if(end - queryptr < 10) {
+    return NULL;
+  }
+  return queryptr;
+}
+/*---------------------------------------------------------------------------*/
+/** \internal
+ * Finds how long to keep a "not found" answer: the smaller of the TTL
+ * and the minimum field of an SOA record in the authority section.
+ * Records that would cross \a end are not read.
+ */
+static uint32_t
+negative_ttl(unsigned char *queryptr, const unsigned char *end,
+             uint8_t nanswers, uint8_t nauthrr)
+{
+  uint16_t type, len;
+  uint32_t ttl;
+
+  /* The answers, if any, are for a CNAME */
+  for(; nanswers > 0; --nanswers) {
+    queryptr = skip_record_header(queryptr, end);
+    if(queryptr == NULL) {
+      return RESOLV_NEGATIVE_TTL;
+    }
+    len = (queryptr[8] << 8) | queryptr[9];
+    if(end - queryptr < 10 + len) {
+      return RESOLV_NEGATIVE_TTL;
+    }
+    queryptr += 10 + len;
+  }
+
+  for(; nauthrr > 0; --nauthrr) {
+    queryptr = skip_record_header(queryptr, end);
+    if(queryptr == NULL) {
+      return RESOLV_NEGATIVE_TTL;
+    }
+    type = (queryptr[0] << 8) | queryptr[1];
+    len = (queryptr[8] << 8) | queryptr[9];
+    if(end - queryptr < 10 + len) {
+      return RESOLV_NEGATIVE_TTL;
+    }
+    if(type == DNS_TYPE_SOA && len >= 22) {
+      ttl = get32(queryptr + 4);
+      if(get32(queryptr + 10 + len - 4) < ttl) {
+        ttl = get32(queryptr + 10 + len - 4);
+      }
+      return ttl < RESOLV_MAX_NEGATIVE_TTL ? ttl : RESOLV_MAX_NEGATIVE_TTL;
+    }
+    queryptr += 10 + len;
+  }
+  return RESOLV_NEGATIVE_TTL;
+}
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+/*---------------------------------------------------------------------------*/
 #if RESOLV_CONF_SUPPORTS_MDNS
 /** \internal
  */
@@ -675,12 +853,21 @@ check_entries(void)
             /* Try the next server (if possible) before failing. Otherwise
                simply mark the entry as failed. */
             if(try_next_server(namemapptr) == 0) {
+#if RESOLV_PREFETCH
+              if(namemapptr->prefetching) {
+                /* Keep the address until it expires */
+                namemapptr->prefetching = 0;
+                namemapptr->state = STATE_DONE;
+                continue;
+              }
+#endif /* RESOLV_PREFETCH */
+
               /* STATE_ERROR basically means "not found". */
               namemapptr->state = STATE_ERROR;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-              /* Keep the "not found" error valid for 30 seconds */
-              namemapptr->expiration = clock_seconds() + 30;
+              /* Keep the "not found" error valid for a while */
+              namemapptr->expiration = clock_seconds() + RESOLV_NEGATIVE_TTL;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
               resolv_found(namemapptr->name, NULL);
@@ -772,6 +959,7 @@ check_entries(void)
       PRINTF("resolver: (i=%d) Sent DNS request for \"%s\".\n", i,
              namemapptr->name);
 #endif /* RESOLV_CONF_SUPPORTS_MDNS */
+      RESOLV_STAT(resolv_stats.sent++);
       break;
     }
   }
@@ -895,8 +1083,13 @@ newdata(void)
 
 /** ANSWER HANDLING SECTION **************************************************/
 
-  if(nanswers == 0) {
-    /* Skip responses with no answers. */
+  if(nanswers == 0 && (is_request
+#if RESOLV_CONF_SUPPORTS_MDNS
+     || UIP_UDP_BUF->srcport == UIP_HTONS(MDNS_PORT)
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+    )) {
+    /* Skip responses with no answers, except to our DNS questions,
+       which then say that the name has no address. */
     return;
   }
 
@@ -933,13 +1126,24 @@ newdata(void)
     namemapptr->err = hdr->flags2 & DNS_FLAG2_ERR_MASK;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-    /* If we remain in the error state, keep it cached for 30 seconds. */
-    namemapptr->expiration = clock_seconds() + 30;
+    /* If we remain in the error state, keep it cached for a while. */
+    namemapptr->expiration = clock_seconds() + RESOLV_NEGATIVE_TTL;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
-    /* Check for error. If so, call callback to inform. */
-    if(namemapptr->err != 0) {
+    /* Check for error, or no answer. If so, call callback to inform. */
+    if(namemapptr->err != 0 || nanswers == 0) {
       namemapptr->state = STATE_ERROR;
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+      if(namemapptr->err == DNS_FLAG2_ERR_NAME || namemapptr->err == 0) {
+        /* The name, or its address, does not exist */
+        namemapptr->expiration = clock_seconds() +
+          negative_ttl(queryptr, (unsigned char *)uip_appdata + uip_datalen(),
+                       nanswers, (uint8_t)uip_ntohs(hdr->numauthrr));
+      }
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+#if RESOLV_PREFETCH
+      namemapptr->prefetching = 0;
+#endif /* RESOLV_PREFETCH */
       resolv_found(namemapptr->name, NULL);
       return;
     }
@@ -1013,6 +1217,7 @@ newdata(void)
           namemapptr = NULL;
           goto skip_to_next_answer;
         }
+        namemapptr->hash = name_hash(namemapptr->name);
       }
       if(i == RESOLV_ENTRIES) {
         DEBUG_PRINTF
@@ -1047,9 +1252,13 @@ newdata(void)
 
     namemapptr->state = STATE_DONE;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-    namemapptr->expiration = ans->ttl[1] + (ans->ttl[0] << 8);
+    namemapptr->expiration = ((uint32_t)uip_ntohs(ans->ttl[0]) << 16) |
+      uip_ntohs(ans->ttl[1]);
     namemapptr->expiration += clock_seconds();
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+#if RESOLV_PREFETCH
+    namemapptr->prefetching = 0;
+#endif /* RESOLV_PREFETCH */
 
     uip_ipaddr_copy(&namemapptr->ipaddr, (uip_ipaddr_t *) ans->ipaddr);
 
@@ -1258,48 +1467,68 @@ remove_trailing_dots(const char *name) {
 #define remove_trailing_dots(x) (x)
 #endif /* RESOLV_AUTO_REMOVE_TRAILING_DOTS */
 /*---------------------------------------------------------------------------*/
+#if RESOLV_PREFETCH
+/** \internal
+ * Asks for a name again while its address can still be used.
+ */
+static void
+prefetch_name(struct namemap *nameptr)
+{
+  PRINTF("resolver: Refreshing \"%s\".\n", nameptr->name);
+
+  nameptr->prefetching = 1;
+  nameptr->state = STATE_NEW;
+  nameptr->server = 0;
+  RESOLV_STAT(resolv_stats.prefetches++);
+
+  process_post(&resolv_process, PROCESS_EVENT_TIMER, 0);
+}
+#endif /* RESOLV_PREFETCH */
+/*---------------------------------------------------------------------------*/
 /**
  * Queues a name so that a question for the name will be sent out.
  *
+ * A name that is already being asked for is not asked for again, and
+ * one with a valid answer in the cache, including "not found", is
+ * answered from there. Either way, resolv_event_found is posted when
+ * the name is resolved.
+ *
  * \param name The hostname that is to be queried.
  */
 void
 resolv_query(const char *name)
 {
-  static uint8_t i;
-
-  static uint8_t lseq, lseqi;
-
-  register struct namemap *nameptr = 0;
+  register struct namemap *nameptr;
 
   init();
-  
-  lseq = lseqi = 0;
 
   /* Remove trailing dots, if present. */
   name = remove_trailing_dots(name);
 
-  for(i = 0; i < RESOLV_ENTRIES; ++i) {
-    nameptr = &names[i];
-    if(0 == strcasecmp(nameptr->name, name)) {
-      break;
+  RESOLV_STAT(resolv_stats.queries++);
+
+  nameptr = find_name(name);
+  if(nameptr != NULL) {
+    if(nameptr->state == STATE_NEW || nameptr->state == STATE_ASKING) {
+      /* Wait for the answer to the question already asked */
+      RESOLV_STAT(resolv_stats.coalesced++);
+      return;
     }
-    if((nameptr->state == STATE_UNUSED)
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-      || (nameptr->state == STATE_DONE && clock_seconds() > nameptr->expiration)
-#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
-    ) {
-      lseqi = i;
-      lseq = 255;
-    } else if(seqno - nameptr->seqno > lseq) {
-      lseq = seqno - nameptr->seqno;
-      lseqi = i;
+    if(clock_seconds() <= nameptr->expiration
+#if RESOLV_CONF_SUPPORTS_MDNS
+       && strcasecmp(name, resolv_hostname) != 0
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+      ) {
+      /* Still valid, including "not found" */
+      RESOLV_STAT(resolv_stats.cache_answers++);
+      resolv_found(nameptr->name,
+                   nameptr->state == STATE_DONE ? &nameptr->ipaddr : NULL);
+      return;
     }
-  }
-
-  if(i == RESOLV_ENTRIES) {
-    i = lseqi;
-    nameptr = &names[i];
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+  } else {
+    nameptr = evict_name();
   }
 
   PRINTF("resolver: Starting query for \"%s\".\n", name);
@@ -1307,6 +1536,7 @@ resolv_query(const char *name)
   memset(nameptr, 0, sizeof(*nameptr));
 
   strncpy(nameptr->name, name, sizeof(nameptr->name));
+  nameptr->hash = name_hash(nameptr->name);
   nameptr->state = STATE_NEW;
   nameptr->seqno = seqno;
   ++seqno;
@@ -1347,10 +1577,10 @@ resolv_lookup(const char *name, uip_ipaddr_t ** ipaddr)
 {
   resolv_status_t ret = RESOLV_STATUS_UNCACHED;
 
-  static uint8_t i;
-
   struct namemap *nameptr;
 
+  RESOLV_STAT(resolv_stats.lookups++);
+
   /* Remove trailing dots, if present. */
   name = remove_trailing_dots(name);
 
@@ -1370,43 +1600,58 @@ resolv_lookup(const char *name, uip_ipaddr_t ** ipaddr)
   }
 #endif /* UIP_CONF_LOOPBACK_INTERFACE */
 
-  /* Walk through the list to see if the name is in there. */
-  for(i = 0; i < RESOLV_ENTRIES; ++i) {
-    nameptr = &names[i];
-
-    if(strcasecmp(name, nameptr->name) == 0) {
-      switch (nameptr->state) {
-      case STATE_DONE:
-        ret = RESOLV_STATUS_CACHED;
-#if RESOLV_SUPPORTS_RECORD_EXPIRATION
-        if(clock_seconds() > nameptr->expiration) {
-          ret = RESOLV_STATUS_EXPIRED;
-        }
-#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
-        break;
-      case STATE_NEW:
-      case STATE_ASKING:
-        ret = RESOLV_STATUS_RESOLVING;
-        break;
-      /* Almost certainly a not-found error from server */
-      case STATE_ERROR:
-        ret = RESOLV_STATUS_NOT_FOUND;
+  nameptr = find_name(name);
+  if(nameptr != NULL) {
+    switch (nameptr->state) {
+    case STATE_DONE:
+      ret = RESOLV_STATUS_CACHED;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-        if(clock_seconds() > nameptr->expiration) {
-          ret = RESOLV_STATUS_UNCACHED;
-        }
+      if(clock_seconds() > nameptr->expiration) {
+        ret = RESOLV_STATUS_EXPIRED;
+      }
+#if RESOLV_PREFETCH
+      else if(nameptr->expiration - clock_seconds() < RESOLV_PREFETCH
+#if RESOLV_CONF_SUPPORTS_MDNS
+              && !nameptr->is_mdns
+#endif /* RESOLV_CONF_SUPPORTS_MDNS */
+             ) {
+        prefetch_name(nameptr);
+      }
+#endif /* RESOLV_PREFETCH */
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
-        break;
+      break;
+    case STATE_NEW:
+    case STATE_ASKING:
+      ret = RESOLV_STATUS_RESOLVING;
+#if RESOLV_PREFETCH
+      if(nameptr->prefetching && clock_seconds() <= nameptr->expiration) {
+        ret = RESOLV_STATUS_CACHED;
       }
-
-      if(ipaddr) {
-        *ipaddr = &nameptr->ipaddr;
+#endif /* RESOLV_PREFETCH */
+      break;
+    /* Almost certainly a not-found error from server */
+    case STATE_ERROR:
+      ret = RESOLV_STATUS_NOT_FOUND;
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+      if(clock_seconds() > nameptr->expiration) {
+        ret = RESOLV_STATUS_UNCACHED;
       }
-
-      /* Break out of for loop. */
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
       break;
     }
+
+    if(ipaddr) {
+      *ipaddr = &nameptr->ipaddr;
+    }
+  }
+
+#if RESOLV_CONF_STATS
+  if(ret == RESOLV_STATUS_CACHED) {
+    resolv_stats.hits++;
+  } else if(ret == RESOLV_STATUS_NOT_FOUND) {
+    resolv_stats.negative_hits++;
   }
+#endif /* RESOLV_CONF_STATS */
 
 #if VERBOSE_DEBUG
   switch (ret) {
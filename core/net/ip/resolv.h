@@ -52,6 +52,36 @@
 #define RESOLV_CONF_SUPPORTS_MDNS     (1)
 #endif
 
+/** If RESOLV_CONF_STATS is set, resolv_stats counts how names are
+ *  looked up and asked for.
+ */
+#ifndef RESOLV_CONF_STATS
+#define RESOLV_CONF_STATS             0
+#endif
+
+#if RESOLV_CONF_STATS
+struct resolv_stats {
+  /** Calls to resolv_lookup() */
+  uint16_t lookups;
+  /** Lookups that returned RESOLV_STATUS_CACHED */
+  uint16_t hits;
+  /** Lookups that returned RESOLV_STATUS_NOT_FOUND */
+  uint16_t negative_hits;
+  /** Calls to resolv_query() */
+  uint16_t queries;
+  /** Queries for a name that was already being asked for */
+  uint16_t coalesced;
+  /** Queries answered from the cache */
+  uint16_t cache_answers;
+  /** Names asked for again before they expired */
+  uint16_t prefetches;
+  /** Questions sent, including retries */
+  uint16_t sent;
+};
+
+extern struct resolv_stats resolv_stats;
+#endif /* RESOLV_CONF_STATS */
+
 /**
  * Event that is broadcasted when a DNS name has been resolved.
  */
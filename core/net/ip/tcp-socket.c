@@ -55,11 +55,88 @@ call_event(struct tcp_socket *s, tcp_socket_event_t event)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_TCP_WINDOWED
+static void
+senddata_windowed(struct tcp_socket *s)
+{
+  int len;
+
+  /* On a timeout, the oldest segment in flight goes out again */
+  if(uip_rexmit()) {
+    if(s->output_segs > 0) {
+      uip_send(s->output_data_ptr, s->output_seg_len[0]);
+    }
+    return;
+  }
+
+  if(s->output_segs == TCP_SOCKET_MAX_SEGMENTS) {
+    return;
+  }
+
+  len = MIN(s->output_data_max_seg, uip_mss());
+  len = MIN(s->output_data_len - s->output_data_send_nxt, len);
+  if(len > 0) {
+    uip_send(&s->output_data_ptr[s->output_data_send_nxt], len);
+    s->output_seg_len[s->output_segs++] = len;
+    s->output_data_send_nxt += len;
+
+    /* uIP sends one segment per call, so ask for another one if there
+       is more to send */
+    if(s->output_data_send_nxt < s->output_data_len &&
+       s->output_segs < TCP_SOCKET_MAX_SEGMENTS) {
+      tcpip_poll_tcp(uip_conn);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+acked_windowed(struct tcp_socket *s)
+{
+  uint16_t acked;
+  uint16_t seglen;
+
+  /* What is no longer outstanding in uIP has been acknowledged */
+  acked = s->output_data_send_nxt - uip_outstanding(uip_conn);
+  if(acked == 0 || acked > s->output_data_len) {
+    return;
+  }
+
+  while(s->output_segs > 0 && s->output_seg_len[0] <= acked) {
+    seglen = s->output_seg_len[0];
+    memmove(&s->output_seg_len[0], &s->output_seg_len[1],
+            --s->output_segs * sizeof(s->output_seg_len[0]));
+    acked -= seglen;
+    s->output_data_send_nxt -= seglen;
+    s->output_data_len -= seglen;
+    memmove(&s->output_data_ptr[0], &s->output_data_ptr[seglen],
+            s->output_data_len);
+  }
+  if(acked > 0 && s->output_segs > 0) {
+    /* The receiver acknowledged part of a segment */
+    s->output_seg_len[0] -= acked;
+    s->output_data_send_nxt -= acked;
+    s->output_data_len -= acked;
+    memmove(&s->output_data_ptr[0], &s->output_data_ptr[acked],
+            s->output_data_len);
+  }
+  s->output_senddata_len = s->output_data_len;
+
+  call_event(s, TCP_SOCKET_DATA_SENT);
+}
+#endif /* UIP_TCP_WINDOWED */
+/*---------------------------------------------------------------------------*/
 static void
 senddata(struct tcp_socket *s)
 {
   int len = MIN(s->output_data_max_seg, uip_mss());
 
+#if UIP_TCP_WINDOWED
+  if(s->flags & TCP_SOCKET_FLAGS_WINDOWED) {
+    senddata_windowed(s);
+    return;
+  }
+#endif /* UIP_TCP_WINDOWED */
+
   if(s->output_senddata_len > 0) {
     len = MIN(s->output_senddata_len, len);
     s->output_data_send_nxt = len;
@@ -70,6 +147,13 @@ senddata(struct tcp_socket *s)
 static void
 acked(struct tcp_socket *s)
 {
+#if UIP_TCP_WINDOWED
+  if(s->flags & TCP_SOCKET_FLAGS_WINDOWED) {
+    acked_windowed(s);
+    return;
+  }
+#endif /* UIP_TCP_WINDOWED */
+
   if(s->output_senddata_len > 0) {
     /* Copy the data in the outputbuf down and update outputbufptr and
        outputbuf_lastsent */
@@ -105,6 +189,14 @@ newdata(struct tcp_socket *s)
   len = uip_datalen();
   dataptr = uip_appdata;
 
+  /* Without an input buffer, the callback reads straight from uIP */
+  if(s->input_data_ptr == NULL) {
+    if(s->input_callback) {
+      s->input_callback(s, s->ptr, dataptr, len);
+    }
+    return;
+  }
+
   /* We have a segment with data coming in. We copy as much data as
      possible into the input buffer and call the input callback
      function. The input callback returns the number of bytes that
@@ -138,6 +230,19 @@ relisten(struct tcp_socket *s)
 }
 /*---------------------------------------------------------------------------*/
 static void
+connected(struct tcp_socket *s)
+{
+  s->c = uip_conn;
+  s->output_data_send_nxt = 0;
+#if UIP_TCP_WINDOWED
+  s->output_segs = 0;
+  if(s->flags & TCP_SOCKET_FLAGS_WINDOWED) {
+    uip_windowed();
+  }
+#endif /* UIP_TCP_WINDOWED */
+}
+/*---------------------------------------------------------------------------*/
+static void
 appcall(void *state)
 {
   struct tcp_socket *s = state;
@@ -162,6 +267,7 @@ appcall(void *state)
 	   s->listen_port == uip_htons(uip_conn->lport)) {
 	  s->flags &= ~TCP_SOCKET_FLAGS_LISTENING;
           s->output_data_max_seg = uip_mss();
+          connected(s);
 	  tcp_markconn(uip_conn, s);
 	  call_event(s, TCP_SOCKET_CONNECTED);
 	  break;
@@ -169,6 +275,7 @@ appcall(void *state)
       }
     } else {
       s->output_data_max_seg = uip_mss();
+      connected(s);
       call_event(s, TCP_SOCKET_CONNECTED);
     }
 
@@ -286,6 +393,20 @@ tcp_socket_register(struct tcp_socket *s, void *ptr,
 }
 /*---------------------------------------------------------------------------*/
 int
+tcp_socket_windowed(struct tcp_socket *s)
+{
+#if UIP_TCP_WINDOWED
+  if(s == NULL) {
+    return -1;
+  }
+  s->flags |= TCP_SOCKET_FLAGS_WINDOWED;
+  return 1;
+#else /* UIP_TCP_WINDOWED */
+  return -1;
+#endif /* UIP_TCP_WINDOWED */
+}
+/*---------------------------------------------------------------------------*/
+int
 tcp_socket_connect(struct tcp_socket *s,
                    const uip_ipaddr_t *ipaddr,
                    uint16_t port)
@@ -356,6 +477,13 @@ tcp_socket_send(struct tcp_socket *s,
     s->output_senddata_len = s->output_data_len;
   }
 
+#if UIP_TCP_WINDOWED
+  /* A windowed socket does not wait for the periodic poll */
+  if((s->flags & TCP_SOCKET_FLAGS_WINDOWED) && s->c != NULL && len > 0) {
+    tcpip_poll_tcp(s->c);
+  }
+#endif /* UIP_TCP_WINDOWED */
+
   return len;
 }
 /*---------------------------------------------------------------------------*/
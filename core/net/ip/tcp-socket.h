@@ -36,6 +36,13 @@
 
 struct tcp_socket;
 
+/* The maximum number of segments a windowed socket keeps in flight */
+#ifdef TCP_SOCKET_CONF_MAX_SEGMENTS
+#define TCP_SOCKET_MAX_SEGMENTS TCP_SOCKET_CONF_MAX_SEGMENTS
+#else
+#define TCP_SOCKET_MAX_SEGMENTS 4
+#endif
+
 typedef enum {
   TCP_SOCKET_CONNECTED,
   TCP_SOCKET_CLOSED,
@@ -59,6 +66,10 @@ typedef enum {
  *             function must return the amount of data to leave in the
  *             buffer. I.e., if the callback function consumes all
  *             incoming data, it should return 0.
+ *
+ *             If the socket was registered without an input buffer,
+ *             input_data_ptr points directly into the uIP packet
+ *             buffer and is only valid during the callback.
  */
 typedef int (* tcp_socket_data_callback_t)(struct tcp_socket *s,
                                            void *ptr,
@@ -100,6 +111,12 @@ struct tcp_socket {
   uint16_t output_senddata_len;
   uint16_t output_data_max_seg;
 
+#if UIP_TCP_WINDOWED
+  /* The lengths of the segments in flight, oldest first */
+  uint16_t output_seg_len[TCP_SOCKET_MAX_SEGMENTS];
+  uint8_t output_segs;
+#endif /* UIP_TCP_WINDOWED */
+
   uint8_t flags;
   uint16_t listen_port;
   struct uip_conn *c;
@@ -109,6 +126,7 @@ enum {
   TCP_SOCKET_FLAGS_NONE      = 0x00,
   TCP_SOCKET_FLAGS_LISTENING = 0x01,
   TCP_SOCKET_FLAGS_CLOSING   = 0x02,
+  TCP_SOCKET_FLAGS_WINDOWED  = 0x04,
 };
 
 /**
@@ -146,6 +164,10 @@ enum {
  *             application has read out the data from the input
  *             buffer.
  *
+ *             If input_databuf is NULL, incoming data is not copied:
+ *             the data callback is handed a pointer into the uIP
+ *             packet buffer instead, and must consume all of it.
+ *
  */
 int tcp_socket_register(struct tcp_socket *s, void *ptr,
                          uint8_t *input_databuf, int input_databuf_len,
@@ -153,6 +175,26 @@ int tcp_socket_register(struct tcp_socket *s, void *ptr,
                          tcp_socket_data_callback_t data_callback,
                          tcp_socket_event_callback_t event_callback);
 
+/**
+ * \brief      Let a TCP socket keep several segments in flight
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \retval -1  If an error occurs, or if uIP lacks UIP_CONF_TCP_WINDOWED
+ * \retval 1   If the operation succeeds.
+ *
+ *             By default, a TCP socket sends one segment and waits
+ *             for it to be acknowledged before sending the next,
+ *             which limits throughput to one segment per round-trip
+ *             time. A windowed socket sends up to
+ *             TCP_SOCKET_MAX_SEGMENTS segments from its output buffer
+ *             back-to-back, as far as the window of the remote host
+ *             allows, and retransmits the oldest one on a timeout.
+ *
+ *             The function must be called before the socket gets
+ *             connected.
+ *
+ */
+int tcp_socket_windowed(struct tcp_socket *s);
+
 /**
  * \brief      Connect a TCP socket to a remote host
  * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
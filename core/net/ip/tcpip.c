@@ -41,6 +41,7 @@
 #include "contiki-net.h"
 #include "net/ip/uip-split.h"
 #include "net/ip/uip-packetqueue.h"
+#include "net/nettrace.h"
 
 #if NETSTACK_CONF_WITH_IPV6
 #include "net/ipv6/uip-nd6.h"
@@ -106,6 +107,30 @@ enum {
   PACKET_INPUT
 };
 
+#if UIP_PACKET_BUFS > 1
+#if (UIP_PACKET_BUFS & (UIP_PACKET_BUFS - 1)) || UIP_PACKET_BUFS > 128
+#error UIP_CONF_PACKET_BUFS must be a power of two, and at most 128
+#endif
+
+/* The pool of packet buffers besides uip_aligned_buf. Queued packets
+   and free buffers are kept in two rings. The drivers only advance
+   input_put and free_get, and the tcpip process only input_get and
+   free_put, so a driver can use them from an interrupt. The indexes
+   wrap around, and a ring is empty when both are equal. */
+static uip_buf_t bufs[UIP_PACKET_BUFS - 1];
+
+static uip_buf_t *volatile free_bufs[UIP_PACKET_BUFS];
+static volatile uint8_t free_get, free_put;
+
+static volatile struct {
+  uip_buf_t *buf;
+  uint16_t len;
+} input_queue[UIP_PACKET_BUFS];
+static volatile uint8_t input_get, input_put;
+
+#define RING(i) ((i) & (UIP_PACKET_BUFS - 1))
+#endif /* UIP_PACKET_BUFS > 1 */
+
 /* Called on IP packet output. */
 #if NETSTACK_CONF_WITH_IPV6
 
@@ -186,6 +211,10 @@ static void
 packet_input(void)
 {
   if(uip_len > 0) {
+#if NETSTACK_CONF_WITH_IPV6
+    NETTRACE(IP_IN, UIP_IP_BUF->proto,
+             NETTRACE_ID_FROM_IPADDR(&UIP_IP_BUF->srcipaddr), 0, uip_len, 0);
+#endif /* NETSTACK_CONF_WITH_IPV6 */
 
 #if UIP_CONF_IP_FORWARD
     tcpip_is_forwarding = 1;
@@ -213,6 +242,79 @@ packet_input(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_PACKET_BUFS > 1
+static void
+input_init(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < UIP_PACKET_BUFS - 1; i++) {
+    free_bufs[i] = &bufs[i];
+  }
+  free_get = 0;
+  free_put = UIP_PACKET_BUFS - 1;
+  input_get = input_put = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Processes the queued packets, each in the buffer it was received in */
+static void
+input_queued(void)
+{
+  while(input_get != input_put) {
+    /* The current buffer is not in use between events */
+    free_bufs[RING(free_put)] = uip_bufp;
+    free_put++;
+
+    uip_bufp = input_queue[RING(input_get)].buf;
+    uip_len = input_queue[RING(input_get)].len;
+    input_get++;
+
+    packet_input();
+    uip_clear_buf();
+  }
+}
+/*---------------------------------------------------------------------------*/
+uip_buf_t *
+tcpip_input_alloc(void)
+{
+  uip_buf_t *buf;
+
+  if(free_get == free_put) {
+    return NULL;
+  }
+  buf = free_bufs[RING(free_get)];
+  free_get++;
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+void
+tcpip_input_queue(uip_buf_t *buf, uint16_t len)
+{
+  /* There are fewer buffers than slots, so the queue cannot be full */
+  input_queue[RING(input_put)].buf = buf;
+  input_queue[RING(input_put)].len = len;
+  input_put++;
+  process_poll(&tcpip_process);
+}
+/*---------------------------------------------------------------------------*/
+int
+tcpip_input_enqueue(void)
+{
+  uip_buf_t *buf;
+
+  buf = tcpip_input_alloc();
+  if(buf == NULL) {
+    UIP_STAT(++uip_stat.ip.drop);
+    uip_clear_buf();
+    return 0;
+  }
+  tcpip_input_queue(uip_bufp, uip_len);
+  uip_bufp = buf;
+  uip_clear_buf();
+  return 1;
+}
+#endif /* UIP_PACKET_BUFS > 1 */
+/*---------------------------------------------------------------------------*/
 #if UIP_TCP
 #if UIP_ACTIVE_OPEN
 struct uip_conn *
@@ -401,7 +503,7 @@ eventhandler(process_event_t ev, process_data_t data)
         for(cptr = &uip_udp_conns[0];
             cptr < &uip_udp_conns[UIP_UDP_CONNS]; ++cptr) {
           if(cptr->appstate.p == p) {
-            cptr->lport = 0;
+            uip_udp_remove(cptr);
           }
         }
       }
@@ -416,6 +518,20 @@ eventhandler(process_event_t ev, process_data_t data)
         if(data == &periodic &&
            etimer_expired(&periodic)) {
 #if UIP_TCP
+#if NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS
+          {
+            struct uip_conn *cptr;
+
+            /* Only the open connections, and restart the timer only
+               if there are any. */
+            for(cptr = uip_active_conn_next(NULL); cptr != NULL;
+                cptr = uip_active_conn_next(cptr)) {
+              etimer_restart(&periodic);
+              uip_periodic_conn(cptr);
+              tcpip_ipv6_output();
+            }
+          }
+#else /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
           for(i = 0; i < UIP_CONNS; ++i) {
             if(uip_conn_active(i)) {
               /* Only restart the timer if there are active
@@ -433,6 +549,7 @@ eventhandler(process_event_t ev, process_data_t data)
 #endif /* NETSTACK_CONF_WITH_IPV6 */
             }
           }
+#endif /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
 #endif /* UIP_TCP */
 #if UIP_CONF_IP_FORWARD
           uip_fw_periodic();
@@ -510,6 +627,12 @@ eventhandler(process_event_t ev, process_data_t data)
     case PACKET_INPUT:
       packet_input();
       break;
+
+#if UIP_PACKET_BUFS > 1
+    case PROCESS_EVENT_POLL:
+      input_queued();
+      break;
+#endif /* UIP_PACKET_BUFS > 1 */
   };
 }
 /*---------------------------------------------------------------------------*/
@@ -543,6 +666,9 @@ tcpip_ipv6_output(void)
     return;
   }
 
+  NETTRACE(IP_OUT, UIP_IP_BUF->proto,
+           NETTRACE_ID_FROM_IPADDR(&UIP_IP_BUF->destipaddr), 0, uip_len, 0);
+
   if(!uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
     /* Next hop determination */
     nbr = NULL;
@@ -809,6 +935,9 @@ PROCESS_THREAD(tcpip_process, ev, data)
 #endif /* UIP_CONF_ICMP6 */
   etimer_set(&periodic, CLOCK_SECOND / 2);
 
+#if UIP_PACKET_BUFS > 1
+  input_init();
+#endif /* UIP_PACKET_BUFS > 1 */
   uip_init();
 #ifdef UIP_FALLBACK_INTERFACE
   UIP_FALLBACK_INTERFACE.init();
@@ -336,6 +336,42 @@ CCIF extern process_event_t tcpip_event;
  */
 CCIF void tcpip_input(void);
 
+#if UIP_PACKET_BUFS > 1
+/**
+ * \brief      Queue the packet in uip_buf for input
+ * \retval 1   The packet was queued
+ * \retval 0   The packet was dropped because all buffers are in use
+ *
+ *             This function is called by network device drivers
+ *             instead of tcpip_input() to deliver a packet later,
+ *             when the tcpip process is polled. The buffer holding the
+ *             packet is queued as it is, and uip_buf is set to an
+ *             empty buffer from the pool, so a driver can receive a
+ *             burst of packets one after the other.
+ */
+int tcpip_input_enqueue(void);
+
+/**
+ * \brief      Get a free packet buffer to receive a packet into
+ * \return     A buffer from the pool, or NULL if all are in use
+ *
+ *             A driver that receives while the stack may be using
+ *             uip_buf, for example from an interrupt, fills a buffer
+ *             from this function, starting at UIP_LLH_LEN like
+ *             uip_buf, and hands it over with tcpip_input_queue().
+ *             This and tcpip_input_queue() may be called from one
+ *             interrupt handler while the stack runs.
+ */
+union uip_packet_buf *tcpip_input_alloc(void);
+
+/**
+ * \brief      Queue a packet buffer for input
+ * \param buf  A buffer from tcpip_input_alloc()
+ * \param len  The length of the packet in the buffer, as for uip_len
+ */
+void tcpip_input_queue(union uip_packet_buf *buf, uint16_t len);
+#endif /* UIP_PACKET_BUFS > 1 */
+
 /**
  * \brief Output packet to layer 2
  * The eventual parameter is the MAC address of the destination.
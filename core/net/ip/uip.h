@@ -397,6 +397,16 @@ void uip_setipid(uint16_t id);
  */
 #define uip_conn_active(conn) (uip_conns[conn].tcpstateflags != UIP_CLOSED)
 
+#if NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS
+/**
+ * Get the next open TCP connection, for the periodic processing.
+ *
+ * \param conn The previous connection, or NULL to get the first one.
+ * \return The next connection that is not closed, or NULL.
+ */
+struct uip_conn *uip_active_conn_next(struct uip_conn *conn);
+#endif /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
+
 /**
  * Perform periodic processing for a connection identified by a pointer
  * to its structure.
@@ -512,15 +522,23 @@ void uip_reass_over(void);
  \endcode
 */
 
-typedef union {
+typedef union uip_packet_buf {
   uint32_t u32[(UIP_BUFSIZE + 3) / 4];
   uint8_t u8[UIP_BUFSIZE];
 } uip_buf_t;
 
 CCIF extern uip_buf_t uip_aligned_buf;
 
+#if UIP_PACKET_BUFS > 1
+/** The current packet buffer, uip_aligned_buf or one of the pool */
+CCIF extern uip_buf_t *uip_bufp;
+
+/** Macro to access the current packet buffer as an array of bytes */
+#define uip_buf (uip_bufp->u8)
+#else /* UIP_PACKET_BUFS > 1 */
 /** Macro to access uip_aligned_buf as an array of bytes */
 #define uip_buf (uip_aligned_buf.u8)
+#endif /* UIP_PACKET_BUFS > 1 */
 
 
 /** @} */
@@ -692,6 +710,23 @@ CCIF void uip_send(const void *data, int len);
  */
 #define uip_stop()          (uip_conn->tcpstateflags |= UIP_STOPPED)
 
+/**
+ * Allow several unacknowledged segments on the current connection.
+ *
+ * After this call, the application may send new data whenever uIP
+ * invokes it, also while earlier segments are unacknowledged. The
+ * amount of data that fits in the peer's window is given by
+ * uip_mss(). uip_acked() is also set when only part of the data in
+ * flight was acknowledged; uip_outstanding() tells how much remains.
+ * On uip_rexmit(), the application must retransmit the data that
+ * starts at the oldest unacknowledged byte.
+ *
+ * Requires UIP_CONF_TCP_WINDOWED.
+ *
+ * \hideinitializer
+ */
+#define uip_windowed()      (uip_conn->tcpstateflags |= UIP_WINDOWED)
+
 /**
  * Find out if the current connection has been previously stopped with
  * uip_stop().
@@ -874,7 +909,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS
+#define uip_udp_remove(conn) uip_udp_bind_port(conn, 0)
+#else /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
 #define uip_udp_remove(conn) (conn)->lport = 0
+#endif /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
 
 /**
  * Bind a UDP connection to a local port.
@@ -886,7 +925,12 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS
+#define uip_udp_bind(conn, port) uip_udp_bind_port(conn, port)
+void uip_udp_bind_port(struct uip_udp_conn *conn, uint16_t port);
+#else /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
 #define uip_udp_bind(conn, port) (conn)->lport = port
+#endif /* NETSTACK_CONF_WITH_IPV6 && UIP_DEMUX_BUCKETS */
 
 /**
  * Send a UDP datagram of length len on the current connection.
@@ -1370,6 +1414,9 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
                               segment sent. */
+#if UIP_TCP_WINDOWED
+  uint16_t snd_wnd;      /**< The window advertised by the remote host. */
+#endif /* UIP_TCP_WINDOWED */
 
   uip_tcp_appstate_t appstate; /** The application state. */
 };
@@ -1616,6 +1663,7 @@ void uip_process(uint8_t flag);
 #define UIP_TS_MASK     15
 
 #define UIP_STOPPED      16
+#define UIP_WINDOWED     32
 
 /* The TCP and IP headers. */
 struct uip_tcpip_hdr {
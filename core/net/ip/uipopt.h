@@ -175,6 +175,25 @@
 #define UIP_BUFSIZE (UIP_CONF_BUFFER_SIZE)
 #endif /* UIP_CONF_BUFFER_SIZE */
 
+/**
+ * The number of uIP packet buffers.
+ *
+ * With more than one buffer, uip_buf refers to the current one of a
+ * pool, and drivers can queue received packets with
+ * tcpip_input_enqueue() or tcpip_input_queue() while the stack is
+ * still using uip_buf. The queued packets are then processed one
+ * after the other when the tcpip process is next polled, by swapping
+ * the current buffer instead of copying. Must be a power of two, and
+ * at most 128.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_PACKET_BUFS
+#define UIP_PACKET_BUFS (UIP_CONF_PACKET_BUFS)
+#else /* UIP_CONF_PACKET_BUFS */
+#define UIP_PACKET_BUFS 1
+#endif /* UIP_CONF_PACKET_BUFS */
+
 
 /**
  * Determines if statistics support should be compiled in.
@@ -406,6 +425,27 @@ void uip_log(char *msg);
 #define UIP_ACTIVE_OPEN (UIP_CONF_ACTIVE_OPEN)
 #endif /* UIP_CONF_ACTIVE_OPEN */
 
+/**
+ * Determines if TCP connections may have several segments in flight.
+ *
+ * By default, uIP only allows a single unacknowledged segment per
+ * connection, which limits throughput to one MSS per round-trip
+ * time. With this option, an application can call uip_windowed() to
+ * let a connection send new segments before the previous ones have
+ * been acknowledged, as far as the window of the remote host allows.
+ *
+ * The application must then keep all unacknowledged data: when uIP
+ * asks for a retransmission, the oldest unacknowledged segment should
+ * be sent again.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_WINDOWED
+#define UIP_TCP_WINDOWED (UIP_CONF_TCP_WINDOWED)
+#else /* UIP_CONF_TCP_WINDOWED */
+#define UIP_TCP_WINDOWED 0
+#endif /* UIP_CONF_TCP_WINDOWED */
+
 /**
  * The maximum number of simultaneously open TCP connections.
  *
@@ -435,6 +475,26 @@ void uip_log(char *msg);
 #define UIP_LISTENPORTS (UIP_CONF_MAX_LISTENPORTS)
 #endif /* UIP_CONF_MAX_LISTENPORTS */
 
+/**
+ * The number of hash buckets used by uIPv6 to find the connection of
+ * an incoming segment or datagram.
+ *
+ * With a non-zero value, which must be a power of two, TCP connections
+ * are hashed on their address and ports, and UDP connections and
+ * listening TCP ports on their local port, instead of being searched
+ * for one by one. The periodic TCP processing then also only visits
+ * the connections that are open. This is worth its RAM (one or two
+ * bytes per connection and per bucket) when there are many
+ * connections.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_DEMUX_BUCKETS
+#define UIP_DEMUX_BUCKETS (UIP_CONF_DEMUX_BUCKETS)
+#else /* UIP_CONF_DEMUX_BUCKETS */
+#define UIP_DEMUX_BUCKETS 0
+#endif /* UIP_CONF_DEMUX_BUCKETS */
+
 /**
  * Determines if support for TCP urgent data notification should be
  * compiled in.
@@ -120,6 +120,9 @@ uip_lladdr_t uip_lladdr = {{0,0,0,0,0,0}};
 
 /* The packet buffer that contains incoming packets. */
 uip_buf_t uip_aligned_buf;
+#if UIP_PACKET_BUFS > 1
+uip_buf_t *uip_bufp = &uip_aligned_buf;
+#endif /* UIP_PACKET_BUFS > 1 */
 
 void *uip_appdata;               /* The uip_appdata pointer points to
 				    application data. */
@@ -666,6 +669,36 @@ uip_add_rcv_nxt(uint16_t n)
   uip_conn->rcv_nxt[2] = uip_acc32[2];
   uip_conn->rcv_nxt[3] = uip_acc32[3];
 }
+#if UIP_TCP_WINDOWED
+/*---------------------------------------------------------------------------*/
+/* The number of bytes from sequence number b up to sequence number a */
+static uint32_t
+uip_seqdiff(const uint8_t *a, const uint8_t *b)
+{
+  return (((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) |
+	  ((uint32_t)a[2] << 8) | a[3]) -
+    (((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) |
+     ((uint32_t)b[2] << 8) | b[3]);
+}
+/*---------------------------------------------------------------------------*/
+/* On a windowed connection, the MSS is what still fits in the window
+   of the remote host next to the data in flight. */
+static void
+uip_windowed_mss(struct uip_conn *conn)
+{
+  uint16_t room;
+
+  if(conn->snd_wnd == 0 && conn->len == 0) {
+    /* Zero window: probe with a full segment, as for other connections */
+    room = conn->initialmss;
+  } else if(conn->snd_wnd > conn->len) {
+    room = conn->snd_wnd - conn->len;
+  } else {
+    room = 0;
+  }
+  conn->mss = room > conn->initialmss ? conn->initialmss : room;
+}
+#endif /* UIP_TCP_WINDOWED */
 /*---------------------------------------------------------------------------*/
 void
 uip_process(uint8_t flag)
@@ -684,8 +717,10 @@ uip_process(uint8_t flag)
      particular connection. */
   if(flag == UIP_POLL_REQUEST) {
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
-       !uip_outstanding(uip_connr)) {
+       (!uip_outstanding(uip_connr) ||
+	(uip_connr->tcpstateflags & UIP_WINDOWED))) {
 	uip_flags = UIP_POLL;
+	uip_slen = 0;
 	UIP_APPCALL();
 	goto appsend;
 #if UIP_ACTIVE_OPEN && UIP_TCP
@@ -1514,9 +1549,28 @@ uip_process(uint8_t flag)
       /* Reset length of outstanding data. */
       uip_connr->len = 0;
     }
-
+#if UIP_TCP_WINDOWED
+    else if(uip_connr->tcpstateflags & UIP_WINDOWED) {
+      /* A windowed connection has several segments in flight, which
+	 may be acknowledged one at a time. */
+      uint32_t acked = uip_seqdiff(BUF->ackno, uip_connr->snd_nxt);
+      if(acked > 0 && acked < uip_connr->len) {
+	uip_connr->snd_nxt[0] = BUF->ackno[0];
+	uip_connr->snd_nxt[1] = BUF->ackno[1];
+	uip_connr->snd_nxt[2] = BUF->ackno[2];
+	uip_connr->snd_nxt[3] = BUF->ackno[3];
+	uip_connr->len -= acked;
+	uip_flags = UIP_ACKDATA;
+	uip_connr->timer = uip_connr->rto;
+      }
+    }
+#endif /* UIP_TCP_WINDOWED */
   }
 
+#if UIP_TCP_WINDOWED
+  uip_connr->snd_wnd = ((uint16_t)BUF->wnd[0] << 8) + (uint16_t)BUF->wnd[1];
+#endif /* UIP_TCP_WINDOWED */
+
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
     /* CLOSED and LISTEN are not handled here. CLOSE_WAIT is not
@@ -1686,6 +1740,11 @@ uip_process(uint8_t flag)
       tmp16 = uip_connr->initialmss;
     }
     uip_connr->mss = tmp16;
+#if UIP_TCP_WINDOWED
+    if(uip_connr->tcpstateflags & UIP_WINDOWED) {
+      uip_windowed_mss(uip_connr);
+    }
+#endif /* UIP_TCP_WINDOWED */
 
     /* If this packet constitutes an ACK for outstanding data (flagged
        by the UIP_ACKDATA flag, we should call the application since it
@@ -1726,6 +1785,17 @@ uip_process(uint8_t flag)
       }
 
       /* If uip_slen > 0, the application has data to be sent. */
+#if UIP_TCP_WINDOWED
+      if(uip_slen > 0 && (uip_connr->tcpstateflags & UIP_WINDOWED)) {
+	/* New data is sent behind the data in flight, as far as the
+	   window of the remote host allows. */
+	if(uip_slen > uip_connr->mss) {
+	  uip_slen = uip_connr->mss;
+	}
+	uip_connr->len += uip_slen;
+	uip_windowed_mss(uip_connr);
+      } else
+#endif /* UIP_TCP_WINDOWED */
       if(uip_slen > 0) {
 
 	/* If the connection has acknowledged data, the contents of
@@ -1766,6 +1836,16 @@ uip_process(uint8_t flag)
       if(uip_slen > 0 && uip_connr->len > 0) {
 	/* Add the length of the IP and TCP headers. */
 	uip_len = uip_connr->len + UIP_TCPIP_HLEN;
+#if UIP_TCP_WINDOWED
+	if(uip_connr->tcpstateflags & UIP_WINDOWED) {
+	  /* Only the new segment, or the oldest one when
+	     retransmitting, goes out. */
+	  if(uip_slen > uip_connr->len) {
+	    uip_slen = uip_connr->len;
+	  }
+	  uip_len = uip_slen + UIP_TCPIP_HLEN;
+	}
+#endif /* UIP_TCP_WINDOWED */
 	/* We always set the ACK flag in response packets. */
 	BUF->flags = TCP_ACK | TCP_PSH;
 	/* Send the packet. */
@@ -1872,6 +1952,20 @@ uip_process(uint8_t flag)
   BUF->seqno[1] = uip_connr->snd_nxt[1];
   BUF->seqno[2] = uip_connr->snd_nxt[2];
   BUF->seqno[3] = uip_connr->snd_nxt[3];
+#if UIP_TCP_WINDOWED
+  if((uip_connr->tcpstateflags & UIP_WINDOWED) &&
+     (uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+     !(uip_flags & UIP_REXMIT)) {
+    /* Anything but a retransmission starts after the data in flight;
+       a new segment has already been counted in ->len. */
+    uip_add32(uip_connr->snd_nxt,
+	      uip_connr->len - (uip_len - UIP_TCPIP_HLEN));
+    BUF->seqno[0] = uip_acc32[0];
+    BUF->seqno[1] = uip_acc32[1];
+    BUF->seqno[2] = uip_acc32[2];
+    BUF->seqno[3] = uip_acc32[3];
+  }
+#endif /* UIP_TCP_WINDOWED */
 
   BUF->srcport  = uip_connr->lport;
   BUF->destport = uip_connr->rport;
@@ -194,7 +194,13 @@ struct trickle_param {
 #define SEQ_VAL_ADD(s, n) (((s) + (n)) % 0x8000)
 /*---------------------------------------------------------------------------*/
 /* Sliding Windows */
+struct mcast_packet;
+
 struct sliding_window {
+#if ROLL_TM_WIN_HASH_SIZE
+  struct sliding_window *hnext; /* Next window in the same hash bucket */
+#endif
+  struct mcast_packet *head;    /* Buffered packets of this window */
   seed_id_t seed_id;
   int16_t lower_bound;          /* lolipop */
   int16_t upper_bound;          /* lolipop */
@@ -225,7 +231,6 @@ struct sliding_window {
  * w: pointer to a sliding window
  */
 #define SLIDING_WINDOW_IS_USED_CLR(w) ((w)->flags &= ~SLIDING_WINDOW_U_BIT)
-#define window_free(w) SLIDING_WINDOW_IS_USED_CLR(w)
 
 /**
  * \brief Set 'Is Seen' bit for window w
@@ -270,6 +275,7 @@ struct mcast_packet {
   /* Short seeds are stored inside the message */
   seed_id_t seed_id;
 #endif
+  struct mcast_packet *next;    /* Next packet of the same sliding window */
   uint32_t active;              /* Starts at 0 and increments */
   uint32_t dwell;               /* Starts at 0 and increments */
   uint16_t buff_len;
@@ -443,6 +449,9 @@ static struct roll_tm_stats stats;
 static struct trickle_param t[2];
 static struct sliding_window windows[ROLL_TM_WINS];
 static struct mcast_packet buffered_msgs[ROLL_TM_BUFF_NUM];
+#if ROLL_TM_WIN_HASH_SIZE
+static struct sliding_window *win_hash[ROLL_TM_WIN_HASH_SIZE];
+#endif
 /*---------------------------------------------------------------------------*/
 /* Temporary Stores */
 /*---------------------------------------------------------------------------*/
@@ -473,6 +482,8 @@ static void icmp_output(void);
 static void window_update_bounds(void);
 static void reset_trickle_timer(uint8_t);
 static void handle_timer(void *);
+static void window_free(struct sliding_window *);
+static void buffer_free(struct mcast_packet *);
 /*---------------------------------------------------------------------------*/
 /* ROLL TM ICMPv6 handler declaration */
 UIP_ICMP6_HANDLER(roll_tm_icmp_handler, ICMP6_ROLL_TM,
@@ -614,7 +625,7 @@ handle_timer(void *ptr)
           PRINTF("\n");
           window_free(locmpptr->sw);
         }
-        MCAST_PACKET_FREE(locmpptr);
+        buffer_free(locmpptr);
       } else if(MCAST_PACKET_TTL(locmpptr) > 0) {
         /* Handle multicast transmissions */
         if(locmpptr->active < TRICKLE_ACTIVE(param) &&
@@ -689,6 +700,7 @@ window_allocate()
       iterswptr--) {
     if(!SLIDING_WINDOW_IS_USED(iterswptr)) {
       iterswptr->count = 0;
+      iterswptr->head = NULL;
       iterswptr->lower_bound = -1;
       iterswptr->upper_bound = -1;
       iterswptr->min_listed = -1;
@@ -698,15 +710,61 @@ window_allocate()
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if ROLL_TM_WIN_HASH_SIZE
+/*
+ * Seed IDs are either short addresses or full IPv6 addresses whose IID
+ * is derived from the MAC. Either way, the last two bytes vary the most
+ */
+#define WIN_HASH_BUCKET(s, m) \
+  (&win_hash[(((uint8_t *)(s))[sizeof(seed_id_t) - 1] ^ \
+              (((uint8_t *)(s))[sizeof(seed_id_t) - 2] * 7) ^ (m)) & \
+             (ROLL_TM_WIN_HASH_SIZE - 1)])
+
+static void
+window_hash_insert(struct sliding_window *w)
+{
+  struct sliding_window **bucket;
+
+  bucket = WIN_HASH_BUCKET(&w->seed_id, SLIDING_WINDOW_GET_M(w));
+  w->hnext = *bucket;
+  *bucket = w;
+}
+#endif /* ROLL_TM_WIN_HASH_SIZE */
+/*---------------------------------------------------------------------------*/
+static void
+window_free(struct sliding_window *w)
+{
+#if ROLL_TM_WIN_HASH_SIZE
+  struct sliding_window **pp;
+
+  if(SLIDING_WINDOW_IS_USED(w)) {
+    for(pp = WIN_HASH_BUCKET(&w->seed_id, SLIDING_WINDOW_GET_M(w));
+        *pp != NULL; pp = &(*pp)->hnext) {
+      if(*pp == w) {
+        *pp = w->hnext;
+        break;
+      }
+    }
+  }
+#endif
+  SLIDING_WINDOW_IS_USED_CLR(w);
+}
+/*---------------------------------------------------------------------------*/
 static struct sliding_window *
 window_lookup(seed_id_t *s, uint8_t m)
 {
+#if ROLL_TM_WIN_HASH_SIZE
+  for(iterswptr = *WIN_HASH_BUCKET(s, m); iterswptr != NULL;
+      iterswptr = iterswptr->hnext) {
+#else
   for(iterswptr = &windows[ROLL_TM_WINS - 1]; iterswptr >= windows;
       iterswptr--) {
+#endif
     VERBOSE_PRINTF("ROLL TM: M=%u (%u) ", SLIDING_WINDOW_GET_M(iterswptr), m);
     VERBOSE_PRINT_SEED(&iterswptr->seed_id);
     VERBOSE_PRINTF("\n");
-    if(seed_id_cmp(s, &iterswptr->seed_id) &&
+    if(SLIDING_WINDOW_IS_USED(iterswptr) &&
+       seed_id_cmp(s, &iterswptr->seed_id) &&
        SLIDING_WINDOW_GET_M(iterswptr) == m) {
       return iterswptr;
     }
@@ -714,6 +772,21 @@ window_lookup(seed_id_t *s, uint8_t m)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+/* Recalculate the bounds of a single window from its own packet list */
+static void
+window_update_bounds_one(struct sliding_window *w)
+{
+  w->lower_bound = -1;
+  for(locmpptr = w->head; locmpptr != NULL; locmpptr = locmpptr->next) {
+    if(w->lower_bound < 0 || SEQ_VAL_IS_LT(locmpptr->seq_val, w->lower_bound)) {
+      w->lower_bound = locmpptr->seq_val;
+    }
+    if(w->upper_bound < 0 || SEQ_VAL_IS_GT(locmpptr->seq_val, w->upper_bound)) {
+      w->upper_bound = locmpptr->seq_val;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
 static void
 window_update_bounds()
 {
@@ -764,15 +837,13 @@ buffer_reclaim()
   PRINTF(" M=%u, count was %u\n",
          SLIDING_WINDOW_GET_M(largest), largest->count);
   /* Find the packet at the lowest bound for the largest window */
-  for(locmpptr = &buffered_msgs[ROLL_TM_BUFF_NUM - 1];
-      locmpptr >= buffered_msgs; locmpptr--) {
-    if(MCAST_PACKET_IS_USED(locmpptr) && (locmpptr->sw == largest) &&
-       SEQ_VAL_IS_EQ(locmpptr->seq_val, largest->lower_bound)) {
+  for(locmpptr = largest->head; locmpptr != NULL; locmpptr = locmpptr->next) {
+    if(SEQ_VAL_IS_EQ(locmpptr->seq_val, largest->lower_bound)) {
       rv = locmpptr;
       PRINTF("ROLL TM: Reclaim seq. val %u\n", locmpptr->seq_val);
-      MCAST_PACKET_FREE(rv);
+      buffer_free(rv);
       largest->count--;
-      window_update_bounds();
+      window_update_bounds_one(largest);
       VERBOSE_PRINTF("ROLL TM: Reclaim - new bounds [%u , %u]\n",
                      largest->lower_bound, largest->upper_bound);
       return rv;
@@ -783,6 +854,20 @@ buffer_reclaim()
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+static void
+buffer_free(struct mcast_packet *p)
+{
+  struct mcast_packet **pp;
+
+  for(pp = &p->sw->head; *pp != NULL; pp = &(*pp)->next) {
+    if(*pp == p) {
+      *pp = p->next;
+      break;
+    }
+  }
+  MCAST_PACKET_FREE(p);
+}
+/*---------------------------------------------------------------------------*/
 static struct mcast_packet *
 buffer_allocate()
 {
@@ -832,18 +917,15 @@ icmp_output()
 
       buffer = (uint8_t *)sl + sizeof(struct sequence_list_header);
 
-      for(locmpptr = &buffered_msgs[ROLL_TM_BUFF_NUM - 1];
-          locmpptr >= buffered_msgs; locmpptr--) {
-        if(MCAST_PACKET_IS_USED(locmpptr) &&
-           locmpptr->active < TRICKLE_ACTIVE((&t[SLIDING_WINDOW_GET_M(iterswptr)]))) {
-          if(locmpptr->sw == iterswptr) {
-            sl->seq_len++;
-            PRINTF(", %u", locmpptr->seq_val);
-            *buffer = (uint8_t)(locmpptr->seq_val >> 8);
-            buffer++;
-            *buffer = (uint8_t)(locmpptr->seq_val & 0xFF);
-            buffer++;
-          }
+      for(locmpptr = iterswptr->head; locmpptr != NULL;
+          locmpptr = locmpptr->next) {
+        if(locmpptr->active < TRICKLE_ACTIVE((&t[SLIDING_WINDOW_GET_M(iterswptr)]))) {
+          sl->seq_len++;
+          PRINTF(", %u", locmpptr->seq_val);
+          *buffer = (uint8_t)(locmpptr->seq_val >> 8);
+          buffer++;
+          *buffer = (uint8_t)(locmpptr->seq_val & 0xFF);
+          buffer++;
         }
       }
       PRINTF(", Len=%u\n", sl->seq_len);
@@ -978,12 +1060,9 @@ accept(uint8_t in)
       UIP_MCAST6_STATS_ADD(mcast_dropped);
       return UIP_MCAST6_DROP;
     }
-    for(locmpptr = &buffered_msgs[ROLL_TM_BUFF_NUM - 1];
-        locmpptr >= buffered_msgs; locmpptr--) {
-      if(MCAST_PACKET_IS_USED(locmpptr) &&
-         locmpptr->sw == locswptr &&
-         SLIDING_WINDOW_GET_M(locmpptr->sw) == m &&
-         SEQ_VAL_IS_EQ(seq_val, locmpptr->seq_val)) {
+    for(locmpptr = locswptr->head; locmpptr != NULL;
+        locmpptr = locmpptr->next) {
+      if(SEQ_VAL_IS_EQ(seq_val, locmpptr->seq_val)) {
         /* Seen before , drop */
         PRINTF("ROLL TM: Seen before\n");
         UIP_MCAST6_STATS_ADD(mcast_dropped);
@@ -1020,9 +1099,9 @@ accept(uint8_t in)
     PRINTF("ROLL TM: Buffer reclaim failed\n");
     if(locswptr->count == 0) {
       window_free(locswptr);
-      UIP_MCAST6_STATS_ADD(mcast_dropped);
-      return UIP_MCAST6_DROP;
     }
+    UIP_MCAST6_STATS_ADD(mcast_dropped);
+    return UIP_MCAST6_DROP;
   }
 #if UIP_MCAST6_STATS
   if(in == ROLL_TM_DGRAM_IN) {
@@ -1032,12 +1111,17 @@ accept(uint8_t in)
 
   /* We have a window and we have a buffer. Accept this message */
   /* Set the seed ID and correct M for this window */
-  SLIDING_WINDOW_M_CLR(locswptr);
-  if(m) {
-    SLIDING_WINDOW_M_SET(locswptr);
+  if(!SLIDING_WINDOW_IS_USED(locswptr)) {
+    SLIDING_WINDOW_M_CLR(locswptr);
+    if(m) {
+      SLIDING_WINDOW_M_SET(locswptr);
+    }
+    SLIDING_WINDOW_IS_USED_SET(locswptr);
+    seed_id_cpy(&locswptr->seed_id, seed_ptr);
+#if ROLL_TM_WIN_HASH_SIZE
+    window_hash_insert(locswptr);
+#endif
   }
-  SLIDING_WINDOW_IS_USED_SET(locswptr);
-  seed_id_cpy(&locswptr->seed_id, seed_ptr);
   PRINTF("ROLL TM: Window for seed ");
   PRINT_SEED(&locswptr->seed_id);
   PRINTF(" M=%u, count=%u\n",
@@ -1062,6 +1146,8 @@ accept(uint8_t in)
   locmpptr->sw = locswptr;
   locmpptr->buff_len = uip_len;
   locmpptr->seq_val = seq_val;
+  locmpptr->next = locswptr->head;
+  locswptr->head = locmpptr;
   MCAST_PACKET_USED_SET(locmpptr);
 
   PRINTF("ROLL TM: Window for seed ");
@@ -1222,23 +1308,21 @@ icmp_input()
 
           inconsistency = 1;
           /* Check if the advertised sequence is in our buffer */
-          for(locmpptr = &buffered_msgs[ROLL_TM_BUFF_NUM - 1];
-              locmpptr >= buffered_msgs; locmpptr--) {
-            if(MCAST_PACKET_IS_USED(locmpptr) && locmpptr->sw == locswptr) {
-              if(SEQ_VAL_IS_EQ(locmpptr->seq_val, val)) {
-
-                inconsistency = 0;
-                MCAST_PACKET_LISTED_SET(locmpptr);
-                PRINTF("ROLL TM: ICMPv6 In, %u listed\n", locmpptr->seq_val);
-
-                /* Update lowest seq. num listed for this window
-                 * We need this to check for "we have new" */
-                if(locswptr->min_listed == -1 ||
-                   SEQ_VAL_IS_LT(val, locswptr->min_listed)) {
-                  locswptr->min_listed = val;
-                }
-                break;
+          for(locmpptr = locswptr->head; locmpptr != NULL;
+              locmpptr = locmpptr->next) {
+            if(SEQ_VAL_IS_EQ(locmpptr->seq_val, val)) {
+
+              inconsistency = 0;
+              MCAST_PACKET_LISTED_SET(locmpptr);
+              PRINTF("ROLL TM: ICMPv6 In, %u listed\n", locmpptr->seq_val);
+
+              /* Update lowest seq. num listed for this window
+               * We need this to check for "we have new" */
+              if(locswptr->min_listed == -1 ||
+                 SEQ_VAL_IS_LT(val, locswptr->min_listed)) {
+                locswptr->min_listed = val;
               }
+              break;
             }
           }
           if(inconsistency) {
@@ -1398,7 +1482,8 @@ in()
     return UIP_MCAST6_DROP;
   }
 
-  if(!uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr)) {
+  if(!(uip_mcast6_route_decision(&UIP_IP_BUF->destipaddr) &
+       UIP_MCAST6_ROUTE_MEMBER)) {
     PRINTF("ROLL TM: Not a group member. No further processing\n");
     return UIP_MCAST6_DROP;
   } else {
@@ -1416,6 +1501,9 @@ init()
   memset(windows, 0, sizeof(windows));
   memset(buffered_msgs, 0, sizeof(buffered_msgs));
   memset(t, 0, sizeof(t));
+#if ROLL_TM_WIN_HASH_SIZE
+  memset(win_hash, 0, sizeof(win_hash));
+#endif
 
   ROLL_TM_STATS_INIT();
   UIP_MCAST6_STATS_INIT(&stats);
@@ -175,6 +175,22 @@
 #define ROLL_TM_WINS 2
 #endif
 /*---------------------------------------------------------------------------*/
+/**
+ * Number of buckets in the Seed ID hash index over the sliding windows
+ * Lookups by Seed ID happen for every accepted datagram and for every
+ * sequence list in incoming ICMP messages. With few windows a linear scan is
+ * cheapest, so hashing is off (0) by default. Must be a power of two.
+ */
+#ifdef ROLL_TM_CONF_WIN_HASH_SIZE
+#define ROLL_TM_WIN_HASH_SIZE ROLL_TM_CONF_WIN_HASH_SIZE
+#else
+#define ROLL_TM_WIN_HASH_SIZE 0
+#endif
+
+#if (ROLL_TM_WIN_HASH_SIZE & (ROLL_TM_WIN_HASH_SIZE - 1)) != 0
+#error "ROLL_TM_CONF_WIN_HASH_SIZE must be a power of two"
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * Maximum Number of Buffered Multicast Messages
  * This buffer is shared across all Seed IDs, therefore a new very active Seed
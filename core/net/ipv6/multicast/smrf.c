@@ -90,6 +90,7 @@ in()
   rpl_dag_t *d;                 /* Our DODAG */
   uip_ipaddr_t *parent_ipaddr;  /* Our pref. parent's IPv6 address */
   const uip_lladdr_t *parent_lladdr;  /* Our pref. parent's LL address */
+  uint8_t decision;             /* Cached forwarding decision for the group */
 
   /*
    * Fetch a pointer to the LL address of our preferred parent
@@ -133,9 +134,11 @@ in()
   UIP_MCAST6_STATS_ADD(mcast_in_all);
   UIP_MCAST6_STATS_ADD(mcast_in_unique);
 
+  decision = uip_mcast6_route_decision(&UIP_IP_BUF->destipaddr);
+
   /* If we have an entry in the mcast routing table, something with
    * a higher RPL rank (somewhere down the tree) is a group member */
-  if(uip_mcast6_route_lookup(&UIP_IP_BUF->destipaddr)) {
+  if(decision & UIP_MCAST6_ROUTE_FWD) {
     /* If we enter here, we will definitely forward */
     UIP_MCAST6_STATS_ADD(mcast_fwd);
 
@@ -177,7 +180,7 @@ in()
   }
 
   /* Done with this packet unless we are a member of the mcast group */
-  if(!uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr)) {
+  if(!(decision & UIP_MCAST6_ROUTE_MEMBER)) {
     PRINTF("SMRF: Not a group member. No further processing\n");
     return UIP_MCAST6_DROP;
   } else {
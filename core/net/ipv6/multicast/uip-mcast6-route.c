@@ -44,6 +44,7 @@
 #include "lib/list.h"
 #include "lib/memb.h"
 #include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/multicast/uip-mcast6-route.h"
 
 #include <stdint.h>
@@ -61,10 +62,66 @@ LIST(mcast_route_list);
 MEMB(mcast_route_memb, uip_mcast6_route_t, UIP_MCAST6_ROUTE_ROUTES);
 
 static uip_mcast6_route_t *locmcastrt;
+
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+static uip_mcast6_route_t *mcast_route_hash[UIP_MCAST6_ROUTE_HASH_SIZE];
+#endif
+
+#if UIP_MCAST6_ROUTE_FWD_CACHE_SIZE
+/* Cache entries are valid when this bit is set in their flags */
+#define FWD_CACHE_VALID 0x80
+
+struct fwd_cache_entry {
+  uip_ipaddr_t group;
+  uint8_t flags;
+};
+
+static struct fwd_cache_entry fwd_cache[UIP_MCAST6_ROUTE_FWD_CACHE_SIZE];
+#endif
+/*---------------------------------------------------------------------------*/
+#if UIP_MCAST6_ROUTE_HASH_SIZE || UIP_MCAST6_ROUTE_FWD_CACHE_SIZE
+/*
+ * Group IDs live in the low order bytes of the address, the scope in the
+ * second byte. Fold those together; the prefix bytes are mostly constant.
+ */
+static uint8_t
+group_hash(const uip_ipaddr_t *group)
+{
+  return group->u8[1] ^ group->u8[12] ^ group->u8[13] ^
+         group->u8[14] ^ (group->u8[15] * 31);
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+#define HASH_BUCKET(g) (&mcast_route_hash[group_hash(g) & \
+                                          (UIP_MCAST6_ROUTE_HASH_SIZE - 1)])
+
+static void
+hash_remove(uip_mcast6_route_t *route)
+{
+  uip_mcast6_route_t **pp;
+
+  for(pp = HASH_BUCKET(&route->group); *pp != NULL; pp = &(*pp)->hnext) {
+    if(*pp == route) {
+      *pp = route->hnext;
+      return;
+    }
+  }
+}
+#endif /* UIP_MCAST6_ROUTE_HASH_SIZE */
 /*---------------------------------------------------------------------------*/
 uip_mcast6_route_t *
 uip_mcast6_route_lookup(uip_ipaddr_t *group)
 {
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+  for(locmcastrt = *HASH_BUCKET(group);
+      locmcastrt != NULL;
+      locmcastrt = locmcastrt->hnext) {
+    if(uip_ipaddr_cmp(&locmcastrt->group, group)) {
+      return locmcastrt;
+    }
+  }
+#else /* UIP_MCAST6_ROUTE_HASH_SIZE */
   locmcastrt = NULL;
   for(locmcastrt = list_head(mcast_route_list);
       locmcastrt != NULL;
@@ -73,6 +130,7 @@ uip_mcast6_route_lookup(uip_ipaddr_t *group)
       return locmcastrt;
     }
   }
+#endif /* UIP_MCAST6_ROUTE_HASH_SIZE */
 
   return NULL;
 }
@@ -89,12 +147,17 @@ uip_mcast6_route_add(uip_ipaddr_t *group)
       return NULL;
     }
     list_add(mcast_route_list, locmcastrt);
+
+    uip_ipaddr_copy(&(locmcastrt->group), group);
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+    locmcastrt->hnext = *HASH_BUCKET(group);
+    *HASH_BUCKET(group) = locmcastrt;
+#endif
+    uip_mcast6_route_cache_flush();
   }
 
   /* Reaching here means we either found the prefix or allocated a new one */
 
-  uip_ipaddr_copy(&(locmcastrt->group), group);
-
   return locmcastrt;
 }
 /*---------------------------------------------------------------------------*/
@@ -107,7 +170,11 @@ uip_mcast6_route_rm(uip_mcast6_route_t *route)
       locmcastrt = list_item_next(locmcastrt)) {
     if(locmcastrt == route) {
       list_remove(mcast_route_list, route);
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+      hash_remove(route);
+#endif
       memb_free(&mcast_route_memb, route);
+      uip_mcast6_route_cache_flush();
       return;
     }
   }
@@ -125,11 +192,52 @@ uip_mcast6_route_count(void)
   return list_length(mcast_route_list);
 }
 /*---------------------------------------------------------------------------*/
+uint8_t
+uip_mcast6_route_decision(uip_ipaddr_t *group)
+{
+  uint8_t flags;
+#if UIP_MCAST6_ROUTE_FWD_CACHE_SIZE
+  struct fwd_cache_entry *e;
+
+  e = &fwd_cache[group_hash(group) & (UIP_MCAST6_ROUTE_FWD_CACHE_SIZE - 1)];
+  if((e->flags & FWD_CACHE_VALID) && uip_ipaddr_cmp(&e->group, group)) {
+    return e->flags & ~FWD_CACHE_VALID;
+  }
+#endif
+
+  flags = 0;
+  if(uip_mcast6_route_lookup(group) != NULL) {
+    flags |= UIP_MCAST6_ROUTE_FWD;
+  }
+  if(uip_ds6_is_my_maddr(group)) {
+    flags |= UIP_MCAST6_ROUTE_MEMBER;
+  }
+
+#if UIP_MCAST6_ROUTE_FWD_CACHE_SIZE
+  uip_ipaddr_copy(&e->group, group);
+  e->flags = flags | FWD_CACHE_VALID;
+#endif
+
+  return flags;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_route_cache_flush(void)
+{
+#if UIP_MCAST6_ROUTE_FWD_CACHE_SIZE
+  memset(fwd_cache, 0, sizeof(fwd_cache));
+#endif
+}
+/*---------------------------------------------------------------------------*/
 void
 uip_mcast6_route_init()
 {
   memb_init(&mcast_route_memb);
   list_init(mcast_route_list);
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+  memset(mcast_route_hash, 0, sizeof(mcast_route_hash));
+#endif
+  uip_mcast6_route_cache_flush();
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
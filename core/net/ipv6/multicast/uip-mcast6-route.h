@@ -47,14 +47,51 @@
 
 #include <stdint.h>
 /*---------------------------------------------------------------------------*/
+/**
+ * Number of buckets in the group hash index. When set to 0 (default), group
+ * lookups walk the route list. Must be a power of two otherwise.
+ */
+#ifdef UIP_MCAST6_ROUTE_CONF_HASH_SIZE
+#define UIP_MCAST6_ROUTE_HASH_SIZE UIP_MCAST6_ROUTE_CONF_HASH_SIZE
+#else
+#define UIP_MCAST6_ROUTE_HASH_SIZE 0
+#endif
+
+/**
+ * Number of entries in the per-group forwarding decision cache. The cache is
+ * direct-mapped and flushed whenever the routing table or the set of joined
+ * groups changes. Set to 0 to disable.
+ */
+#ifdef UIP_MCAST6_ROUTE_CONF_FWD_CACHE_SIZE
+#define UIP_MCAST6_ROUTE_FWD_CACHE_SIZE UIP_MCAST6_ROUTE_CONF_FWD_CACHE_SIZE
+#else
+#define UIP_MCAST6_ROUTE_FWD_CACHE_SIZE 0
+#endif
+
+#if (UIP_MCAST6_ROUTE_HASH_SIZE & (UIP_MCAST6_ROUTE_HASH_SIZE - 1)) != 0
+#error "UIP_MCAST6_ROUTE_CONF_HASH_SIZE must be a power of two"
+#endif
+#if (UIP_MCAST6_ROUTE_FWD_CACHE_SIZE & (UIP_MCAST6_ROUTE_FWD_CACHE_SIZE - 1)) != 0
+#error "UIP_MCAST6_ROUTE_CONF_FWD_CACHE_SIZE must be a power of two"
+#endif
+/*---------------------------------------------------------------------------*/
 /** \brief An entry in the multicast routing table */
 typedef struct uip_mcast6_route {
   struct uip_mcast6_route *next; /**< Routes are arranged in a linked list */
+#if UIP_MCAST6_ROUTE_HASH_SIZE
+  struct uip_mcast6_route *hnext; /**< Next route in the same hash bucket */
+#endif
   uip_ipaddr_t group; /**< The multicast group */
   uint32_t lifetime; /**< Entry lifetime seconds */
   void *dag; /**< Pointer to an rpl_dag_t struct */
 } uip_mcast6_route_t;
 /*---------------------------------------------------------------------------*/
+/** \name Forwarding decision flags */
+/** @{ */
+#define UIP_MCAST6_ROUTE_FWD    0x01 /**< A downward route exists: forward */
+#define UIP_MCAST6_ROUTE_MEMBER 0x02 /**< We have joined the group: deliver */
+/** @} */
+/*---------------------------------------------------------------------------*/
 /** \name Multicast Routing Table Manipulation */
 /** @{ */
 
@@ -92,6 +129,25 @@ int uip_mcast6_route_count(void);
  * If the multicast routes list is empty, this function will return NULL
  */
 uip_mcast6_route_t *uip_mcast6_route_list_head(void);
+
+/**
+ * \brief Retrieve the forwarding decision for a multicast group
+ * \param group A pointer to the multicast group
+ * \return A combination of UIP_MCAST6_ROUTE_FWD and UIP_MCAST6_ROUTE_MEMBER
+ *
+ * The decision is served from the forwarding cache when possible, so that
+ * engines can call this once per datagram instead of performing a route
+ * lookup followed by a group membership check.
+ */
+uint8_t uip_mcast6_route_decision(uip_ipaddr_t *group);
+
+/**
+ * \brief Invalidate all cached forwarding decisions
+ *
+ *        Called internally when routes are added or removed. It must also
+ *        be called when the node joins or leaves a multicast group.
+ */
+void uip_mcast6_route_cache_flush(void);
 /*---------------------------------------------------------------------------*/
 /**
  * \brief Multicast routing table init routine
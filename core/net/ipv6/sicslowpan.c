@@ -68,6 +68,7 @@
 #include "net/rime/rime.h"
 #include "net/ipv6/sicslowpan.h"
 #include "net/netstack.h"
+#include "net/nettrace.h"
 
 #include <stdio.h>
 
@@ -1415,6 +1416,7 @@ output(const uip_lladdr_t *localdest)
     linkaddr_copy(&dest, (const linkaddr_t *)localdest);
   }
 
+  NETTRACE(SICSLOWPAN_OUT, 0, NETTRACE_ID_FROM_LINKADDR(&dest), 0, uip_len, 0);
   PRINTFO("sicslowpan output: sending packet len %d\n", uip_len);
 
   if(uip_len >= COMPRESSION_THRESHOLD) {
@@ -1613,6 +1615,9 @@ input(void)
   /* Save the RSSI of the incoming packet in case the upper layer will
      want to query us for it later. */
   last_rssi = (signed short)packetbuf_attr(PACKETBUF_ATTR_RSSI);
+  NETTRACE(SICSLOWPAN_IN, 0,
+           NETTRACE_ID_FROM_LINKADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER)),
+           0, packetbuf_datalen(), last_rssi);
 #if SICSLOWPAN_CONF_FRAG
   /* if reassembly timed out, cancel it */
   if(timer_expired(&reass_timer)) {
@@ -49,6 +49,7 @@
 #include "net/ipv6/uip-nd6.h"
 #include "net/ipv6/uip-ds6.h"
 #include "net/ip/uip-packetqueue.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
 
 #define DEBUG DEBUG_NONE
 #include "net/ip/uip-debug.h"
@@ -88,6 +89,72 @@ static uip_ds6_aaddr_t *locaaddr;
 #endif /* UIP_DS6_AADDR_NB */
 static uip_ds6_prefix_t *locprefix;
 
+#if UIP_DS6_DEST_FILTER_SIZE
+#define DEST_FILTER_MASK ((UIP_DS6_DEST_FILTER_SIZE * 8) - 1)
+
+static uint8_t dest_filter[UIP_DS6_DEST_FILTER_SIZE];
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
+
+/*---------------------------------------------------------------------------*/
+#if UIP_DS6_DEST_FILTER_SIZE
+/*
+ * Two bit positions per address. Our addresses mostly differ in the scope
+ * (first two bytes) and in the low order bytes of the IID / group ID.
+ */
+#define DEST_FILTER_H1(a) (((a)->u8[15] ^ ((a)->u8[13] << 3) ^ \
+                            ((a)->u8[1] << 5) ^ (a)->u8[0]) & DEST_FILTER_MASK)
+#define DEST_FILTER_H2(a) (((a)->u8[14] ^ ((a)->u8[12] << 2) ^ \
+                            ((a)->u8[11] << 4) ^ ((a)->u8[15] >> 3) ^ \
+                            ((a)->u8[1] << 1)) & DEST_FILTER_MASK)
+
+static void
+dest_filter_add(const uip_ipaddr_t *ipaddr)
+{
+  uint16_t h;
+
+  h = DEST_FILTER_H1(ipaddr);
+  dest_filter[h >> 3] |= 1 << (h & 7);
+  h = DEST_FILTER_H2(ipaddr);
+  dest_filter[h >> 3] |= 1 << (h & 7);
+}
+/*---------------------------------------------------------------------------*/
+static int
+dest_filter_check(const uip_ipaddr_t *ipaddr)
+{
+  uint16_t h1 = DEST_FILTER_H1(ipaddr);
+  uint16_t h2 = DEST_FILTER_H2(ipaddr);
+
+  return (dest_filter[h1 >> 3] & (1 << (h1 & 7))) &&
+         (dest_filter[h2 >> 3] & (1 << (h2 & 7)));
+}
+/*---------------------------------------------------------------------------*/
+/* Bits can't be cleared individually. Removals are rare: start over */
+static void
+dest_filter_rebuild(void)
+{
+  uint8_t i;
+
+  memset(dest_filter, 0, sizeof(dest_filter));
+  for(i = 0; i < UIP_DS6_ADDR_NB; i++) {
+    if(uip_ds6_if.addr_list[i].isused) {
+      dest_filter_add(&uip_ds6_if.addr_list[i].ipaddr);
+    }
+  }
+  for(i = 0; i < UIP_DS6_MADDR_NB; i++) {
+    if(uip_ds6_if.maddr_list[i].isused) {
+      dest_filter_add(&uip_ds6_if.maddr_list[i].ipaddr);
+    }
+  }
+#if UIP_DS6_AADDR_NB
+  for(i = 0; i < UIP_DS6_AADDR_NB; i++) {
+    if(uip_ds6_if.aaddr_list[i].isused) {
+      dest_filter_add(&uip_ds6_if.aaddr_list[i].ipaddr);
+    }
+  }
+#endif /* UIP_DS6_AADDR_NB */
+}
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
+
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_init(void)
@@ -102,6 +169,9 @@ uip_ds6_init(void)
      UIP_DS6_ADDR_NB, UIP_DS6_MADDR_NB, UIP_DS6_AADDR_NB);
   memset(uip_ds6_prefix_list, 0, sizeof(uip_ds6_prefix_list));
   memset(&uip_ds6_if, 0, sizeof(uip_ds6_if));
+#if UIP_DS6_DEST_FILTER_SIZE
+  memset(dest_filter, 0, sizeof(dest_filter));
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
   uip_ds6_addr_size = sizeof(struct uip_ds6_addr);
   uip_ds6_netif_addr_list_offset = offsetof(struct uip_ds6_netif, addr_list);
 
@@ -329,6 +399,9 @@ uip_ds6_addr_add(uip_ipaddr_t *ipaddr, unsigned long vlifetime, uint8_t type)
       (uip_ds6_element_t **)&locaddr) == FREESPACE) {
     locaddr->isused = 1;
     uip_ipaddr_copy(&locaddr->ipaddr, ipaddr);
+#if UIP_DS6_DEST_FILTER_SIZE
+    dest_filter_add(ipaddr);
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
     locaddr->type = type;
     if(vlifetime == 0) {
       locaddr->isinfinite = 1;
@@ -362,6 +435,9 @@ uip_ds6_addr_rm(uip_ds6_addr_t *addr)
       uip_ds6_maddr_rm(locmaddr);
     }
     addr->isused = 0;
+#if UIP_DS6_DEST_FILTER_SIZE
+    dest_filter_rebuild();
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
   }
   return;
 }
@@ -370,6 +446,11 @@ uip_ds6_addr_rm(uip_ds6_addr_t *addr)
 uip_ds6_addr_t *
 uip_ds6_addr_lookup(uip_ipaddr_t *ipaddr)
 {
+#if UIP_DS6_DEST_FILTER_SIZE
+  if(!dest_filter_check(ipaddr)) {
+    return NULL;
+  }
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
   if(uip_ds6_list_loop
      ((uip_ds6_element_t *)uip_ds6_if.addr_list, UIP_DS6_ADDR_NB,
       sizeof(uip_ds6_addr_t), ipaddr, 128,
@@ -427,6 +508,12 @@ uip_ds6_maddr_add(const uip_ipaddr_t *ipaddr)
       (uip_ds6_element_t **)&locmaddr) == FREESPACE) {
     locmaddr->isused = 1;
     uip_ipaddr_copy(&locmaddr->ipaddr, ipaddr);
+#if UIP_DS6_DEST_FILTER_SIZE
+    dest_filter_add(ipaddr);
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
+#if UIP_CONF_IPV6_MULTICAST
+    uip_mcast6_route_cache_flush();
+#endif
     return locmaddr;
   }
   return NULL;
@@ -438,6 +525,12 @@ uip_ds6_maddr_rm(uip_ds6_maddr_t *maddr)
 {
   if(maddr != NULL) {
     maddr->isused = 0;
+#if UIP_DS6_DEST_FILTER_SIZE
+    dest_filter_rebuild();
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
+#if UIP_CONF_IPV6_MULTICAST
+    uip_mcast6_route_cache_flush();
+#endif
   }
   return;
 }
@@ -446,6 +539,11 @@ uip_ds6_maddr_rm(uip_ds6_maddr_t *maddr)
 uip_ds6_maddr_t *
 uip_ds6_maddr_lookup(const uip_ipaddr_t *ipaddr)
 {
+#if UIP_DS6_DEST_FILTER_SIZE
+  if(!dest_filter_check(ipaddr)) {
+    return NULL;
+  }
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
   if(uip_ds6_list_loop
      ((uip_ds6_element_t *)uip_ds6_if.maddr_list, UIP_DS6_MADDR_NB,
       sizeof(uip_ds6_maddr_t), (void*)ipaddr, 128,
@@ -467,6 +565,9 @@ uip_ds6_aaddr_add(uip_ipaddr_t *ipaddr)
       (uip_ds6_element_t **)&locaaddr) == FREESPACE) {
     locaaddr->isused = 1;
     uip_ipaddr_copy(&locaaddr->ipaddr, ipaddr);
+#if UIP_DS6_DEST_FILTER_SIZE
+    dest_filter_add(ipaddr);
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
     return locaaddr;
   }
 #endif /* UIP_DS6_AADDR_NB */
@@ -479,6 +580,9 @@ uip_ds6_aaddr_rm(uip_ds6_aaddr_t *aaddr)
 {
   if(aaddr != NULL) {
     aaddr->isused = 0;
+#if UIP_DS6_DEST_FILTER_SIZE
+    dest_filter_rebuild();
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
   }
   return;
 }
@@ -488,6 +592,11 @@ uip_ds6_aaddr_t *
 uip_ds6_aaddr_lookup(uip_ipaddr_t *ipaddr)
 {
 #if UIP_DS6_AADDR_NB
+#if UIP_DS6_DEST_FILTER_SIZE
+  if(!dest_filter_check(ipaddr)) {
+    return NULL;
+  }
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
   if(uip_ds6_list_loop((uip_ds6_element_t *)uip_ds6_if.aaddr_list,
                        UIP_DS6_AADDR_NB, sizeof(uip_ds6_aaddr_t), ipaddr, 128,
                        (uip_ds6_element_t **)&locaaddr) == FOUND) {
@@ -497,6 +606,21 @@ uip_ds6_aaddr_lookup(uip_ipaddr_t *ipaddr)
   return NULL;
 }
 
+/*---------------------------------------------------------------------------*/
+uint8_t
+uip_ds6_is_my_dest(const uip_ipaddr_t *addr)
+{
+#if UIP_DS6_DEST_FILTER_SIZE
+  if(!dest_filter_check(addr)) {
+    return 0;
+  }
+#endif /* UIP_DS6_DEST_FILTER_SIZE */
+  if(uip_is_addr_mcast(addr)) {
+    return uip_ds6_maddr_lookup(addr) != NULL;
+  }
+  return uip_ds6_addr_lookup((uip_ipaddr_t *)addr) != NULL;
+}
+
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_select_src(uip_ipaddr_t *src, uip_ipaddr_t *dst)
@@ -119,6 +119,24 @@
 #define UIP_DS6_LL_NUD UIP_CONF_DS6_LL_NUD
 #endif
 
+/*--------------------------------------------------*/
+/**
+ * Size in bytes of the local destination filter, a small Bloom filter over
+ * the unicast, multicast and anycast addresses of the interface. Address
+ * lookups consult it first, so that datagrams which are not for us (e.g. when
+ * forwarding) are rejected without scanning the address lists. 0 disables
+ * the filter. Must be a power of two.
+ */
+#ifndef UIP_DS6_CONF_DEST_FILTER_SIZE
+#define UIP_DS6_DEST_FILTER_SIZE 0
+#else
+#define UIP_DS6_DEST_FILTER_SIZE UIP_DS6_CONF_DEST_FILTER_SIZE
+#endif
+
+#if (UIP_DS6_DEST_FILTER_SIZE & (UIP_DS6_DEST_FILTER_SIZE - 1)) != 0
+#error "UIP_DS6_CONF_DEST_FILTER_SIZE must be a power of two"
+#endif
+
 /** \brief Possible states for the an address  (RFC 4862) */
 #define ADDR_TENTATIVE 0
 #define ADDR_PREFERRED 1
@@ -347,6 +365,15 @@ uint32_t uip_ds6_compute_reachable_time(void); /** \brief compute random reachab
 #define uip_ds6_is_my_addr(addr)  (uip_ds6_addr_lookup(addr) != NULL)
 #define uip_ds6_is_my_maddr(addr) (uip_ds6_maddr_lookup(addr) != NULL)
 #define uip_ds6_is_my_aaddr(addr) (uip_ds6_aaddr_lookup(addr) != NULL)
+
+/**
+ * \brief Check whether an address is one of our unicast or multicast
+ * addresses
+ *
+ * Equivalent to uip_ds6_is_my_addr(addr) || uip_ds6_is_my_maddr(addr), but
+ * consults the destination filter only once. Used on the receive path.
+ */
+uint8_t uip_ds6_is_my_dest(const uip_ipaddr_t *addr);
 /** @} */
 /** @} */
 
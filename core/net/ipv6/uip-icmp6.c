@@ -45,6 +45,7 @@
 #include <string.h>
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/uip-icmp6.h"
+#include "net/nettrace.h"
 #include "contiki-default-conf.h"
 
 #define DEBUG 0
@@ -99,6 +100,8 @@ uip_icmp6_input(uint8_t type, uint8_t icode)
 {
   uip_icmp6_input_handler_t *handler = input_handler_lookup(type, icode);
 
+  NETTRACE(ICMP6_IN, type, NETTRACE_ID_FROM_IPADDR(&UIP_IP_BUF->srcipaddr),
+           0, icode, 0);
   if(handler == NULL) {
     return UIP_ICMP6_INPUT_ERROR;
   }
@@ -294,6 +297,7 @@ uip_icmp6_error_output(uint8_t type, uint8_t code, uint32_t param) {
 void
 uip_icmp6_send(const uip_ipaddr_t *dest, int type, int code, int payload_len)
 {
+  NETTRACE(ICMP6_OUT, type, NETTRACE_ID_FROM_IPADDR(dest), 0, code, 0);
 
   UIP_IP_BUF->vtc = 0x60;
   UIP_IP_BUF->tcflow = 0;
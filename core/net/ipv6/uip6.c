@@ -177,6 +177,9 @@ uint8_t uip_ext_opt_offset = 0;
 #ifndef UIP_CONF_EXTERNAL_BUFFER
 uip_buf_t uip_aligned_buf;
 #endif /* UIP_CONF_EXTERNAL_BUFFER */
+#if UIP_PACKET_BUFS > 1
+uip_buf_t *uip_bufp = &uip_aligned_buf;
+#endif /* UIP_PACKET_BUFS > 1 */
 
 /* The uip_appdata pointer points to application data. */
 void *uip_appdata;
@@ -273,6 +276,59 @@ struct uip_udp_conn uip_udp_conns[UIP_UDP_CONNS];
 #endif /* UIP_UDP */
 /** @} */
 
+/*---------------------------------------------------------------------------*/
+/**
+ * \name Connection demultiplexing
+ * @{
+ */
+/*---------------------------------------------------------------------------*/
+#if UIP_DEMUX_BUCKETS
+/*
+ * The connections are chained by their index in the connection tables.
+ * TCP connections are hashed on their address and ports when they are
+ * set up, and stay in their chain until the connection is reused, so a
+ * lookup skips closed ones. UDP connections and listening ports are
+ * hashed on the local port, and kept in the order of the tables so
+ * that the first matching UDP connection is the same as in a search
+ * through the table. Open TCP connections are also kept on a list for
+ * the periodic processing, from which closed ones are dropped as they
+ * are found.
+ */
+/* Like c, an index fits in a byte */
+typedef uint8_t demux_index_t;
+#define DEMUX_NONE 0xff
+
+#if UIP_DEMUX_BUCKETS & (UIP_DEMUX_BUCKETS - 1)
+#error UIP_CONF_DEMUX_BUCKETS must be a power of two
+#endif
+#if UIP_CONNS >= DEMUX_NONE || UIP_UDP_CONNS >= DEMUX_NONE || \
+    UIP_LISTENPORTS >= DEMUX_NONE
+#error Too many connections for UIP_CONF_DEMUX_BUCKETS
+#endif
+
+#define DEMUX_PORT_HASH(port) \
+  (((port) ^ ((port) >> 8)) & (UIP_DEMUX_BUCKETS - 1))
+
+#if UIP_TCP
+#define TCP_HASHED 0x01
+#define TCP_ACTIVE 0x02
+
+static demux_index_t tcp_head[UIP_DEMUX_BUCKETS];
+static demux_index_t tcp_next[UIP_CONNS];
+static demux_index_t active_head;
+static demux_index_t active_next[UIP_CONNS];
+static uint8_t tcp_flags[UIP_CONNS];
+static demux_index_t listen_head[UIP_DEMUX_BUCKETS];
+static demux_index_t listen_next[UIP_LISTENPORTS];
+#endif /* UIP_TCP */
+
+#if UIP_UDP
+static demux_index_t udp_head[UIP_DEMUX_BUCKETS];
+static demux_index_t udp_next[UIP_UDP_CONNS];
+#endif /* UIP_UDP */
+#endif /* UIP_DEMUX_BUCKETS */
+/** @} */
+
 /*---------------------------------------------------------------------------*/
 /**
  * \name ICMPv6 variables
@@ -429,6 +485,154 @@ uip_udpchksum(void)
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
 #endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
+#if UIP_DEMUX_BUCKETS
+static void
+demux_init(void)
+{
+  /* All bits set is DEMUX_NONE */
+#if UIP_TCP
+  memset(&tcp_head, 0xff, sizeof(tcp_head));
+  memset(&listen_head, 0xff, sizeof(listen_head));
+  memset(&tcp_flags, 0, sizeof(tcp_flags));
+  active_head = DEMUX_NONE;
+#endif /* UIP_TCP */
+#if UIP_UDP
+  memset(&udp_head, 0xff, sizeof(udp_head));
+#endif /* UIP_UDP */
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP
+static uint16_t
+tcp_hash(uint16_t lport, uint16_t rport, const uip_ipaddr_t *ripaddr)
+{
+  uint16_t h;
+
+  /* The interface identifier differs the most between peers */
+  h = lport ^ rport ^ ripaddr->u16[7] ^ ripaddr->u16[6] ^ ripaddr->u16[5];
+  return (h ^ (h >> 8)) & (UIP_DEMUX_BUCKETS - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Unhashes a connection that is about to be set up again */
+static void
+tcp_unhash(struct uip_conn *conn)
+{
+  demux_index_t i, *link;
+
+  i = conn - uip_conns;
+  if(!(tcp_flags[i] & TCP_HASHED)) {
+    return;
+  }
+  tcp_flags[i] &= ~TCP_HASHED;
+  for(link = &tcp_head[tcp_hash(conn->lport, conn->rport, &conn->ripaddr)];
+      *link != DEMUX_NONE; link = &tcp_next[*link]) {
+    if(*link == i) {
+      *link = tcp_next[i];
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Hashes a connection that has been set up, and makes it active */
+static void
+tcp_hash_add(struct uip_conn *conn)
+{
+  demux_index_t i;
+  uint16_t h;
+
+  i = conn - uip_conns;
+  h = tcp_hash(conn->lport, conn->rport, &conn->ripaddr);
+  tcp_next[i] = tcp_head[h];
+  tcp_head[h] = i;
+  tcp_flags[i] |= TCP_HASHED;
+
+  if(!(tcp_flags[i] & TCP_ACTIVE)) {
+    active_next[i] = active_head;
+    active_head = i;
+    tcp_flags[i] |= TCP_ACTIVE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct uip_conn *
+tcp_lookup(void)
+{
+  struct uip_conn *conn;
+  demux_index_t i;
+
+  for(i = tcp_head[tcp_hash(UIP_TCP_BUF->destport, UIP_TCP_BUF->srcport,
+                            &UIP_IP_BUF->srcipaddr)];
+      i != DEMUX_NONE; i = tcp_next[i]) {
+    conn = &uip_conns[i];
+    if(conn->tcpstateflags != UIP_CLOSED &&
+       UIP_TCP_BUF->destport == conn->lport &&
+       UIP_TCP_BUF->srcport == conn->rport &&
+       uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &conn->ripaddr)) {
+      return conn;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+struct uip_conn *
+uip_active_conn_next(struct uip_conn *conn)
+{
+  demux_index_t i, *link;
+
+  link = conn == NULL ? &active_head : &active_next[conn - uip_conns];
+  while((i = *link) != DEMUX_NONE) {
+    if(uip_conns[i].tcpstateflags != UIP_CLOSED) {
+      return &uip_conns[i];
+    }
+    /* Closed since it was last visited */
+    *link = active_next[i];
+    tcp_flags[i] &= ~TCP_ACTIVE;
+  }
+  return NULL;
+}
+#endif /* UIP_TCP */
+/*---------------------------------------------------------------------------*/
+#if UIP_UDP
+/* Chains a UDP connection under its local port, in table order */
+static void
+udp_hash_add(struct uip_udp_conn *conn)
+{
+  demux_index_t i, *link;
+
+  i = conn - uip_udp_conns;
+  for(link = &udp_head[DEMUX_PORT_HASH(conn->lport)];
+      *link != DEMUX_NONE && *link < i; link = &udp_next[*link]);
+  udp_next[i] = *link;
+  *link = i;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_unhash(struct uip_udp_conn *conn)
+{
+  demux_index_t i, *link;
+
+  i = conn - uip_udp_conns;
+  for(link = &udp_head[DEMUX_PORT_HASH(conn->lport)];
+      *link != DEMUX_NONE; link = &udp_next[*link]) {
+    if(*link == i) {
+      *link = udp_next[i];
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_bind_port(struct uip_udp_conn *conn, uint16_t port)
+{
+  if(conn->lport != 0) {
+    udp_unhash(conn);
+  }
+  conn->lport = port;
+  if(port != 0) {
+    udp_hash_add(conn);
+  }
+}
+#endif /* UIP_UDP */
+#endif /* UIP_DEMUX_BUCKETS */
+/*---------------------------------------------------------------------------*/
 void
 uip_init(void)
 {
@@ -456,6 +660,10 @@ uip_init(void)
   }
 #endif /* UIP_UDP */
 
+#if UIP_DEMUX_BUCKETS
+  demux_init();
+#endif /* UIP_DEMUX_BUCKETS */
+
 #if UIP_CONF_IPV6_MULTICAST
   UIP_MCAST6.init();
 #endif
@@ -504,6 +712,10 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
     return 0;
   }
 
+#if UIP_DEMUX_BUCKETS
+  tcp_unhash(conn);
+#endif /* UIP_DEMUX_BUCKETS */
+
   conn->tcpstateflags = UIP_SYN_SENT;
 
   conn->snd_nxt[0] = iss[0];
@@ -528,6 +740,10 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
 
+#if UIP_DEMUX_BUCKETS
+  tcp_hash_add(conn);
+#endif /* UIP_DEMUX_BUCKETS */
+
   return conn;
 }
 #endif /* UIP_TCP && UIP_ACTIVE_OPEN */
@@ -570,7 +786,12 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
     lastport = 4096;
   }
 
+#if UIP_DEMUX_BUCKETS
+  for(c = udp_head[DEMUX_PORT_HASH(uip_htons(lastport))]; c != DEMUX_NONE;
+      c = udp_next[c]) {
+#else /* UIP_DEMUX_BUCKETS */
   for(c = 0; c < UIP_UDP_CONNS; ++c) {
+#endif /* UIP_DEMUX_BUCKETS */
     if(uip_udp_conns[c].lport == uip_htons(lastport)) {
       goto again;
     }
@@ -588,7 +809,11 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
     return 0;
   }
 
+#if UIP_DEMUX_BUCKETS
+  uip_udp_bind_port(conn, UIP_HTONS(lastport));
+#else /* UIP_DEMUX_BUCKETS */
   conn->lport = UIP_HTONS(lastport);
+#endif /* UIP_DEMUX_BUCKETS */
   conn->rport = rport;
   if(ripaddr == NULL) {
     memset(&conn->ripaddr, 0, sizeof(uip_ipaddr_t));
@@ -605,12 +830,25 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
 void
 uip_unlisten(uint16_t port)
 {
+#if UIP_DEMUX_BUCKETS
+  demux_index_t *link;
+
+  for(link = &listen_head[DEMUX_PORT_HASH(port)]; *link != DEMUX_NONE;
+      link = &listen_next[*link]) {
+    if(uip_listenports[*link] == port) {
+      uip_listenports[*link] = 0;
+      *link = listen_next[*link];
+      return;
+    }
+  }
+#else /* UIP_DEMUX_BUCKETS */
   for(c = 0; c < UIP_LISTENPORTS; ++c) {
     if(uip_listenports[c] == port) {
       uip_listenports[c] = 0;
       return;
     }
   }
+#endif /* UIP_DEMUX_BUCKETS */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -619,6 +857,10 @@ uip_listen(uint16_t port)
   for(c = 0; c < UIP_LISTENPORTS; ++c) {
     if(uip_listenports[c] == 0) {
       uip_listenports[c] = port;
+#if UIP_DEMUX_BUCKETS
+      listen_next[c] = listen_head[DEMUX_PORT_HASH(port)];
+      listen_head[DEMUX_PORT_HASH(port)] = c;
+#endif /* UIP_DEMUX_BUCKETS */
       return;
     }
   }
@@ -850,6 +1092,36 @@ uip_add_rcv_nxt(uint16_t n)
   uip_conn->rcv_nxt[2] = uip_acc32[2];
   uip_conn->rcv_nxt[3] = uip_acc32[3];
 }
+#if UIP_TCP_WINDOWED
+/*---------------------------------------------------------------------------*/
+/* The number of bytes from sequence number b up to sequence number a */
+static uint32_t
+uip_seqdiff(const uint8_t *a, const uint8_t *b)
+{
+  return (((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) |
+          ((uint32_t)a[2] << 8) | a[3]) -
+    (((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) |
+     ((uint32_t)b[2] << 8) | b[3]);
+}
+/*---------------------------------------------------------------------------*/
+/* On a windowed connection, the MSS is what still fits in the window
+   of the remote host next to the data in flight. */
+static void
+uip_windowed_mss(struct uip_conn *conn)
+{
+  uint16_t room;
+
+  if(conn->snd_wnd == 0 && conn->len == 0) {
+    /* Zero window: probe with a full segment, as for other connections */
+    room = conn->initialmss;
+  } else if(conn->snd_wnd > conn->len) {
+    room = conn->snd_wnd - conn->len;
+  } else {
+    room = 0;
+  }
+  conn->mss = room > conn->initialmss ? conn->initialmss : room;
+}
+#endif /* UIP_TCP_WINDOWED */
 #endif
 /*---------------------------------------------------------------------------*/
 
@@ -955,8 +1227,10 @@ uip_process(uint8_t flag)
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
-       !uip_outstanding(uip_connr)) {
+       (!uip_outstanding(uip_connr) ||
+        (uip_connr->tcpstateflags & UIP_WINDOWED))) {
       uip_flags = UIP_POLL;
+      uip_slen = 0;
       UIP_APPCALL();
       goto appsend;
 #if UIP_ACTIVE_OPEN
@@ -1203,8 +1477,7 @@ uip_process(uint8_t flag)
 #endif /* UIP_IPV6_CONF_MULTICAST */
 
   /* TBD Some Parameter problem messages */
-  if(!uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) &&
-     !uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr)) {
+  if(!uip_ds6_is_my_dest(&UIP_IP_BUF->destipaddr)) {
     if(!uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) &&
        !uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) &&
        !uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) &&
@@ -1257,8 +1530,7 @@ uip_process(uint8_t flag)
     }
   }
 #else /* UIP_CONF_ROUTER */
-  if(!uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) &&
-     !uip_ds6_is_my_maddr(&UIP_IP_BUF->destipaddr) &&
+  if(!uip_ds6_is_my_dest(&UIP_IP_BUF->destipaddr) &&
      !uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
     PRINTF("Dropping packet, not for me\n");
     UIP_STAT(++uip_stat.ip.drop);
@@ -1506,9 +1778,15 @@ uip_process(uint8_t flag)
   }
 
   /* Demultiplex this UDP packet between the UDP "connections". */
+#if UIP_DEMUX_BUCKETS
+  for(c = udp_head[DEMUX_PORT_HASH(UIP_UDP_BUF->destport)];
+      c != DEMUX_NONE; c = udp_next[c]) {
+    uip_udp_conn = &uip_udp_conns[c];
+#else /* UIP_DEMUX_BUCKETS */
   for(uip_udp_conn = &uip_udp_conns[0];
       uip_udp_conn < &uip_udp_conns[UIP_UDP_CONNS];
       ++uip_udp_conn) {
+#endif /* UIP_DEMUX_BUCKETS */
     /* If the local UDP port is non-zero, the connection is considered
        to be used. If so, the local port number is checked against the
        destination port number in the received packet. If the two port
@@ -1615,6 +1893,12 @@ uip_process(uint8_t flag)
 
   /* Demultiplex this segment. */
   /* First check any active connections. */
+#if UIP_DEMUX_BUCKETS
+  uip_connr = tcp_lookup();
+  if(uip_connr != NULL) {
+    goto found;
+  }
+#else /* UIP_DEMUX_BUCKETS */
   for(uip_connr = &uip_conns[0]; uip_connr <= &uip_conns[UIP_CONNS - 1];
       ++uip_connr) {
     if(uip_connr->tcpstateflags != UIP_CLOSED &&
@@ -1624,6 +1908,7 @@ uip_process(uint8_t flag)
       goto found;
     }
   }
+#endif /* UIP_DEMUX_BUCKETS */
 
   /* If we didn't find and active connection that expected the packet,
      either this packet is an old duplicate, or this is a SYN packet
@@ -1635,7 +1920,12 @@ uip_process(uint8_t flag)
 
   tmp16 = UIP_TCP_BUF->destport;
   /* Next, check listening connections. */
+#if UIP_DEMUX_BUCKETS
+  for(c = listen_head[DEMUX_PORT_HASH(tmp16)]; c != DEMUX_NONE;
+      c = listen_next[c]) {
+#else /* UIP_DEMUX_BUCKETS */
   for(c = 0; c < UIP_LISTENPORTS; ++c) {
+#endif /* UIP_DEMUX_BUCKETS */
     if(tmp16 == uip_listenports[c]) {
       goto found_listen;
     }
@@ -1731,6 +2021,10 @@ uip_process(uint8_t flag)
   }
   uip_conn = uip_connr;
 
+#if UIP_DEMUX_BUCKETS
+  tcp_unhash(uip_connr);
+#endif /* UIP_DEMUX_BUCKETS */
+
   /* Fill in the necessary fields for the new connection. */
   uip_connr->rto = uip_connr->timer = UIP_RTO;
   uip_connr->sa = 0;
@@ -1740,6 +2034,9 @@ uip_process(uint8_t flag)
   uip_connr->rport = UIP_TCP_BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF->srcipaddr);
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
+#if UIP_DEMUX_BUCKETS
+  tcp_hash_add(uip_connr);
+#endif /* UIP_DEMUX_BUCKETS */
 
   uip_connr->snd_nxt[0] = iss[0];
   uip_connr->snd_nxt[1] = iss[1];
@@ -1899,9 +2196,28 @@ uip_process(uint8_t flag)
       /* Reset length of outstanding data. */
       uip_connr->len = 0;
     }
-
+#if UIP_TCP_WINDOWED
+    else if(uip_connr->tcpstateflags & UIP_WINDOWED) {
+      /* A windowed connection has several segments in flight, which
+         may be acknowledged one at a time. */
+      uint32_t acked = uip_seqdiff(UIP_TCP_BUF->ackno, uip_connr->snd_nxt);
+      if(acked > 0 && acked < uip_connr->len) {
+        uip_connr->snd_nxt[0] = UIP_TCP_BUF->ackno[0];
+        uip_connr->snd_nxt[1] = UIP_TCP_BUF->ackno[1];
+        uip_connr->snd_nxt[2] = UIP_TCP_BUF->ackno[2];
+        uip_connr->snd_nxt[3] = UIP_TCP_BUF->ackno[3];
+        uip_connr->len -= acked;
+        uip_flags = UIP_ACKDATA;
+        uip_connr->timer = uip_connr->rto;
+      }
+    }
+#endif /* UIP_TCP_WINDOWED */
   }
 
+#if UIP_TCP_WINDOWED
+  uip_connr->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + (uint16_t)UIP_TCP_BUF->wnd[1];
+#endif /* UIP_TCP_WINDOWED */
+
   /* Do different things depending on in what state the connection is. */
   switch(uip_connr->tcpstateflags & UIP_TS_MASK) {
     /* CLOSED and LISTEN are not handled here. CLOSE_WAIT is not
@@ -2071,6 +2387,11 @@ uip_process(uint8_t flag)
         tmp16 = uip_connr->initialmss;
       }
       uip_connr->mss = tmp16;
+#if UIP_TCP_WINDOWED
+      if(uip_connr->tcpstateflags & UIP_WINDOWED) {
+        uip_windowed_mss(uip_connr);
+      }
+#endif /* UIP_TCP_WINDOWED */
 
       /* If this packet constitutes an ACK for outstanding data (flagged
          by the UIP_ACKDATA flag, we should call the application since it
@@ -2111,6 +2432,17 @@ uip_process(uint8_t flag)
         }
 
         /* If uip_slen > 0, the application has data to be sent. */
+#if UIP_TCP_WINDOWED
+        if(uip_slen > 0 && (uip_connr->tcpstateflags & UIP_WINDOWED)) {
+          /* New data is sent behind the data in flight, as far as the
+             window of the remote host allows. */
+          if(uip_slen > uip_connr->mss) {
+            uip_slen = uip_connr->mss;
+          }
+          uip_connr->len += uip_slen;
+          uip_windowed_mss(uip_connr);
+        } else
+#endif /* UIP_TCP_WINDOWED */
         if(uip_slen > 0) {
 
           /* If the connection has acknowledged data, the contents of
@@ -2151,6 +2483,16 @@ uip_process(uint8_t flag)
         if(uip_slen > 0 && uip_connr->len > 0) {
           /* Add the length of the IP and TCP headers. */
           uip_len = uip_connr->len + UIP_TCPIP_HLEN;
+#if UIP_TCP_WINDOWED
+          if(uip_connr->tcpstateflags & UIP_WINDOWED) {
+            /* Only the new segment, or the oldest one when
+               retransmitting, goes out. */
+            if(uip_slen > uip_connr->len) {
+              uip_slen = uip_connr->len;
+            }
+            uip_len = uip_slen + UIP_TCPIP_HLEN;
+          }
+#endif /* UIP_TCP_WINDOWED */
           /* We always set the ACK flag in response packets. */
           UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
           /* Send the packet. */
@@ -2259,6 +2601,20 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
   UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
   UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#if UIP_TCP_WINDOWED
+  if((uip_connr->tcpstateflags & UIP_WINDOWED) &&
+     (uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+     !(uip_flags & UIP_REXMIT)) {
+    /* Anything but a retransmission starts after the data in flight;
+       a new segment has already been counted in ->len. */
+    uip_add32(uip_connr->snd_nxt,
+              uip_connr->len - (uip_len - UIP_TCPIP_HLEN));
+    UIP_TCP_BUF->seqno[0] = uip_acc32[0];
+    UIP_TCP_BUF->seqno[1] = uip_acc32[1];
+    UIP_TCP_BUF->seqno[2] = uip_acc32[2];
+    UIP_TCP_BUF->seqno[3] = uip_acc32[3];
+  }
+#endif /* UIP_TCP_WINDOWED */
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
   UIP_TCP_BUF->destport = uip_connr->rport;
@@ -49,6 +49,13 @@
 /* This node's current frame counter value */
 static uint32_t counter;
 
+#if ANTI_REPLAY_STATS
+struct anti_replay_stats anti_replay_stats;
+#define STATS_ADD(x) anti_replay_stats.x++
+#else /* ANTI_REPLAY_STATS */
+#define STATS_ADD(x)
+#endif /* ANTI_REPLAY_STATS */
+
 /*---------------------------------------------------------------------------*/
 void
 anti_replay_set_counter(void)
@@ -79,7 +86,57 @@ anti_replay_init_info(struct anti_replay_info *info)
   info->last_broadcast_counter
       = info->last_unicast_counter
       = anti_replay_get_counter();
+#if ANTI_REPLAY_WINDOW
+  info->broadcast_window = info->unicast_window = 1;
+#endif /* ANTI_REPLAY_WINDOW */
+}
+/*---------------------------------------------------------------------------*/
+#if ANTI_REPLAY_WINDOW
+static int
+was_replayed(uint32_t received_counter,
+    uint32_t *last_counter, anti_replay_window_t *window)
+{
+  uint32_t diff;
+  
+  if(received_counter > *last_counter) {
+    /* slide the window up to the new counter */
+    diff = received_counter - *last_counter;
+    if(diff < ANTI_REPLAY_WINDOW) {
+      *window = (*window << diff) | 1;
+    } else {
+      *window = 1;
+    }
+    *last_counter = received_counter;
+    STATS_ADD(in_order);
+    return 0;
+  }
+  
+  diff = *last_counter - received_counter;
+  if(diff >= ANTI_REPLAY_WINDOW) {
+    STATS_ADD(too_old);
+    return 1;
+  }
+  if(*window & ((anti_replay_window_t)1 << diff)) {
+    STATS_ADD(replayed);
+    return 1;
+  }
+  *window |= (anti_replay_window_t)1 << diff;
+  STATS_ADD(reordered);
+  return 0;
+}
+#else /* ANTI_REPLAY_WINDOW */
+static int
+was_replayed(uint32_t received_counter, uint32_t *last_counter)
+{
+  if(received_counter <= *last_counter) {
+    STATS_ADD(replayed);
+    return 1;
+  }
+  *last_counter = received_counter;
+  STATS_ADD(in_order);
+  return 0;
 }
+#endif /* ANTI_REPLAY_WINDOW */
 /*---------------------------------------------------------------------------*/
 int
 anti_replay_was_replayed(struct anti_replay_info *info)
@@ -90,20 +147,20 @@ anti_replay_was_replayed(struct anti_replay_info *info)
   
   if(packetbuf_holds_broadcast()) {
     /* broadcast */
-    if(received_counter <= info->last_broadcast_counter) {
-      return 1;
-    } else {
-      info->last_broadcast_counter = received_counter;
-      return 0;
-    }
+#if ANTI_REPLAY_WINDOW
+    return was_replayed(received_counter,
+        &info->last_broadcast_counter, &info->broadcast_window);
+#else /* ANTI_REPLAY_WINDOW */
+    return was_replayed(received_counter, &info->last_broadcast_counter);
+#endif /* ANTI_REPLAY_WINDOW */
   } else {
     /* unicast */
-    if(received_counter <= info->last_unicast_counter) {
-      return 1;
-    } else {
-      info->last_unicast_counter = received_counter;
-      return 0;
-    }
+#if ANTI_REPLAY_WINDOW
+    return was_replayed(received_counter,
+        &info->last_unicast_counter, &info->unicast_window);
+#else /* ANTI_REPLAY_WINDOW */
+    return was_replayed(received_counter, &info->last_unicast_counter);
+#endif /* ANTI_REPLAY_WINDOW */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -47,11 +47,61 @@
 
 #include "contiki.h"
 
+/**
+ * Number of frame counters below the highest one seen from a neighbor
+ * within which a frame is still accepted, provided that its counter
+ * has not been seen before. This lets frames through that were
+ * reordered by retransmissions or TSCH's channel hopping. At most 64;
+ * 0 accepts increasing counters only.
+ */
+#ifdef ANTI_REPLAY_CONF_WINDOW
+#define ANTI_REPLAY_WINDOW ANTI_REPLAY_CONF_WINDOW
+#else /* ANTI_REPLAY_CONF_WINDOW */
+#define ANTI_REPLAY_WINDOW 32
+#endif /* ANTI_REPLAY_CONF_WINDOW */
+
+#ifdef ANTI_REPLAY_CONF_STATS
+#define ANTI_REPLAY_STATS ANTI_REPLAY_CONF_STATS
+#else /* ANTI_REPLAY_CONF_STATS */
+#define ANTI_REPLAY_STATS 0
+#endif /* ANTI_REPLAY_CONF_STATS */
+
+#if ANTI_REPLAY_WINDOW > 64
+#error ANTI_REPLAY_WINDOW must be at most 64
+#elif ANTI_REPLAY_WINDOW > 32
+typedef uint64_t anti_replay_window_t;
+#elif ANTI_REPLAY_WINDOW > 16
+typedef uint32_t anti_replay_window_t;
+#else
+typedef uint16_t anti_replay_window_t;
+#endif
+
 struct anti_replay_info {
   uint32_t last_broadcast_counter;
   uint32_t last_unicast_counter;
+#if ANTI_REPLAY_WINDOW
+  /* Bit i is set if last_..._counter - i has been received */
+  anti_replay_window_t broadcast_window;
+  anti_replay_window_t unicast_window;
+#endif /* ANTI_REPLAY_WINDOW */
+};
+
+#if ANTI_REPLAY_STATS
+struct anti_replay_stats {
+  /** Frames with a higher counter than any before */
+  uint32_t in_order;
+  /** Frames accepted within the window, which accepting increasing
+      counters only would have rejected */
+  uint32_t reordered;
+  /** Frames whose counter was already seen */
+  uint32_t replayed;
+  /** Frames below the window, rejected although possibly fresh */
+  uint32_t too_old;
 };
 
+extern struct anti_replay_stats anti_replay_stats;
+#endif /* ANTI_REPLAY_STATS */
+
 /**
  * \brief Sets the frame counter packetbuf attributes.
  */
@@ -69,7 +119,8 @@ uint32_t anti_replay_get_counter(void);
 void anti_replay_init_info(struct anti_replay_info *info);
 
 /**
- * \brief               Checks if received frame was replayed
+ * \brief               Checks if received frame was replayed, and if
+ *                      not, records its frame counter
  * \param info          Anti-replay information about the sender
  * \retval 0            <-> received frame was not replayed
  */
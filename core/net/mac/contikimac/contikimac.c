@@ -112,6 +112,17 @@ static int we_are_receiving_burst = 0;
 #define INTER_PACKET_DEADLINE               CLOCK_SECOND / 32
 #endif
 
+/* MAX_BURST is the maximum number of frames that are sent back-to-back
+   after a single rendezvous with the receiver. The burst length follows
+   the depth of the queue handed to us by the MAC layer, up to this
+   limit; longer queues are split over several bursts so that other
+   senders get a chance to access the channel in between. */
+#ifdef CONTIKIMAC_CONF_MAX_BURST
+#define MAX_BURST                           CONTIKIMAC_CONF_MAX_BURST
+#else
+#define MAX_BURST                           16
+#endif
+
 /* ContikiMAC performs periodic channel checks. Each channel check
    consists of two or more CCA checks. CCA_COUNT_MAX is the number of
    CCAs to be done for each periodic channel check. The default is
@@ -634,8 +645,11 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   }
   
   /* Switch off the radio to ensure that we didn't start sending while
-     the radio was doing a channel check. */
-  off();
+     the radio was doing a channel check. Within a burst, the radio was
+     left on to receive the ack of the previous frame, and stays on. */
+  if(is_receiver_awake == 0) {
+    off();
+  }
 
 
   strobes = 0;
@@ -767,7 +781,12 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
     }
   }
 
-  off();
+  /* Keep the radio on between the frames of a burst: the next frame
+     follows right away and expects an ack. qsend_list() turns the radio
+     off when the burst ends. */
+  if(!got_strobe_ack || !packetbuf_attr(PACKETBUF_ATTR_PENDING)) {
+    off();
+  }
 
   PRINTF("contikimac: send (strobes=%u, len=%u, %s, %s), done\n", strobes,
          packetbuf_totlen(),
@@ -812,6 +831,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
 
   if(!is_broadcast) {
     if(collisions == 0 && is_receiver_awake == 0) {
+      phase_record_strobes(is_known_receiver, strobes, ret);
       phase_update(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
 		   encounter_time, ret);
     }
@@ -838,6 +858,9 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
   int ret;
   int is_receiver_awake;
   int pending;
+  int radio_held;
+  int burst_len;
+  int i;
   
   if(buf_list == NULL) {
     return;
@@ -851,16 +874,24 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
     return;
   }
   
-  /* Create and secure frames in advance */
+  /* Everything that is queued for this receiver goes out after a
+     single rendezvous, up to MAX_BURST frames */
+  burst_len = 0;
+  for(curr = buf_list; curr != NULL && burst_len < MAX_BURST;
+      curr = list_item_next(curr)) {
+    burst_len++;
+  }
+
+  /* Create and secure the frames of the burst in advance, so that they
+     can be sent back-to-back. All but the last have FRAME_PENDING set,
+     which keeps the receiver awake for the next one. */
   curr = buf_list;
-  do {
+  for(i = 0; i < burst_len; i++) {
     next = list_item_next(curr);
     queuebuf_to_packetbuf(curr->buf);
     if(!packetbuf_attr(PACKETBUF_ATTR_IS_CREATED_AND_SECURED)) {
       /* create and secure this frame */
-      if(next != NULL) {
-        packetbuf_set_attr(PACKETBUF_ATTR_PENDING, 1);
-      }
+      packetbuf_set_attr(PACKETBUF_ATTR_PENDING, i < burst_len - 1);
       packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, 1);
       if(NETSTACK_FRAMER.create() < 0) {
         PRINTF("contikimac: framer failed\n");
@@ -872,13 +903,18 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
       queuebuf_update_from_packetbuf(curr->buf);
     }
     curr = next;
-  } while(next != NULL);
-  
+  }
+
   /* The receiver needs to be awoken before we send */
   is_receiver_awake = 0;
+  radio_held = 0;
   curr = buf_list;
+  i = 0;
   do { /* A loop sending a burst of packets from buf_list */
     next = list_item_next(curr);
+    if(++i >= burst_len) {
+      next = NULL;
+    }
 
     /* Prepare the packetbuf */
     queuebuf_to_packetbuf(curr->buf);
@@ -887,6 +923,9 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 
     /* Send the current packet */
     ret = send_packet(sent, ptr, curr, is_receiver_awake);
+    /* A frame with FRAME_PENDING may leave the radio on for the next
+       one, whatever send_packet() returns */
+    radio_held |= pending;
     if(ret != MAC_TX_DEFERRED) {
       mac_call_sent_callback(sent, ptr, ret, 1);
     }
@@ -902,6 +941,12 @@ qsend_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
       next = NULL;
     }
   } while((next != NULL) && pending);
+
+  /* The radio may have been left on for a next frame that we did not
+     send, or by a frame that failed within the burst */
+  if(radio_held) {
+    off();
+  }
 }
 /*---------------------------------------------------------------------------*/
 /* Timer callback triggered when receiving a burst, after having
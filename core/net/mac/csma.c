@@ -47,6 +47,7 @@
 #include "lib/random.h"
 
 #include "net/netstack.h"
+#include "net/nettrace.h"
 
 #include "lib/list.h"
 #include "lib/memb.h"
@@ -218,6 +219,8 @@ packet_sent(void *ptr, int status, int num_transmissions)
   if(n == NULL) {
     return;
   }
+  NETTRACE(MAC_TX, status, NETTRACE_ID_FROM_LINKADDR(&n->addr), 0,
+           packetbuf_totlen(), num_transmissions);
   switch(status) {
   case MAC_TX_OK:
   case MAC_TX_NOACK:
@@ -50,10 +50,35 @@
 #define PHASE_DRIFT_CORRECT 0
 #endif
 
+/*
+ * With drift correction, each neighbor gets a linear phase model: the
+ * phase observed at the last encounter plus a skew, the estimated phase
+ * drift per wake-up cycle. The skew is kept in fixed point, in units of
+ * 1/PHASE_SKEW_SCALE rtimer ticks per cycle, and is refined after every
+ * acknowledged transmission from the prediction error. The mean absolute
+ * prediction error is used to shrink the guard time for neighbors whose
+ * wake-ups we predict well.
+ */
+#define PHASE_SKEW_SCALE      64
+
+/* Gain of the skew and jitter estimators, as a right shift */
+#define PHASE_SKEW_GAIN       2
+#define PHASE_JITTER_GAIN     2
+
+/* Encounters that are further apart than this are not used to estimate
+   the skew: the phase error could have wrapped around a full cycle. */
+#define PHASE_MAX_CYCLES      4096
+
+/* Number of skew samples needed before the guard time is adapted */
+#define PHASE_MIN_SAMPLES     2
+
 struct phase {
   rtimer_clock_t time;
 #if PHASE_DRIFT_CORRECT
-  rtimer_clock_t drift;
+  clock_time_t last;
+  int16_t skew;
+  uint16_t jitter;
+  uint8_t samples;
 #endif
   uint8_t noacks;
   struct timer noacks_timer;
@@ -77,6 +102,15 @@ struct phase_queueitem {
 MEMB(queued_packets_memb, struct phase_queueitem, PHASE_QUEUESIZE);
 NBR_TABLE(struct phase, nbr_phase);
 
+#if PHASE_DRIFT_CORRECT
+/* The cycle time of the duty cycling protocol, as last given to phase_wait() */
+static rtimer_clock_t phase_cycle_time;
+#endif
+
+#if PHASE_STATS
+struct phase_stats phase_stats;
+#endif
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -87,6 +121,94 @@ NBR_TABLE(struct phase, nbr_phase);
 #define PRINTDEBUG(...)
 #endif
 /*---------------------------------------------------------------------------*/
+#if PHASE_DRIFT_CORRECT
+/* Number of wake-up cycles of the neighbor since we last encountered it */
+static uint16_t
+cycles_since(struct phase *e, rtimer_clock_t cycle_time)
+{
+  unsigned long elapsed;
+
+  elapsed = ((unsigned long)(clock_time_t)(clock_time() - e->last) *
+             RTIMER_ARCH_SECOND) / CLOCK_SECOND;
+  elapsed = (elapsed + cycle_time / 2) / cycle_time;
+  return elapsed > PHASE_MAX_CYCLES ? PHASE_MAX_CYCLES + 1 : elapsed;
+}
+/*---------------------------------------------------------------------------*/
+/* Predicted drift over a number of cycles, in rtimer ticks */
+static int32_t
+predicted_drift(struct phase *e, uint16_t cycles)
+{
+  return ((int32_t)e->skew * cycles) / PHASE_SKEW_SCALE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_model(struct phase *e, rtimer_clock_t time)
+{
+  rtimer_clock_t cycle_time = phase_cycle_time;
+  unsigned long coarse, elapsed;
+  uint16_t cycles;
+  int32_t err;
+  int32_t skew;
+
+  if(cycle_time == 0) {
+    return;
+  }
+
+  cycles = cycles_since(e, cycle_time);
+  if(cycles == 0 || cycles > PHASE_MAX_CYCLES) {
+    /* Too close to tell drift from jitter, or too far apart to be sure
+       the error did not wrap around a full cycle */
+    return;
+  }
+
+  /* The rtimer may have wrapped around since the last encounter. Use the
+     coarse clock to recover the number of wraps, so that the elapsed time
+     can be taken modulo the cycle time. */
+  coarse = ((unsigned long)(clock_time_t)(clock_time() - e->last) *
+            RTIMER_ARCH_SECOND) / CLOCK_SECOND;
+  elapsed = (rtimer_clock_t)(time - e->time);
+  if(sizeof(rtimer_clock_t) < sizeof(unsigned long) && coarse > elapsed) {
+    unsigned long wrap = (unsigned long)(rtimer_clock_t)~0 + 1;
+    elapsed += ((coarse - elapsed + wrap / 2) / wrap) * wrap;
+  }
+
+  /* Prediction error, folded into [-cycle_time / 2, cycle_time / 2) */
+  err = (int32_t)(elapsed % cycle_time) -
+    predicted_drift(e, cycles) % cycle_time;
+  if(err < 0) {
+    err += cycle_time;
+  }
+  if(err >= cycle_time / 2) {
+    err -= cycle_time;
+  }
+
+  /* The error is what the current skew failed to explain */
+  skew = err * PHASE_SKEW_SCALE / cycles;
+  if(e->samples > 0) {
+    skew >>= PHASE_SKEW_GAIN;
+  }
+  skew += e->skew;
+  if(skew > INT16_MAX) {
+    skew = INT16_MAX;
+  } else if(skew < INT16_MIN) {
+    skew = INT16_MIN;
+  }
+  e->skew = skew;
+
+  if(err < 0) {
+    err = -err;
+  }
+  if(e->samples == 0) {
+    e->jitter = err;
+  } else {
+    e->jitter += (err - (int32_t)e->jitter) >> PHASE_JITTER_GAIN;
+  }
+  if(e->samples < 0xff) {
+    e->samples++;
+  }
+}
+#endif /* PHASE_DRIFT_CORRECT */
+/*---------------------------------------------------------------------------*/
 void
 phase_update(const linkaddr_t *neighbor, rtimer_clock_t time,
              int mac_status)
@@ -98,7 +220,8 @@ phase_update(const linkaddr_t *neighbor, rtimer_clock_t time,
   if(e != NULL) {
     if(mac_status == MAC_TX_OK) {
 #if PHASE_DRIFT_CORRECT
-      e->drift = time-e->time;
+      update_model(e, time);
+      e->last = clock_time();
 #endif
       e->time = time;
     }
@@ -126,9 +249,12 @@ phase_update(const linkaddr_t *neighbor, rtimer_clock_t time,
       if(e) {
         e->time = time;
 #if PHASE_DRIFT_CORRECT
-      e->drift = 0;
+        e->last = clock_time();
+        e->skew = 0;
+        e->jitter = 0;
+        e->samples = 0;
 #endif
-      e->noacks = 0;
+        e->noacks = 0;
       }
     }
   }
@@ -157,6 +283,10 @@ phase_wait(const linkaddr_t *neighbor, rtimer_clock_t cycle_time,
            struct rdc_buf_list *buf_list)
 {
   struct phase *e;
+
+#if PHASE_DRIFT_CORRECT
+  phase_cycle_time = cycle_time;
+#endif
   //  const linkaddr_t *neighbor = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
   /* We go through the list of phases to find if we have recorded a
      phase for this particular neighbor. If so, we can compute the
@@ -187,11 +317,26 @@ phase_wait(const linkaddr_t *neighbor, rtimer_clock_t cycle_time,
 
 #if PHASE_DRIFT_CORRECT
     {
-      int32_t s;
-      if(e->drift > cycle_time) {
-        s = e->drift % cycle_time / (e->drift / cycle_time);  /* drift per cycle */
-        s = s * (now - sync) / cycle_time;                    /* estimated drift to now */
-        sync += s;                                            /* add it in */
+      uint16_t cycles;
+      uint32_t guard;
+
+      cycles = cycles_since(e, cycle_time);
+      if(cycles <= PHASE_MAX_CYCLES) {
+        /* Move the last observed phase along the predicted drift */
+        sync += predicted_drift(e, cycles);
+
+        /* Once the model has settled, the guard time only needs to cover
+           the typical prediction error and the uncertainty of the skew,
+           which grows with the time since the last encounter. Never go
+           below a third of the default: the sender needs that much to
+           check the channel before the first strobe. */
+        if(e->samples >= PHASE_MIN_SAMPLES) {
+          guard = guard_time / 3 + 2 * (uint32_t)e->jitter +
+            (uint32_t)cycles / 16;
+          if(guard < guard_time) {
+            guard_time = guard;
+          }
+        }
       }
     }
 #endif
@@ -244,6 +389,23 @@ phase_wait(const linkaddr_t *neighbor, rtimer_clock_t cycle_time,
 }
 /*---------------------------------------------------------------------------*/
 void
+phase_record_strobes(int locked, int strobes, int mac_status)
+{
+#if PHASE_STATS
+  if(mac_status == MAC_TX_OK) {
+    phase_stats.unicasts++;
+    phase_stats.strobes += strobes;
+    if(locked) {
+      phase_stats.locked_unicasts++;
+      phase_stats.locked_strobes += strobes;
+    }
+  } else if(mac_status == MAC_TX_NOACK && locked) {
+    phase_stats.locked_misses++;
+  }
+#endif /* PHASE_STATS */
+}
+/*---------------------------------------------------------------------------*/
+void
 phase_init(void)
 {
   memb_init(&queued_packets_memb);
@@ -53,6 +53,30 @@ typedef enum {
   PHASE_DEFERRED,
 } phase_status_t;
 
+#ifdef PHASE_CONF_STATS
+#define PHASE_STATS PHASE_CONF_STATS
+#else
+#define PHASE_STATS 0
+#endif
+
+/* Strobe statistics, maintained by phase_record_strobes() */
+struct phase_stats {
+  /* Unicast transmissions that were acknowledged */
+  unsigned long unicasts;
+  /* Strobes spent on acknowledged unicast transmissions */
+  unsigned long strobes;
+  /* Acknowledged unicasts to neighbors with a known phase */
+  unsigned long locked_unicasts;
+  /* Strobes spent on acknowledged unicasts to phase-locked neighbors */
+  unsigned long locked_strobes;
+  /* Unicasts to phase-locked neighbors that were not acknowledged */
+  unsigned long locked_misses;
+};
+
+#if PHASE_STATS
+extern struct phase_stats phase_stats;
+#endif
+
 
 void phase_init(void);
 phase_status_t phase_wait(const linkaddr_t *neighbor,
@@ -63,4 +87,14 @@ void phase_update(const linkaddr_t *neighbor,
                   rtimer_clock_t time, int mac_status);
 void phase_remove(const linkaddr_t *neighbor);
 
+/**
+ * \brief Record the number of strobes a unicast transmission took
+ * \param locked Non-zero if the neighbor's phase was known
+ * \param strobes The number of strobes sent
+ * \param mac_status The outcome of the transmission
+ *
+ * Only has an effect when PHASE_CONF_STATS is set.
+ */
+void phase_record_strobes(int locked, int strobes, int mac_status);
+
 #endif /* PHASE_H */
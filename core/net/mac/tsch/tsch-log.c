@@ -34,7 +34,9 @@
  * \file
  *         Log functions for TSCH, meant for logging from interrupt
  *         during a timeslot operation. Saves ASN, slot and link information
- *         and adds the log to a ringbuf for later printout.
+ *         and adds the log to a ringbuf for later printout. With
+ *         NETTRACE_CONF_ENABLED, Tx and Rx logs go to the binary
+ *         netstack trace instead of being printed.
  * \author
  *         Simon Duquennoy <simonduq@sics.se>
  *
@@ -50,6 +52,7 @@
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-slot-operation.h"
 #include "lib/ringbufindex.h"
+#include "net/nettrace.h"
 
 #if TSCH_LOG_LEVEL >= 1
 #define DEBUG DEBUG_PRINT
@@ -85,6 +88,19 @@ tsch_log_process_pending(void)
   while((log_index = ringbufindex_peek_get(&log_ringbuf)) != -1) {
     struct tsch_log_t *log = &log_array[log_index];
     struct tsch_slotframe *sf = tsch_schedule_get_slotframe_by_handle(log->link->slotframe_handle);
+#if NETTRACE_ENABLED
+    if(log->type == tsch_log_tx) {
+      NETTRACE_AT(log->time, TSCH_TX, log->tx.mac_tx_status, log->tx.dest,
+                  log->asn.ls4b, log->tx.datalen, log->tx.num_tx);
+      ringbufindex_get(&log_ringbuf);
+      continue;
+    } else if(log->type == tsch_log_rx) {
+      NETTRACE_AT(log->time, TSCH_RX, log->rx.is_unicast, log->rx.src,
+                  log->asn.ls4b, log->rx.datalen, log->rx.estimated_drift);
+      ringbufindex_get(&log_ringbuf);
+      continue;
+    }
+#endif /* NETTRACE_ENABLED */
     printf("TSCH: {asn-%x.%lx link-%u-%u-%u-%u ch-%u} ",
         log->asn.ms1b, log->asn.ls4b,
         log->link->slotframe_handle, sf ? sf->size.val : 0, log->link->timeslot, log->link->channel_offset,
@@ -130,6 +146,10 @@ tsch_log_prepare_add(void)
     struct tsch_log_t *log = &log_array[log_index];
     log->asn = current_asn;
     log->link = current_link;
+#if NETTRACE_ENABLED
+    /* Traced later from the process, keep the time of the event */
+    log->time = RTIMER_NOW();
+#endif /* NETTRACE_ENABLED */
     return log;
   } else {
     log_dropped++;
@@ -38,6 +38,7 @@
 #include "contiki.h"
 #include "sys/rtimer.h"
 #include "net/mac/tsch/tsch-private.h"
+#include "net/nettrace.h"
 
 /******** Configuration *******/
 
@@ -83,6 +84,9 @@ struct tsch_log_t {
   } type;
   struct asn_t asn;
   struct tsch_link *link;
+#if NETTRACE_ENABLED
+  rtimer_clock_t time;
+#endif /* NETTRACE_ENABLED */
   union {
     char message[48];
     struct {
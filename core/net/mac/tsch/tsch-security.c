@@ -70,6 +70,32 @@ static aes_key keys[] = {
 };
 #define N_KEYS (sizeof(keys) / sizeof(aes_key))
 
+#if TSCH_SECURITY_STATS
+struct tsch_security_stats tsch_security_stats;
+static uint32_t window_expansions;
+#endif /* TSCH_SECURITY_STATS */
+
+/*---------------------------------------------------------------------------*/
+/* Switching between K1 and K2 finds the expanded keys in the AES
+ * driver's cache instead of expanding them for every frame */
+static void
+tsch_security_set_key(uint8_t key_index)
+{
+#if TSCH_SECURITY_STATS
+  uint32_t expansions = aes_128_key_expansions;
+#endif /* TSCH_SECURITY_STATS */
+
+  CCM_STAR.set_key(keys[key_index - 1]);
+
+#if TSCH_SECURITY_STATS
+  tsch_security_stats.key_expansions += aes_128_key_expansions - expansions;
+  if(++tsch_security_stats.frames % 1000 == 0) {
+    tsch_security_stats.expansions_per_1000 =
+      tsch_security_stats.key_expansions - window_expansions;
+    window_expansions = tsch_security_stats.key_expansions;
+  }
+#endif /* TSCH_SECURITY_STATS */
+}
 /*---------------------------------------------------------------------------*/
 static void
 tsch_security_init_nonce(uint8_t *nonce,
@@ -187,7 +213,7 @@ tsch_security_secure_frame(uint8_t *hdr, uint8_t *outbuf,
     memcpy(outbuf, hdr, a_len + m_len);
   }
 
-  CCM_STAR.set_key(keys[key_index - 1]);
+  tsch_security_set_key(key_index);
 
   CCM_STAR.aead(nonce,
       outbuf + a_len, m_len,
@@ -245,7 +271,7 @@ tsch_security_parse_frame(const uint8_t *hdr, int hdrlen, int datalen,
     m_len = 0;
   }
 
-  CCM_STAR.set_key(keys[key_index - 1]);
+  tsch_security_set_key(key_index);
 
   CCM_STAR.aead(nonce,
        (uint8_t *)hdr + a_len, m_len,
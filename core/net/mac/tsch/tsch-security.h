@@ -112,10 +112,26 @@
 #define TSCH_SECURITY_KEY_SEC_LEVEL_OTHER 5 /* Encryption + MIC-32, as per 6TiSCH minimal */
 #endif
 
+/* Count secured frames and the key schedule expansions they cause */
+#ifdef TSCH_SECURITY_CONF_STATS
+#define TSCH_SECURITY_STATS TSCH_SECURITY_CONF_STATS
+#else
+#define TSCH_SECURITY_STATS 0
+#endif
+
 /************ Types ***********/
 
 typedef uint8_t aes_key[16];
 
+#if TSCH_SECURITY_STATS
+struct tsch_security_stats {
+  uint32_t frames;              /* Secured frames sent and received */
+  uint32_t key_expansions;      /* AES key schedules expanded for them */
+  uint16_t expansions_per_1000; /* Over the last full 1000 frames */
+};
+extern struct tsch_security_stats tsch_security_stats;
+#endif /* TSCH_SECURITY_STATS */
+
 /********** Functions *********/
 
 int tsch_security_mic_len(const frame802154_t *frame);
@@ -38,10 +38,12 @@
  */
 
 #include "net/netstack.h"
+#include "net/nettrace.h"
 /*---------------------------------------------------------------------------*/
 void
 netstack_init(void)
 {
+  nettrace_init();
   NETSTACK_RADIO.init();
   NETSTACK_RDC.init();
   NETSTACK_MAC.init();
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         The events of the netstack trace, with the names and argument
+ *         labels the host decoder (tools/nettrace-decode.c) prints.
+ *         This file has no dependencies so the decoder can include it.
+ *
+ *         NETTRACE_EVENT(id, name, arg0, arg1, arg2, arg3, arg4)
+ *         Labels are NULL for unused arguments. arg0 is 8 bits, arg1 16
+ *         bits, arg2 32 bits, arg3 and arg4 signed 16 bits. Node and
+ *         neighbor ids are the last two bytes of their addresses. New
+ *         events go at the end, so that old traces still decode.
+ */
+
+NETTRACE_EVENT(START, "start", "version", "node", "rtimer-second", "clock-second", "rtimer-bits")
+NETTRACE_EVENT(DROPPED, "dropped", NULL, "count", NULL, NULL, NULL)
+NETTRACE_EVENT(TSCH_TX, "tsch-tx", "status", "dest", "asn", "len", "tx")
+NETTRACE_EVENT(TSCH_RX, "tsch-rx", "unicast", "src", "asn", "len", "edrift")
+NETTRACE_EVENT(MAC_TX, "mac-tx", "status", "dest", NULL, "len", "tx")
+NETTRACE_EVENT(SICSLOWPAN_IN, "6lowpan-in", NULL, "src", NULL, "len", "rssi")
+NETTRACE_EVENT(SICSLOWPAN_OUT, "6lowpan-out", NULL, "dest", NULL, "len", NULL)
+NETTRACE_EVENT(IP_IN, "ip-in", "proto", "src", NULL, "len", NULL)
+NETTRACE_EVENT(IP_OUT, "ip-out", "proto", "dest", NULL, "len", NULL)
+NETTRACE_EVENT(ICMP6_IN, "icmp6-in", "type", "src", NULL, "code", NULL)
+NETTRACE_EVENT(ICMP6_OUT, "icmp6-out", "type", "dest", NULL, "code", NULL)
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         A binary trace of netstack events
+ */
+
+#include "net/nettrace.h"
+
+#if NETTRACE_ENABLED
+
+#include "net/linkaddr.h"
+#include "lib/ringbufindex.h"
+#include <stdio.h>
+
+#if (NETTRACE_QUEUE_LEN & (NETTRACE_QUEUE_LEN - 1)) != 0
+#error NETTRACE_QUEUE_LEN must be power of two
+#endif
+
+#define FRAME_START1 0xa5
+#define FRAME_START2 0x5a
+
+struct record {
+  uint32_t time;
+  uint32_t arg2;
+  uint16_t arg1;
+  int16_t arg3;
+  int16_t arg4;
+  uint8_t event;
+  uint8_t arg0;
+};
+
+static struct ringbufindex ringbuf;
+static struct record records[NETTRACE_QUEUE_LEN];
+static uint16_t dropped;
+
+#if CONTIKI_TARGET_NATIVE
+static FILE *out;
+#endif /* CONTIKI_TARGET_NATIVE */
+
+PROCESS(nettrace_process, "Netstack trace");
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+put16(uint8_t *p, uint16_t v)
+{
+  *p++ = v & 0xff;
+  *p++ = v >> 8;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+put32(uint8_t *p, uint32_t v)
+{
+  p = put16(p, v & 0xffff);
+  return put16(p, v >> 16);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_record(const struct record *r)
+{
+  uint8_t frame[2 + NETTRACE_RECORD_LEN + 1];
+  uint8_t *p;
+  uint8_t sum;
+  int i;
+
+  frame[0] = FRAME_START1;
+  frame[1] = FRAME_START2;
+  p = &frame[2];
+  *p++ = r->event;
+  *p++ = r->arg0;
+  p = put16(p, r->arg1);
+  p = put32(p, r->time);
+  p = put32(p, r->arg2);
+  p = put16(p, r->arg3);
+  p = put16(p, r->arg4);
+  sum = 0;
+  for(i = 2; i < 2 + NETTRACE_RECORD_LEN; i++) {
+    sum += frame[i];
+  }
+  *p = -sum;
+
+#if CONTIKI_TARGET_NATIVE
+  fwrite(frame, 1, sizeof(frame), out);
+#else /* CONTIKI_TARGET_NATIVE */
+  for(i = 0; i < sizeof(frame); i++) {
+    putchar(frame[i]);
+  }
+#endif /* CONTIKI_TARGET_NATIVE */
+}
+/*---------------------------------------------------------------------------*/
+void
+nettrace_add_at(rtimer_clock_t time, uint8_t event, uint8_t arg0,
+                uint16_t arg1, uint32_t arg2, int16_t arg3, int16_t arg4)
+{
+  struct record *r;
+  int index;
+
+  index = ringbufindex_peek_put(&ringbuf);
+  if(index == -1) {
+    dropped++;
+    return;
+  }
+  r = &records[index];
+  r->time = time;
+  r->event = event;
+  r->arg0 = arg0;
+  r->arg1 = arg1;
+  r->arg2 = arg2;
+  r->arg3 = arg3;
+  r->arg4 = arg4;
+  ringbufindex_put(&ringbuf);
+  process_poll(&nettrace_process);
+}
+/*---------------------------------------------------------------------------*/
+void
+nettrace_add(uint8_t event, uint8_t arg0, uint16_t arg1,
+             uint32_t arg2, int16_t arg3, int16_t arg4)
+{
+  nettrace_add_at(RTIMER_NOW(), event, arg0, arg1, arg2, arg3, arg4);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(nettrace_process, ev, data)
+{
+  static struct record lost;
+  int index;
+  int i;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    for(i = 0; i < NETTRACE_BURST; i++) {
+      index = ringbufindex_peek_get(&ringbuf);
+      if(index == -1) {
+        break;
+      }
+      write_record(&records[index]);
+      ringbufindex_get(&ringbuf);
+    }
+
+    /* Tell the decoder how many records are missing, once the queue
+       has room again */
+    if(dropped > 0 && !ringbufindex_full(&ringbuf)) {
+      lost.time = RTIMER_NOW();
+      lost.event = NETTRACE_EV_DROPPED;
+      lost.arg1 = dropped;
+      write_record(&lost);
+      dropped = 0;
+    }
+
+#if CONTIKI_TARGET_NATIVE
+    fflush(out);
+#endif /* CONTIKI_TARGET_NATIVE */
+
+    if(!ringbufindex_empty(&ringbuf)) {
+      process_poll(&nettrace_process);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+nettrace_init(void)
+{
+#if CONTIKI_TARGET_NATIVE
+  const char *name = NETTRACE_FILE;
+
+  out = name != NULL ? fopen(name, "wb") : NULL;
+  if(out == NULL) {
+    out = stdout;
+  }
+#endif /* CONTIKI_TARGET_NATIVE */
+  ringbufindex_init(&ringbuf, NETTRACE_QUEUE_LEN);
+  process_start(&nettrace_process, NULL);
+  NETTRACE(START, NETTRACE_VERSION, NETTRACE_ID_FROM_LINKADDR(&linkaddr_node_addr),
+           RTIMER_SECOND, CLOCK_SECOND, sizeof(rtimer_clock_t) * 8);
+}
+/*---------------------------------------------------------------------------*/
+
+#endif /* NETTRACE_ENABLED */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         A binary trace of netstack events. Each event is a fixed-size
+ *         record with a timestamp, an event id and a few arguments,
+ *         queued in RAM and written out by a process, over the serial
+ *         line or to a file on native. Writing a record costs a few
+ *         bytes instead of a formatted line, so nodes can be traced at
+ *         full rate. tools/nettrace-decode turns the trace into text.
+ *
+ *         On the wire, a record is framed as
+ *           0xa5 0x5a event arg0 arg1(2) time(4) arg2(4) arg3(2) arg4(2) sum
+ *         little-endian, where sum makes the 16 record bytes add up to
+ *         zero. Text printed by the node may be interleaved with the
+ *         records; the decoder passes it through.
+ */
+
+#ifndef NETTRACE_H_
+#define NETTRACE_H_
+
+#include "contiki.h"
+
+/* Set to trace netstack events */
+#ifdef NETTRACE_CONF_ENABLED
+#define NETTRACE_ENABLED NETTRACE_CONF_ENABLED
+#else
+#define NETTRACE_ENABLED 0
+#endif /* NETTRACE_CONF_ENABLED */
+
+/* The number of records queued before they are written out. Must be a
+   power of two. */
+#ifdef NETTRACE_CONF_QUEUE_LEN
+#define NETTRACE_QUEUE_LEN NETTRACE_CONF_QUEUE_LEN
+#else
+#define NETTRACE_QUEUE_LEN 16
+#endif /* NETTRACE_CONF_QUEUE_LEN */
+
+/* The most records written out each time the process runs, so that a
+   busy trace does not hold up other processes */
+#ifdef NETTRACE_CONF_BURST
+#define NETTRACE_BURST NETTRACE_CONF_BURST
+#else
+#define NETTRACE_BURST 4
+#endif /* NETTRACE_CONF_BURST */
+
+/* On native, the file the trace goes to. Set to NULL for stdout. */
+#ifdef NETTRACE_CONF_FILE
+#define NETTRACE_FILE NETTRACE_CONF_FILE
+#else
+#define NETTRACE_FILE "nettrace.bin"
+#endif /* NETTRACE_CONF_FILE */
+
+#define NETTRACE_VERSION 1
+#define NETTRACE_RECORD_LEN 16
+
+enum {
+#define NETTRACE_EVENT(id, name, a0, a1, a2, a3, a4) NETTRACE_EV_##id,
+#include "net/nettrace-events.h"
+#undef NETTRACE_EVENT
+  NETTRACE_EV_MAX
+};
+
+/* An id from the last two bytes of an address */
+#define NETTRACE_ID_FROM_LINKADDR(addr) \
+  ((uint16_t)((addr)->u8[LINKADDR_SIZE - 2] << 8 | (addr)->u8[LINKADDR_SIZE - 1]))
+#define NETTRACE_ID_FROM_IPADDR(addr) \
+  ((uint16_t)((addr)->u8[14] << 8 | (addr)->u8[15]))
+
+#if NETTRACE_ENABLED
+
+/**
+ * \brief      Start tracing, with a NETTRACE_EV_START record.
+ */
+void nettrace_init(void);
+
+/**
+ * \brief      Queue a record, timestamped with RTIMER_NOW().
+ *
+ *             Not for use in interrupts. TSCH logs from its slot
+ *             operation through tsch-log, which hands the records over
+ *             from a process.
+ */
+void nettrace_add(uint8_t event, uint8_t arg0, uint16_t arg1,
+                  uint32_t arg2, int16_t arg3, int16_t arg4);
+
+/**
+ * \brief      Queue a record, timestamped with a time taken earlier,
+ *             for events that are traced after they happened.
+ */
+void nettrace_add_at(rtimer_clock_t time, uint8_t event, uint8_t arg0,
+                     uint16_t arg1, uint32_t arg2, int16_t arg3, int16_t arg4);
+
+#define NETTRACE(event, arg0, arg1, arg2, arg3, arg4) \
+  nettrace_add(NETTRACE_EV_##event, (arg0), (arg1), (arg2), (arg3), (arg4))
+#define NETTRACE_AT(time, event, arg0, arg1, arg2, arg3, arg4) \
+  nettrace_add_at((time), NETTRACE_EV_##event, (arg0), (arg1), (arg2), (arg3), (arg4))
+
+#else /* NETTRACE_ENABLED */
+
+#define nettrace_init()
+#define NETTRACE(event, arg0, arg1, arg2, arg3, arg4)
+#define NETTRACE_AT(time, event, arg0, arg1, arg2, arg3, arg4)
+
+#endif /* NETTRACE_ENABLED */
+
+#endif /* NETTRACE_H_ */
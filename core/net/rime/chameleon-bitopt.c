@@ -53,10 +53,55 @@
 #define CHAMELEON_WITH_MAC_LINK_ADDRESSES 0
 #endif /* !CHAMELEON_CONF_WITH_MAC_LINK_ADDRESSES */
 
+/* This option compiles the attribute list of each channel into a
+   layout plan when the channel's attributes are set. The plan holds
+   the byte and bit position of every attribute, so that packing and
+   unpacking do not need to walk the attribute list and sum up bit
+   offsets, and byte-aligned attributes are copied directly instead
+   of bit by bit. The value is the number of distinct attribute lists
+   that can have a plan; channels beyond that use the generic code.
+ */
+#ifdef CHAMELEON_CONF_BITOPT_PLANS
+#define BITOPT_PLANS CHAMELEON_CONF_BITOPT_PLANS
+#else /* CHAMELEON_CONF_BITOPT_PLANS */
+#define BITOPT_PLANS 0
+#endif /* CHAMELEON_CONF_BITOPT_PLANS */
+
+/* The maximum number of attributes in a plan. */
+#ifdef CHAMELEON_CONF_BITOPT_PLAN_ATTRS
+#define BITOPT_PLAN_ATTRS CHAMELEON_CONF_BITOPT_PLAN_ATTRS
+#else /* CHAMELEON_CONF_BITOPT_PLAN_ATTRS */
+#define BITOPT_PLAN_ATTRS 16
+#endif /* CHAMELEON_CONF_BITOPT_PLAN_ATTRS */
+
 struct bitopt_hdr {
   uint8_t channel[2];
 };
 
+#if BITOPT_PLANS
+#define PLAN_BITS 0 /* Not byte-aligned, packed with set_bits(). */
+#define PLAN_BYTE 1 /* Byte-aligned 8-bit value. */
+#define PLAN_WORD 2 /* Byte-aligned 16-bit value. */
+#define PLAN_ADDR 3 /* Byte-aligned address. */
+
+struct plan_attr {
+  uint8_t type;
+  uint8_t kind;
+  uint8_t len;
+  uint16_t bitptr;
+};
+
+struct plan {
+  const struct packetbuf_attrlist *attrlist;
+  uint8_t num_attrs;
+  struct plan_attr attrs[BITOPT_PLAN_ATTRS];
+};
+
+static struct plan plans[BITOPT_PLANS];
+static uint8_t num_plans;
+static struct plan *last_plan;
+#endif /* BITOPT_PLANS */
+
 #define BITOPT_HDR_SIZE 2
 
 static const uint8_t bitmask[9] = { 0x00, 0x80, 0xc0, 0xe0, 0xf0,
@@ -141,16 +186,84 @@ get_bits(uint8_t *to, uint8_t *from, int bitpos, int vallen)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if BITOPT_PLANS
+static struct plan *
+find_plan(const struct packetbuf_attrlist *attrlist)
+{
+  struct plan *p;
+
+  if(last_plan != NULL && last_plan->attrlist == attrlist) {
+    return last_plan;
+  }
+  for(p = plans; p < &plans[num_plans]; ++p) {
+    if(p->attrlist == attrlist) {
+      last_plan = p;
+      return p;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+compile_plan(const struct packetbuf_attrlist *attrlist)
+{
+  const struct packetbuf_attrlist *a;
+  struct plan *p;
+  struct plan_attr *pa;
+  int bitptr;
+
+  if(find_plan(attrlist) != NULL || num_plans == BITOPT_PLANS) {
+    return;
+  }
+
+  p = &plans[num_plans];
+  p->num_attrs = 0;
+  bitptr = 0;
+  for(a = attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
+#if CHAMELEON_WITH_MAC_LINK_ADDRESSES
+    if(a->type == PACKETBUF_ADDR_SENDER ||
+       a->type == PACKETBUF_ADDR_RECEIVER) {
+      continue;
+    }
+#endif /* CHAMELEON_WITH_MAC_LINK_ADDRESSES */
+    if(p->num_attrs == BITOPT_PLAN_ATTRS) {
+      PRINTF("chameleon-bitopt: too many attributes for a plan\n");
+      return;
+    }
+    pa = &p->attrs[p->num_attrs++];
+    pa->type = a->type;
+    pa->len = a->len;
+    pa->bitptr = bitptr;
+    pa->kind = PLAN_BITS;
+    if((bitptr & 7) == 0) {
+      if(PACKETBUF_IS_ADDR(a->type)) {
+        if(a->len == PACKETBUF_ADDRSIZE) {
+          pa->kind = PLAN_ADDR;
+        }
+      } else if(a->len == 8) {
+        pa->kind = PLAN_BYTE;
+      } else if(a->len == 16) {
+        pa->kind = PLAN_WORD;
+      }
+    }
+    bitptr += a->len;
+  }
+  p->attrlist = attrlist;
+  num_plans++;
+}
+#endif /* BITOPT_PLANS */
+/*---------------------------------------------------------------------------*/
 static int
-header_size(const struct packetbuf_attrlist *a)
+header_size(const struct packetbuf_attrlist *attrlist)
 {
+  const struct packetbuf_attrlist *a;
   int size, len;
   
   /* Compute the total size of the final header by summing the size of
      all attributes that are used on this channel. */
   
   size = 0;
-  for(; a->type != PACKETBUF_ATTR_NONE; ++a) {
+  for(a = attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
 #if CHAMELEON_WITH_MAC_LINK_ADDRESSES
     if(a->type == PACKETBUF_ADDR_SENDER ||
        a->type == PACKETBUF_ADDR_RECEIVER) {
@@ -166,10 +279,13 @@ header_size(const struct packetbuf_attrlist *a)
       }*/
     size += len;
   }
+#if BITOPT_PLANS
+  compile_plan(attrlist);
+#endif /* BITOPT_PLANS */
   return size;
 }
 /*---------------------------------------------------------------------------*/
-void CC_INLINE
+static void CC_INLINE
 set_bits_in_byte(uint8_t *target, int bitpos, uint8_t val, int vallen)
 {
   unsigned short shifted_val;
@@ -253,14 +369,117 @@ printhdr(uint8_t *hdr, int len)
 }
 #endif
 /*---------------------------------------------------------------------------*/
+static void
+pack_attr(uint8_t *hdrptr, uint8_t type, int bitptr, int len)
+{
+  int byteptr;
+
+  byteptr = bitptr / 8;
+  if(PACKETBUF_IS_ADDR(type)) {
+    set_bits(&hdrptr[byteptr], bitptr & 7,
+	     (uint8_t *)packetbuf_addr(type), len);
+    PRINTF("address %d.%d\n",
+	   /*	    linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],*/
+	   ((uint8_t *)packetbuf_addr(type))[0],
+	   ((uint8_t *)packetbuf_addr(type))[1]);
+  } else {
+    uint8_t buffer[2];
+    packetbuf_attr_t val = packetbuf_attr(type);
+    le16_write(buffer, val);
+    set_bits(&hdrptr[byteptr], bitptr & 7, buffer, len);
+    PRINTF("value %d\n",
+	   /*linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],*/
+	   val);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+unpack_attr(uint8_t *hdrptr, uint8_t type, int bitptr, int len)
+{
+  int byteptr;
+
+  byteptr = bitptr / 8;
+  if(PACKETBUF_IS_ADDR(type)) {
+    linkaddr_t addr;
+    get_bits((uint8_t *)&addr, &hdrptr[byteptr], bitptr & 7, len);
+    PRINTF("%d.%d: unpack_header type %d, addr %d.%d\n",
+	   linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
+	   type, addr.u8[0], addr.u8[1]);
+    packetbuf_set_addr(type, &addr);
+  } else {
+    packetbuf_attr_t val;
+    uint8_t buffer[2] = {0};
+    get_bits(buffer, &hdrptr[byteptr], bitptr & 7, len);
+    val = le16_read(buffer);
+    packetbuf_set_attr(type, val);
+    PRINTF("%d.%d: unpack_header type %d, val %d\n",
+	   linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
+	   type, val);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if BITOPT_PLANS
+static void
+pack_plan(const struct plan *p, uint8_t *hdrptr)
+{
+  const struct plan_attr *pa;
+
+  for(pa = p->attrs; pa < &p->attrs[p->num_attrs]; ++pa) {
+    switch(pa->kind) {
+    case PLAN_BYTE:
+      hdrptr[pa->bitptr / 8] = packetbuf_attr(pa->type) & 0xff;
+      break;
+    case PLAN_WORD:
+      le16_write(&hdrptr[pa->bitptr / 8], packetbuf_attr(pa->type));
+      break;
+    case PLAN_ADDR:
+      memcpy(&hdrptr[pa->bitptr / 8], packetbuf_addr(pa->type),
+             LINKADDR_SIZE);
+      break;
+    default:
+      pack_attr(hdrptr, pa->type, pa->bitptr, pa->len);
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+unpack_plan(const struct plan *p, uint8_t *hdrptr)
+{
+  const struct plan_attr *pa;
+  linkaddr_t addr;
+
+  for(pa = p->attrs; pa < &p->attrs[p->num_attrs]; ++pa) {
+    switch(pa->kind) {
+    case PLAN_BYTE:
+      packetbuf_set_attr(pa->type, hdrptr[pa->bitptr / 8]);
+      break;
+    case PLAN_WORD:
+      packetbuf_set_attr(pa->type, le16_read(&hdrptr[pa->bitptr / 8]));
+      break;
+    case PLAN_ADDR:
+      memcpy(&addr, &hdrptr[pa->bitptr / 8], LINKADDR_SIZE);
+      packetbuf_set_addr(pa->type, &addr);
+      break;
+    default:
+      unpack_attr(hdrptr, pa->type, pa->bitptr, pa->len);
+      break;
+    }
+  }
+}
+#endif /* BITOPT_PLANS */
+/*---------------------------------------------------------------------------*/
 static int
 pack_header(struct channel *c)
 {
   const struct packetbuf_attrlist *a;
   int hdrbytesize;
-  int byteptr, bitptr, len;
+  int bitptr, len;
   uint8_t *hdrptr;
   struct bitopt_hdr *hdr;
+#if BITOPT_PLANS
+  struct plan *p;
+#endif /* BITOPT_PLANS */
   
   /* Compute the total size of the final header by summing the size of
      all attributes that are used on this channel. */
@@ -276,8 +495,16 @@ pack_header(struct channel *c)
 
   hdrptr = ((uint8_t *)packetbuf_hdrptr()) + BITOPT_HDR_SIZE;
   memset(hdrptr, 0, hdrbytesize);
+
+#if BITOPT_PLANS
+  p = find_plan(c->attrlist);
+  if(p != NULL) {
+    pack_plan(p, hdrptr);
+    return 1; /* Send out packet */
+  }
+#endif /* BITOPT_PLANS */
   
-  byteptr = bitptr = 0;
+  bitptr = 0;
   
   for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
 #if CHAMELEON_WITH_MAC_LINK_ADDRESSES
@@ -293,23 +520,7 @@ pack_header(struct channel *c)
 	   a->type, a->len, bitptr);
     /*    len = (a->len & 0xf8) + ((a->len & 7) ? 8: 0);*/
     len = a->len;
-    byteptr = bitptr / 8;
-    if(PACKETBUF_IS_ADDR(a->type)) {
-      set_bits(&hdrptr[byteptr], bitptr & 7,
-	       (uint8_t *)packetbuf_addr(a->type), len);
-      PRINTF("address %d.%d\n",
-	    /*	    linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],*/
-	    ((uint8_t *)packetbuf_addr(a->type))[0],
-	    ((uint8_t *)packetbuf_addr(a->type))[1]);
-    } else {
-      uint8_t buffer[2];
-      packetbuf_attr_t val = packetbuf_attr(a->type);
-      le16_write(buffer, val);
-      set_bits(&hdrptr[byteptr], bitptr & 7, buffer, len);
-      PRINTF("value %d\n",
-	    /*linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],*/
-	    val);
-    }
+    pack_attr(hdrptr, a->type, bitptr, len);
     /*    printhdr(hdrptr, hdrbytesize);*/
     bitptr += len;
   }
@@ -322,11 +533,14 @@ static struct channel *
 unpack_header(void)
 {
   const struct packetbuf_attrlist *a;
-  int byteptr, bitptr, len;
+  int bitptr, len;
   int hdrbytesize;
   uint8_t *hdrptr;
   struct bitopt_hdr *hdr;
   struct channel *c;
+#if BITOPT_PLANS
+  struct plan *p;
+#endif /* BITOPT_PLANS */
   
 
   /* The packet has a header that tells us what channel the packet is
@@ -349,7 +563,16 @@ unpack_header(void)
     PRINTF("chameleon-bitopt: too short packet\n");
     return NULL;
   }
-  byteptr = bitptr = 0;
+
+#if BITOPT_PLANS
+  p = find_plan(c->attrlist);
+  if(p != NULL) {
+    unpack_plan(p, hdrptr);
+    return c;
+  }
+#endif /* BITOPT_PLANS */
+
+  bitptr = 0;
   for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
 #if CHAMELEON_WITH_MAC_LINK_ADDRESSES
     if(a->type == PACKETBUF_ADDR_SENDER ||
@@ -363,24 +586,7 @@ unpack_header(void)
 	   a->type, a->len, bitptr);
     /*    len = (a->len & 0xf8) + ((a->len & 7) ? 8: 0);*/
     len = a->len;
-    byteptr = bitptr / 8;
-    if(PACKETBUF_IS_ADDR(a->type)) {
-      linkaddr_t addr;
-      get_bits((uint8_t *)&addr, &hdrptr[byteptr], bitptr & 7, len);
-      PRINTF("%d.%d: unpack_header type %d, addr %d.%d\n",
-	     linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-	     a->type, addr.u8[0], addr.u8[1]);
-      packetbuf_set_addr(a->type, &addr);
-    } else {
-      packetbuf_attr_t val;
-      uint8_t buffer[2] = {0};
-      get_bits(buffer, &hdrptr[byteptr], bitptr & 7, len);
-      val = le16_read(buffer);
-      packetbuf_set_attr(a->type, val);
-      PRINTF("%d.%d: unpack_header type %d, val %d\n",
-	     linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-	     a->type, val);
-    }
+    unpack_attr(hdrptr, a->type, bitptr, len);
     /*    byteptr += len / 8;*/
     bitptr += len;
   }
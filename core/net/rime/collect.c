@@ -65,20 +65,43 @@ static const struct packetbuf_attrlist attributes[] =
   };
 
 
-/* The recent_packets list holds the sequence number, the originator,
-   and the connection for packets that have been recently
-   forwarded. This list is maintained to avoid forwarding duplicate
-   packets. */
-#define NUM_RECENT_PACKETS 16
-
-struct recent_packet {
+/* The recent_flows table holds, for each originator and connection,
+   the newest sequence number that has been recently forwarded and a
+   bitmap of the RECENT_WINDOW sequence numbers before it. This table
+   is maintained to avoid forwarding duplicate packets. The table is
+   hashed on the originator address so that a sink that collects from
+   many nodes can be given a large table without slowing down the
+   lookup. */
+#ifdef COLLECT_CONF_RECENT_FLOWS
+#define NUM_RECENT_FLOWS COLLECT_CONF_RECENT_FLOWS
+#else /* COLLECT_CONF_RECENT_FLOWS */
+#define NUM_RECENT_FLOWS 16
+#endif /* COLLECT_CONF_RECENT_FLOWS */
+
+#define RECENT_WINDOW 16
+#define RECENT_FLOW_PROBES (NUM_RECENT_FLOWS < 4 ? NUM_RECENT_FLOWS : 4)
+#define ESEQNO_MASK ((1 << COLLECT_PACKET_ID_BITS) - 1)
+#define ESEQNO_HALF (1 << (COLLECT_PACKET_ID_BITS - 1))
+
+struct recent_flow {
   struct collect_conn *conn;
   linkaddr_t originator;
+  uint16_t window;
   uint8_t eseqno;
+  uint8_t last_used;
 };
 
-static struct recent_packet recent_packets[NUM_RECENT_PACKETS];
-static uint8_t recent_packet_ptr;
+static struct recent_flow recent_flows[NUM_RECENT_FLOWS];
+static uint8_t recent_flow_clock;
+
+/* When a packet cannot be delivered to the parent at the MAC layer,
+   the packets queued behind it may be sent first. The lifetime of
+   the packet on the queue bounds how long it can be retried. */
+#ifdef COLLECT_CONF_REORDER_QUEUE
+#define REORDER_QUEUE COLLECT_CONF_REORDER_QUEUE
+#else /* COLLECT_CONF_REORDER_QUEUE */
+#define REORDER_QUEUE 0
+#endif /* COLLECT_CONF_REORDER_QUEUE */
 
 
 /* This is the header of data packets. The header comtains the routing
@@ -206,6 +229,7 @@ struct {
   uint32_t ttldrop;
   uint32_t ackdrop;
   uint32_t timedout;
+  uint32_t requeued;
 } stats;
 
 /* Debug definition: draw routing tree in Cooja. */
@@ -222,6 +246,9 @@ struct {
 static void send_queued_packet(struct collect_conn *c);
 static void retransmit_callback(void *ptr);
 static void retransmit_not_sent_callback(void *ptr);
+#if REORDER_QUEUE
+static void send_requeued_callback(void *ptr);
+#endif /* REORDER_QUEUE */
 static void set_keepalive_timer(struct collect_conn *c);
 
 /*---------------------------------------------------------------------------*/
@@ -903,20 +930,100 @@ send_ack(struct collect_conn *tc, const linkaddr_t *to, int flags)
   stats.acksent++;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * Find the recent_flows entry for the originator of the packet in the
+ * packetbuf. If there is none and allocate is set, the least recently
+ * used entry in the probe sequence is taken over.
+ */
+static struct recent_flow *
+find_recent_flow(struct collect_conn *tc, int allocate)
+{
+  const linkaddr_t *originator;
+  struct recent_flow *f, *oldest;
+  unsigned hash;
+  int i;
+
+  originator = packetbuf_addr(PACKETBUF_ADDR_ESENDER);
+  hash = 0;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 31 + originator->u8[i];
+  }
+
+  oldest = NULL;
+  for(i = 0; i < RECENT_FLOW_PROBES; i++) {
+    f = &recent_flows[(hash + i) % NUM_RECENT_FLOWS];
+    if(f->conn == tc && linkaddr_cmp(&f->originator, originator)) {
+      return f;
+    }
+    if(oldest == NULL || f->conn == NULL ||
+       (oldest->conn != NULL &&
+        (uint8_t)(recent_flow_clock - f->last_used) >
+        (uint8_t)(recent_flow_clock - oldest->last_used))) {
+      oldest = f;
+    }
+  }
+
+  if(!allocate) {
+    return NULL;
+  }
+  oldest->conn = tc;
+  linkaddr_copy(&oldest->originator, originator);
+  oldest->eseqno = packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID);
+  oldest->window = 0;
+  return oldest;
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_recent_packet(struct collect_conn *tc)
+{
+  struct recent_flow *f;
+  uint8_t eseqno, behind;
+
+  f = find_recent_flow(tc, 0);
+  if(f == NULL) {
+    return 0;
+  }
+
+  eseqno = packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID);
+  behind = (f->eseqno - eseqno) & ESEQNO_MASK;
+  if(behind >= RECENT_WINDOW || (behind != 0 && behind >= ESEQNO_HALF)) {
+    /* Newer than anything we have seen, or too old to tell. */
+    return 0;
+  }
+  return (f->window & (1 << behind)) != 0;
+}
+/*---------------------------------------------------------------------------*/
 static void
 add_packet_to_recent_packets(struct collect_conn *tc)
 {
+  struct recent_flow *f;
+  uint8_t eseqno, ahead, behind;
+
   /* Remember that we have seen this packet for later, but only if
      it has a length that is larger than zero. Packets with size
      zero are keepalive or proactive link estimate probes, so we do
      not record them in our history. */
   if(packetbuf_datalen() > sizeof(struct data_msg_hdr)) {
-    recent_packets[recent_packet_ptr].eseqno =
-      packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID);
-    linkaddr_copy(&recent_packets[recent_packet_ptr].originator,
-                  packetbuf_addr(PACKETBUF_ADDR_ESENDER));
-    recent_packets[recent_packet_ptr].conn = tc;
-    recent_packet_ptr = (recent_packet_ptr + 1) % NUM_RECENT_PACKETS;
+    f = find_recent_flow(tc, 1);
+    f->last_used = ++recent_flow_clock;
+
+    eseqno = packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID);
+    ahead = (eseqno - f->eseqno) & ESEQNO_MASK;
+    behind = (f->eseqno - eseqno) & ESEQNO_MASK;
+    if(ahead == 0) {
+      f->window |= 1;
+    } else if(ahead < ESEQNO_HALF) {
+      /* A newer packet: slide the window forward. */
+      f->window = ahead >= RECENT_WINDOW ? 1 : (f->window << ahead) | 1;
+      f->eseqno = eseqno;
+    } else if(behind < RECENT_WINDOW) {
+      /* A packet that was reordered on its way here. */
+      f->window |= 1 << behind;
+    } else {
+      /* Far behind: the originator has most likely rebooted. */
+      f->window = 1;
+      f->eseqno = eseqno;
+    }
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -925,7 +1032,6 @@ node_packet_received(struct unicast_conn *c, const linkaddr_t *from)
 {
   struct collect_conn *tc = (struct collect_conn *)
     ((char *)c - offsetof(struct collect_conn, unicast_conn));
-  int i;
   struct data_msg_hdr hdr;
   uint8_t ackflags = 0;
   struct collect_neighbor *n;
@@ -972,23 +1078,19 @@ node_packet_received(struct unicast_conn *c, const linkaddr_t *from)
       ackflags |= ACK_FLAGS_CONGESTED;
     }
 
-    for(i = 0; i < NUM_RECENT_PACKETS; i++) {
-      if(recent_packets[i].conn == tc &&
-         recent_packets[i].eseqno == packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID) &&
-         linkaddr_cmp(&recent_packets[i].originator,
-                      packetbuf_addr(PACKETBUF_ADDR_ESENDER))) {
-        /* This is a duplicate of a packet we recently received, so we
-           just send an ACK. */
-        PRINTF("%d.%d: found duplicate packet from %d.%d with seqno %d, via %d.%d\n",
-               linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-               recent_packets[i].originator.u8[0], recent_packets[i].originator.u8[1],
-               packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID),
-               packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[0],
-               packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[1]);
-        send_ack(tc, &ack_to, ackflags);
-        stats.duprecv++;
-        return;
-      }
+    if(is_recent_packet(tc)) {
+      /* This is a duplicate of a packet we recently received, so we
+         just send an ACK. */
+      PRINTF("%d.%d: found duplicate packet from %d.%d with seqno %d, via %d.%d\n",
+             linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
+             packetbuf_addr(PACKETBUF_ADDR_ESENDER)->u8[0],
+             packetbuf_addr(PACKETBUF_ADDR_ESENDER)->u8[1],
+             packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID),
+             packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[0],
+             packetbuf_addr(PACKETBUF_ADDR_SENDER)->u8[1]);
+      send_ack(tc, &ack_to, ackflags);
+      stats.duprecv++;
+      return;
     }
 
     /* If we are the sink, the packet has reached its final
@@ -1149,12 +1251,54 @@ node_packet_sent(struct unicast_conn *c, int status, int transmissions)
     } else {
       clock_time_t time = REXMIT_TIME / 2 + (random_rand() % (REXMIT_TIME / 2));
       PRINTF("retransmission time %lu\n", time);
+#if REORDER_QUEUE
+      if(status != MAC_TX_OK && packetqueue_len(&tc->send_queue) > 1) {
+        /* The parent did not hear this packet. Move it behind the
+           other queued packets so that it does not block them, and
+           use a new packet ID so that a late ACK for this attempt is
+           not taken as an ACK for the next packet. The failed attempts
+           are charged to the parent as with a timeout, so that a dead
+           parent is still noticed while packets cycle through the
+           queue. */
+        struct collect_neighbor *n;
+
+        n = collect_neighbor_list_find(&tc->neighbor_list,
+                                       &tc->current_parent);
+        if(n != NULL) {
+          collect_neighbor_tx_fail(n, tc->transmissions);
+        }
+        update_rtmetric(tc);
+        packetqueue_requeue_first(&tc->send_queue);
+        tc->seqno = (tc->seqno + 1) % (1 << COLLECT_PACKET_ID_BITS);
+        tc->transmissions = 0;
+        stats.requeued++;
+        ctimer_set(&tc->retransmission_timer, time,
+                   send_requeued_callback, tc);
+        return;
+      }
+#endif /* REORDER_QUEUE */
       ctimer_set(&tc->retransmission_timer, time,
                  retransmit_callback, tc);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+#if REORDER_QUEUE
+/**
+ * This function is called from a ctimer that is setup when the packet
+ * at the head of the send queue has been moved to the end of the
+ * queue. It sends the packet that is now first on the queue.
+ */
+static void
+send_requeued_callback(void *ptr)
+{
+  struct collect_conn *c = ptr;
+
+  c->sending = 0;
+  send_queued_packet(c);
+}
+#endif /* REORDER_QUEUE */
+/*---------------------------------------------------------------------------*/
 /**
  * This function is called from a ctimer that is setup when a packet
  * is first transmitted. If the MAC layer signals that the packet is
@@ -123,6 +123,17 @@ packetqueue_dequeue(struct packetqueue *q)
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+packetqueue_requeue_first(struct packetqueue *q)
+{
+  struct packetqueue_item *i;
+
+  i = list_pop(*q->list);
+  if(i != NULL) {
+    list_add(*q->list, i);
+  }
+}
+/*---------------------------------------------------------------------------*/
 int
 packetqueue_len(struct packetqueue *q)
 {
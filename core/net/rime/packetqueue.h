@@ -178,6 +178,19 @@ struct packetqueue_item *packetqueue_first(struct packetqueue *q);
  */
 void packetqueue_dequeue(struct packetqueue *q);
 
+/**
+ * \brief      Move the first item to the end of the packet queue.
+ * \param q    A pointer to a struct packetqueue.
+ *
+ *             This function moves the first item on the packet
+ *             queue behind all other items, so that a packet that
+ *             cannot be sent right now does not hold back the packets
+ *             queued after it. The lifetime of the item is not
+ *             changed.
+ *
+ */
+void packetqueue_requeue_first(struct packetqueue *q);
+
 /**
  * \brief      Get the length of the packet queue
  * \param q    A pointer to a struct packetqueue.
@@ -85,6 +85,21 @@ void RPL_DEBUG_DIO_INPUT(uip_ipaddr_t *, rpl_dio_t *);
 void RPL_DEBUG_DAO_OUTPUT(rpl_parent_t *);
 #endif
 
+/* Callbacks that add an option of their own to the DAOs of this node,
+   and see the options RPL does not know in received DAOs. The output
+   callback returns the length of the option it wrote. */
+#ifdef RPL_CALLBACK_DAO_OPTION_OUTPUT
+int RPL_CALLBACK_DAO_OPTION_OUTPUT(rpl_parent_t *parent,
+                                   const uip_ipaddr_t *target,
+                                   uint8_t *buffer);
+#endif /* RPL_CALLBACK_DAO_OPTION_OUTPUT */
+
+#ifdef RPL_CALLBACK_DAO_OPTION_INPUT
+void RPL_CALLBACK_DAO_OPTION_INPUT(const uip_ipaddr_t *from,
+                                   const uip_ipaddr_t *target,
+                                   const uint8_t *option);
+#endif /* RPL_CALLBACK_DAO_OPTION_INPUT */
+
 static uint8_t dao_sequence = RPL_LOLLIPOP_INIT;
 
 extern rpl_of_t RPL_OF;
@@ -696,6 +711,11 @@ dao_input(void)
       lifetime = buffer[i + 5];
       /* The parent address is also ignored. */
       break;
+#ifdef RPL_CALLBACK_DAO_OPTION_INPUT
+    default:
+      RPL_CALLBACK_DAO_OPTION_INPUT(&dao_sender_addr, &prefix, buffer + i);
+      break;
+#endif /* RPL_CALLBACK_DAO_OPTION_INPUT */
     }
   }
 
@@ -900,6 +920,10 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
   buffer[pos++] = 0; /* path seq - ignored */
   buffer[pos++] = lifetime;
 
+#ifdef RPL_CALLBACK_DAO_OPTION_OUTPUT
+  pos += RPL_CALLBACK_DAO_OPTION_OUTPUT(parent, prefix, buffer + pos);
+#endif /* RPL_CALLBACK_DAO_OPTION_OUTPUT */
+
   PRINTF("RPL: Sending %sDAO with prefix ", lifetime == RPL_ZERO_LIFETIME ? "No-Path " : "");
   PRINT6ADDR(prefix);
   PRINTF(" to ");
@@ -38,6 +38,7 @@
  */
 
 #include "sys/energest.h"
+#include "sys/process.h"
 #include "contiki-conf.h"
 
 #if ENERGEST_CONF_ON
@@ -50,6 +51,15 @@ energest_t energest_leveldevice_current_leveltime[ENERGEST_CONF_LEVELDEVICE_LEVE
 #endif
 unsigned char energest_current_mode[ENERGEST_TYPE_MAX];
 
+#if ENERGEST_PROCESS
+struct energest_process energest_process_time[ENERGEST_PROCESS_SLOTS];
+static unsigned char process_current_slot = ENERGEST_PROCESS_NONE;
+static rtimer_clock_t process_last_time;
+static unsigned long process_last_transmit, process_last_listen;
+
+static void process_charge(void);
+#endif /* ENERGEST_PROCESS */
+
 /*---------------------------------------------------------------------------*/
 void
 energest_init(void)
@@ -64,6 +74,14 @@ energest_init(void)
     energest_leveldevice_current_leveltime[i].current = 0;
   }
 #endif
+#if ENERGEST_PROCESS
+  for(i = 0; i < ENERGEST_PROCESS_SLOTS; ++i) {
+    energest_process_time[i].p = NULL;
+  }
+  process_current_slot = ENERGEST_PROCESS_NONE;
+  process_last_time = RTIMER_NOW();
+  process_last_transmit = process_last_listen = 0;
+#endif /* ENERGEST_PROCESS */
 }
 /*---------------------------------------------------------------------------*/
 unsigned long
@@ -111,7 +129,101 @@ energest_flush(void)
       energest_current_time[i] = now;
     }
   }
+#if ENERGEST_PROCESS
+  /* Bring the slot of the process that is running up to date */
+  process_charge();
+#endif /* ENERGEST_PROCESS */
+}
+/*---------------------------------------------------------------------------*/
+#if ENERGEST_PROCESS
+/* Charge the time since the last process switch to the running process */
+static void
+process_charge(void)
+{
+  rtimer_clock_t now;
+  unsigned long transmit, listen;
+  struct energest_process *e;
+
+  now = RTIMER_NOW();
+  transmit = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  listen = energest_type_time(ENERGEST_TYPE_LISTEN);
+
+  e = process_current_slot != ENERGEST_PROCESS_NONE ?
+    &energest_process_time[process_current_slot] : NULL;
+  /* A freed slot is not charged, its counts are cleared on reuse */
+  if(e != NULL && e->p != NULL) {
+    e->cpu += (rtimer_clock_t)(now - process_last_time);
+    e->transmit += transmit - process_last_transmit;
+    e->listen += listen - process_last_listen;
+  }
+  process_last_time = now;
+  process_last_transmit = transmit;
+  process_last_listen = listen;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned char
+process_slot(struct process *p)
+{
+  unsigned char i, free;
+
+  free = ENERGEST_PROCESS_NONE;
+  for(i = 0; i < ENERGEST_PROCESS_SLOTS; i++) {
+    if(energest_process_time[i].p == p) {
+      return i;
+    }
+    if(energest_process_time[i].p == NULL && free == ENERGEST_PROCESS_NONE) {
+      free = i;
+    }
+  }
+  if(free != ENERGEST_PROCESS_NONE) {
+    energest_process_time[free].p = p;
+    energest_process_time[free].events = 0;
+    energest_process_time[free].cpu = 0;
+    energest_process_time[free].transmit = 0;
+    energest_process_time[free].listen = 0;
+  }
+  return free;
+}
+/*---------------------------------------------------------------------------*/
+unsigned char
+energest_process_enter(struct process *p)
+{
+  unsigned char previous;
+
+  previous = process_current_slot;
+  process_charge();
+  process_current_slot = process_slot(p);
+  if(process_current_slot != ENERGEST_PROCESS_NONE) {
+    energest_process_time[process_current_slot].events++;
+  }
+  return previous;
+}
+/*---------------------------------------------------------------------------*/
+void
+energest_process_leave(unsigned char previous)
+{
+  process_charge();
+  process_current_slot = previous;
+}
+/*---------------------------------------------------------------------------*/
+void
+energest_process_remove(struct process *p)
+{
+  unsigned char i;
+
+  for(i = 0; i < ENERGEST_PROCESS_SLOTS; i++) {
+    if(energest_process_time[i].p == p) {
+      if(i == process_current_slot) {
+        /* The process exits itself: charge it up to now, and nothing
+           more until energest_process_leave() */
+        process_charge();
+        process_current_slot = ENERGEST_PROCESS_NONE;
+      }
+      energest_process_time[i].p = NULL;
+    }
+  }
 }
+#endif /* ENERGEST_PROCESS */
 /*---------------------------------------------------------------------------*/
 #else /* ENERGEST_CONF_ON */
 void energest_type_set(int type, unsigned long val) {}
@@ -75,6 +75,51 @@ unsigned long energest_leveldevice_leveltime(int powerlevel);
 void energest_type_set(int type, unsigned long value);
 void energest_flush(void);
 
+/*
+ * Per-process accounting. With ENERGEST_CONF_PROCESS, call_process()
+ * charges the rtimer ticks that each process runs for, and the
+ * transmit and listen time that the radio is on meanwhile, to a slot
+ * of that process. Time is charged to the innermost process only, so
+ * a process that posts a synchronous event to another one is not
+ * charged for the other one's work. The netstack layers run as
+ * processes (tcpip, the MAC and RDC processes), so their share shows
+ * up as well. What is left of the totals was spent outside processes:
+ * in interrupts, in rtimer callbacks such as radio duty cycling, and
+ * in processes that did not get a slot.
+ */
+#ifdef ENERGEST_CONF_PROCESS
+#define ENERGEST_PROCESS ENERGEST_CONF_PROCESS
+#else /* ENERGEST_CONF_PROCESS */
+#define ENERGEST_PROCESS 0
+#endif /* ENERGEST_CONF_PROCESS */
+
+#ifdef ENERGEST_CONF_PROCESS_SLOTS
+#define ENERGEST_PROCESS_SLOTS ENERGEST_CONF_PROCESS_SLOTS
+#else /* ENERGEST_CONF_PROCESS_SLOTS */
+#define ENERGEST_PROCESS_SLOTS 8
+#endif /* ENERGEST_CONF_PROCESS_SLOTS */
+
+#define ENERGEST_PROCESS_NONE 0xff
+
+struct process;
+
+struct energest_process {
+  /* The process that owns the slot, or NULL if the slot is free */
+  struct process *p;
+  unsigned long events;
+  unsigned long cpu;
+  unsigned long transmit;
+  unsigned long listen;
+};
+
+#if ENERGEST_CONF_ON && ENERGEST_PROCESS
+extern struct energest_process energest_process_time[ENERGEST_PROCESS_SLOTS];
+
+unsigned char energest_process_enter(struct process *p);
+void energest_process_leave(unsigned char previous);
+void energest_process_remove(struct process *p);
+#endif /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
+
 #if ENERGEST_CONF_ON
 /*extern int energest_total_count;*/
 extern energest_t energest_total_time[ENERGEST_TYPE_MAX];
@@ -47,6 +47,7 @@
 
 #include "sys/process.h"
 #include "sys/arg.h"
+#include "sys/energest.h"
 
 /*
  * Pointer to the currently running process structure.
@@ -74,6 +75,29 @@ process_num_events_t process_maxevents;
 
 static volatile unsigned char poll_requested;
 
+/*
+ * The polled processes, so that the scheduler calls them without
+ * looking through the process list. process_poll() is called from
+ * interrupts, and there are no atomic read-modify-write operations to
+ * rely on, so this works like ringbuf: the scheduler only moves
+ * poll_get, the indices are bytes, and a slot is written before
+ * poll_put is moved past it. The poll_busy flag keeps two callers of
+ * process_poll() from putting at the same time: an interrupt returns
+ * before the code it interrupted continues, so a caller that finds
+ * the flag set has interrupted another. That caller, or one that
+ * finds the queue full, sets poll_scan instead and the scheduler
+ * looks through all processes. A process may be in
+ * the queue more than once; needspoll tells if it still is polled.
+ */
+#if PROCESS_CONF_NUMPOLLS < 1 || PROCESS_CONF_NUMPOLLS > 128 || \
+  (PROCESS_CONF_NUMPOLLS & (PROCESS_CONF_NUMPOLLS - 1)) != 0
+#error PROCESS_CONF_NUMPOLLS must be a power of two no larger than 128
+#endif
+#define POLL_MASK (PROCESS_CONF_NUMPOLLS - 1)
+static struct process *polls[PROCESS_CONF_NUMPOLLS];
+static volatile uint8_t poll_put, poll_get;
+static volatile unsigned char poll_busy, poll_scan;
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
@@ -157,6 +181,9 @@ exit_process(struct process *p, struct process *fromprocess)
     }
   }
 
+  /* A stale entry in the poll queue must not call it */
+  p->needspoll = 0;
+
   if(p == process_list) {
     process_list = process_list->next;
   } else {
@@ -168,6 +195,10 @@ exit_process(struct process *p, struct process *fromprocess)
     }
   }
 
+#if ENERGEST_CONF_ON && ENERGEST_PROCESS
+  energest_process_remove(p);
+#endif /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
+
   process_current = old_current;
 }
 /*---------------------------------------------------------------------------*/
@@ -175,6 +206,9 @@ static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
   int ret;
+#if ENERGEST_CONF_ON && ENERGEST_PROCESS
+  unsigned char energest_previous;
+#endif /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
 
 #if DEBUG
   if(p->state == PROCESS_STATE_CALLED) {
@@ -187,7 +221,13 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if ENERGEST_CONF_ON && ENERGEST_PROCESS
+    energest_previous = energest_process_enter(p);
     ret = p->thread(&p->pt, ev, data);
+    energest_process_leave(energest_previous);
+#else /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
+    ret = p->thread(&p->pt, ev, data);
+#endif /* ENERGEST_CONF_ON && ENERGEST_PROCESS */
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -214,6 +254,9 @@ process_init(void)
   process_maxevents = 0;
 #endif /* PROCESS_CONF_STATS */
 
+  poll_put = poll_get = 0;
+  poll_busy = poll_scan = 0;
+
   process_current = process_list = NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -222,17 +265,42 @@ process_init(void)
  */
 /*---------------------------------------------------------------------------*/
 static void
+call_poll(struct process *p)
+{
+  p->state = PROCESS_STATE_RUNNING;
+  p->needspoll = 0;
+  call_process(p, PROCESS_EVENT_POLL, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
 do_poll(void)
 {
   struct process *p;
+  uint8_t get, put;
 
   poll_requested = 0;
-  /* Call the processes that needs to be polled. */
-  for(p = process_list; p != NULL; p = p->next) {
+
+  /* Call the processes that were polled before now. Later polls are
+     left for the next round. */
+  put = poll_put;
+
+  if(poll_scan) {
+    /* Some polls did not make it into the queue. Looking through all
+       processes also calls those that are in the queue. */
+    poll_scan = 0;
+    for(p = process_list; p != NULL; p = p->next) {
+      if(p->needspoll) {
+        call_poll(p);
+      }
+    }
+    poll_get = put;
+  }
+
+  for(get = poll_get; get != put; ) {
+    p = polls[get & POLL_MASK];
+    poll_get = ++get;
     if(p->needspoll) {
-      p->state = PROCESS_STATE_RUNNING;
-      p->needspoll = 0;
-      call_process(p, PROCESS_EVENT_POLL, NULL);
+      call_poll(p);
     }
   }
 }
@@ -370,10 +438,29 @@ process_post_synch(struct process *p, process_event_t ev, process_data_t data)
 void
 process_poll(struct process *p)
 {
+  uint8_t put;
+
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
-      p->needspoll = 1;
+      if(!p->needspoll) {
+        p->needspoll = 1;
+        if(poll_scan) {
+          /* The scheduler will look through all processes anyway */
+        } else if(poll_busy) {
+          poll_scan = 1;
+        } else {
+          poll_busy = 1;
+          put = poll_put;
+          if((uint8_t)(put - poll_get) >= PROCESS_CONF_NUMPOLLS) {
+            poll_scan = 1;
+          } else {
+            polls[put & POLL_MASK] = p;
+            poll_put = put + 1;
+          }
+          poll_busy = 0;
+        }
+      }
       poll_requested = 1;
     }
   }
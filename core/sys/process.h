@@ -88,6 +88,18 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/* Polled processes waiting to be called; a power of two up to 128.
+   When it overflows, the scheduler looks through all processes, which
+   costs slightly more than with no queue: the polls that fit were
+   queued for nothing. The
+   queue saves the most when few processes are polled at a time; by
+   the time about a quarter of the processes are polled together,
+   looking through all of them costs as much as calling them from the
+   queue, so a larger queue mostly costs RAM. */
+#ifndef PROCESS_CONF_NUMPOLLS
+#define PROCESS_CONF_NUMPOLLS 8
+#endif /* PROCESS_CONF_NUMPOLLS */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
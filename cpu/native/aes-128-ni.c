@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         AES-128 on the AES-NI instructions of x86 hosts. Falls back
+ *         to the table-driven driver on CPUs without them and on other
+ *         architectures.
+ */
+
+#include "lib/aes-128.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define AES_NI_ARCH 1
+#else
+#define AES_NI_ARCH 0
+#endif
+
+#if AES_NI_ARCH
+#include <wmmintrin.h>
+
+#define AES_NI __attribute__((target("aes,sse2")))
+
+static __m128i cached_round_keys[AES_128_KEY_CACHE_SIZE][11];
+static __m128i *round_keys = cached_round_keys[0];
+static struct aes_128_key_cache key_cache;
+static int have_aes_ni = -1;
+
+/*---------------------------------------------------------------------------*/
+static AES_NI __m128i
+expand(__m128i key, __m128i assist)
+{
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, _mm_shuffle_epi32(assist, 0xff));
+}
+/*---------------------------------------------------------------------------*/
+#define EXPAND(i, rcon)                                                 \
+  round_keys[i] = expand(round_keys[i - 1],                             \
+                         _mm_aeskeygenassist_si128(round_keys[i - 1], rcon))
+
+static AES_NI void
+set_key_ni(const uint8_t *key)
+{
+  int slot;
+
+  slot = aes_128_key_cache_find(&key_cache, key);
+  if(slot >= 0) {
+    round_keys = cached_round_keys[slot];
+    return;
+  }
+  round_keys = cached_round_keys[aes_128_key_cache_add(&key_cache, key)];
+
+  round_keys[0] = _mm_loadu_si128((const __m128i *)key);
+  EXPAND(1, 0x01);
+  EXPAND(2, 0x02);
+  EXPAND(3, 0x04);
+  EXPAND(4, 0x08);
+  EXPAND(5, 0x10);
+  EXPAND(6, 0x20);
+  EXPAND(7, 0x40);
+  EXPAND(8, 0x80);
+  EXPAND(9, 0x1b);
+  EXPAND(10, 0x36);
+}
+/*---------------------------------------------------------------------------*/
+static AES_NI void
+encrypt_ni(uint8_t *state)
+{
+  __m128i s;
+  int round;
+
+  s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)state), round_keys[0]);
+  for(round = 1; round < 10; round++) {
+    s = _mm_aesenc_si128(s, round_keys[round]);
+  }
+  s = _mm_aesenclast_si128(s, round_keys[10]);
+  _mm_storeu_si128((__m128i *)state, s);
+}
+/*---------------------------------------------------------------------------*/
+static int
+aes_ni(void)
+{
+  if(have_aes_ni < 0) {
+    __builtin_cpu_init();
+    have_aes_ni = __builtin_cpu_supports("aes");
+  }
+  return have_aes_ni;
+}
+#endif /* AES_NI_ARCH */
+/*---------------------------------------------------------------------------*/
+static void
+set_key(const uint8_t *key)
+{
+#if AES_NI_ARCH
+  if(aes_ni()) {
+    set_key_ni(key);
+    return;
+  }
+#endif /* AES_NI_ARCH */
+  aes_128_table_driver.set_key(key);
+}
+/*---------------------------------------------------------------------------*/
+static void
+encrypt(uint8_t *state)
+{
+#if AES_NI_ARCH
+  if(have_aes_ni > 0) {
+    encrypt_ni(state);
+    return;
+  }
+#endif /* AES_NI_ARCH */
+  aes_128_table_driver.encrypt(state);
+}
+/*---------------------------------------------------------------------------*/
+const struct aes_128_driver aes_128_ni_driver = {
+  set_key,
+  encrypt
+};
+/*---------------------------------------------------------------------------*/
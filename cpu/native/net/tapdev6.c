@@ -82,6 +82,8 @@ static int drop = 0;
 #endif
 
 static int fd = -1;
+/* The interface that tapdev_init() got; a second instance gets tap1 */
+static char ifname[16] = "tap0";
 
 static unsigned long lasttime;
 
@@ -311,6 +313,7 @@ tapdev_init(void)
       perror(buf);
       exit(1);
     }
+    strncpy(ifname, ifr.ifr_name, sizeof(ifname) - 1);
   }
 #endif /* Linux */
 
@@ -330,7 +333,7 @@ tapdev_init(void)
      PRINTF("%s\n", buf);
   */
   /* freebsd */
-  snprintf(buf, sizeof(buf), "ifconfig tap0 up");
+  snprintf(buf, sizeof(buf), "ifconfig %s up", ifname);
   if(system(buf) == -1) {
     perror("tapdev: system: ifconfig");
     return;
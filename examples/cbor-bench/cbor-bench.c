@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         Size and cost of writing a jsontree value tree as JSON and
+ *         as CBOR, of reading it back with jsonparse and with the
+ *         CBOR decoder, and of getting it from a CoAP resource that
+ *         picks the content-format from the Accept option, in
+ *         blocks of REST_MAX_CHUNK_SIZE bytes.
+ */
+
+#include "contiki.h"
+#include "jsontree.h"
+#include "jsonparse.h"
+#include "cbor.h"
+#include "rest-engine.h"
+#include "er-coap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define OUTPUT_SIZE 1024
+#define VALUE_SIZE  32
+
+static char json[OUTPUT_SIZE];
+static int json_len;
+static char cbor[OUTPUT_SIZE];
+static int cbor_len;
+
+static int output_celsius(struct jsontree_context *js_ctx);
+static int output_uptime(struct jsontree_context *js_ctx);
+
+#define SENSOR(n, name, unit, value)                                    \
+  static struct jsontree_string sensor_name_##n = JSONTREE_STRING(name); \
+  static struct jsontree_string sensor_unit_##n = JSONTREE_STRING(unit); \
+  static struct jsontree_int sensor_value_##n = { JSON_TYPE_INT, value }; \
+  JSONTREE_OBJECT(sensor_##n,                                           \
+                  JSONTREE_PAIR("name", &sensor_name_##n),              \
+                  JSONTREE_PAIR("unit", &sensor_unit_##n),              \
+                  JSONTREE_PAIR("value", &sensor_value_##n))
+
+SENSOR(0, "temperature", "mC", 21375);
+SENSOR(1, "humidity", "permille", 412);
+SENSOR(2, "pressure", "Pa", 101325);
+SENSOR(3, "light", "lx", 320);
+SENSOR(4, "battery", "mV", 2975);
+SENSOR(5, "co2", "ppm", 611);
+
+static struct jsontree_callback celsius_callback =
+  JSONTREE_CALLBACK(output_celsius, NULL);
+static struct jsontree_callback uptime_callback =
+  JSONTREE_CALLBACK(output_uptime, NULL);
+
+JSONTREE_OBJECT(sensors_tree,
+                JSONTREE_PAIR("temperature", &sensor_0),
+                JSONTREE_PAIR("humidity", &sensor_1),
+                JSONTREE_PAIR("pressure", &sensor_2),
+                JSONTREE_PAIR("light", &sensor_3),
+                JSONTREE_PAIR("battery", &sensor_4),
+                JSONTREE_PAIR("co2", &sensor_5));
+JSONTREE_OBJECT(tree,
+                JSONTREE_PAIR("node", &sensors_tree),
+                JSONTREE_PAIR("celsius", &celsius_callback),
+                JSONTREE_PAIR("uptime", &uptime_callback));
+
+static struct jsontree_context js_ctx;
+
+static void res_get_handler(void *request, void *response, uint8_t *buffer,
+                            uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_sensors, "title=\"Sensors\";ct=\"50 60\"",
+         res_get_handler, NULL, NULL, NULL);
+
+static coap_packet_t request;
+static coap_packet_t response;
+static uint8_t buffer[REST_MAX_CHUNK_SIZE];
+static unsigned long blocks;
+static unsigned long transferred;
+
+PROCESS(cbor_bench_process, "CBOR benchmark");
+AUTOSTART_PROCESSES(&cbor_bench_process);
+/*---------------------------------------------------------------------------*/
+static int
+output_celsius(struct jsontree_context *js_ctx)
+{
+  jsontree_write_atom(js_ctx, "21.37");
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+output_uptime(struct jsontree_context *js_ctx)
+{
+  jsontree_write_int(js_ctx, 86400);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_tree(char *buf, int format)
+{
+  int len;
+  int pos;
+
+  jsontree_setup(&js_ctx, (struct jsontree_value *)&tree, NULL);
+  js_ctx.format = format;
+  pos = 0;
+  do {
+    len = jsontree_print_buffer(&js_ctx, buf + pos, REST_MAX_CHUNK_SIZE);
+    pos += len;
+  } while(len == REST_MAX_CHUNK_SIZE && pos + len <= OUTPUT_SIZE);
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+write_json(void)
+{
+  return write_tree(json, JSONTREE_FORMAT_JSON);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+write_cbor(void)
+{
+  return write_tree(cbor, JSONTREE_FORMAT_CBOR);
+}
+/*---------------------------------------------------------------------------*/
+/* Adds the names, strings and numbers read to a checksum, to compare
+   what the parsers read */
+static unsigned long
+checksum(unsigned long sum, int type, const char *value, int number)
+{
+  sum = sum * 31 + type;
+  if(type == JSON_TYPE_NUMBER) {
+    sum = sum * 31 + number;
+  } else {
+    while(*value != '\0') {
+      sum = sum * 31 + *value++;
+    }
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+read_json(void)
+{
+  struct jsonparse_state state;
+  char value[VALUE_SIZE];
+  unsigned long sum;
+  int type;
+
+  sum = 0;
+  jsonparse_setup(&state, json, json_len);
+  while((type = jsonparse_next(&state)) != 0) {
+    if(type == JSON_TYPE_PAIR_NAME || type == JSON_TYPE_STRING ||
+       type == JSON_TYPE_NUMBER) {
+      jsonparse_copy_value(&state, value, sizeof(value));
+      sum = checksum(sum, type, value, jsonparse_get_value_as_int(&state));
+    }
+  }
+  return state.error == JSON_ERROR_OK ? sum : 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+read_cbor(void)
+{
+  struct cbor_state state;
+  char value[VALUE_SIZE];
+  unsigned long sum;
+  int type;
+
+  sum = 0;
+  cbor_setup(&state, (const uint8_t *)cbor, cbor_len);
+  while((type = cbor_next(&state)) != 0) {
+    if(type == JSON_TYPE_PAIR_NAME || type == JSON_TYPE_STRING ||
+       type == JSON_TYPE_NUMBER) {
+      cbor_copy_value(&state, value, sizeof(value));
+      sum = checksum(sum, type, value, cbor_get_value_as_int(&state));
+    } else if(type == JSON_TYPE_ERROR) {
+      return 0;
+    }
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer,
+                uint16_t preferred_size, int32_t *offset)
+{
+  static const unsigned int formats[] = { APPLICATION_JSON, APPLICATION_CBOR };
+  int32_t skip;
+  int format;
+  int len;
+
+  format = rest_select_content_format(request, response, formats,
+                                      sizeof(formats) / sizeof(formats[0]));
+  if(format < 0) {
+    return;
+  }
+
+  jsontree_setup(&js_ctx, (struct jsontree_value *)&tree, NULL);
+  js_ctx.format = format == APPLICATION_CBOR ?
+    JSONTREE_FORMAT_CBOR : JSONTREE_FORMAT_JSON;
+
+  /* Write the blocks before this one again to continue after them */
+  len = 0;
+  for(skip = *offset; skip > 0; skip -= len) {
+    len = jsontree_print_buffer(&js_ctx, (char *)buffer,
+                                skip < preferred_size ? skip : preferred_size);
+    if(len == 0) {
+      break;
+    }
+  }
+
+  len = jsontree_print_buffer(&js_ctx, (char *)buffer, preferred_size);
+  REST.set_response_payload(response, buffer, len);
+  *offset = len < preferred_size ? -1 : *offset + len;
+}
+/*---------------------------------------------------------------------------*/
+/* Gets the resource block by block, returns the content-format */
+static int
+get(int accept)
+{
+  const uint8_t *payload;
+  unsigned int format;
+  int32_t offset;
+
+  blocks = 0;
+  transferred = 0;
+  offset = 0;
+  do {
+    coap_init_message(&request, COAP_TYPE_CON, COAP_GET, 0);
+    coap_init_message(&response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+    coap_set_header_uri_path(&request, "sensors");
+    if(accept >= 0) {
+      coap_set_header_accept(&request, accept);
+    }
+    rest_invoke_restful_service(&request, &response, buffer, sizeof(buffer),
+                                &offset);
+    if(response.code != CONTENT_2_05) {
+      return -response.code;
+    }
+    blocks++;
+    transferred += coap_get_payload(&response, &payload);
+  } while(offset != -1);
+
+  coap_get_header_content_format(&response, &format);
+  return format;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+get_json(void)
+{
+  return get(APPLICATION_JSON);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+get_cbor(void)
+{
+  return get(APPLICATION_CBOR);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, unsigned long (*run)(void), unsigned long expect)
+{
+  struct bench b;
+  unsigned long result;
+  int i;
+
+  result = run();
+  if(result != expect) {
+    printf("cbor-bench: %s: got %lu, expected %lu\n", name, result, expect);
+    return;
+  }
+
+  BENCH_RUN(&b, i, run());
+
+  printf("cbor-bench: %s %lu ns/run\n", name, bench_ns_per_op(&b));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(cbor_bench_process, ev, data)
+{
+  static unsigned long sum;
+  static int format;
+
+  PROCESS_BEGIN();
+
+  rest_init_engine();
+  rest_activate_resource(&res_sensors, "sensors");
+
+  json_len = write_json();
+  cbor_len = write_cbor();
+  printf("cbor-bench: JSON %d bytes, CBOR %d bytes (%d%%)\n",
+         json_len, cbor_len, cbor_len * 100 / json_len);
+
+  bench("write JSON", write_json, json_len);
+  bench("write CBOR", write_cbor, cbor_len);
+
+  sum = read_json();
+  bench("read JSON", read_json, sum);
+  bench("read CBOR", read_cbor, sum);
+
+  format = get(-1);
+  printf("cbor-bench: GET without Accept: content-format %d, %lu blocks\n",
+         format, blocks);
+  format = get(TEXT_PLAIN);
+  printf("cbor-bench: GET accepting text/plain: %d.%02d\n",
+         -format >> 5, -format & 0x1f);
+  format = get(APPLICATION_JSON);
+  printf("cbor-bench: GET JSON: %lu blocks, %lu bytes\n",
+         blocks, transferred);
+  format = get(APPLICATION_CBOR);
+  printf("cbor-bench: GET CBOR: %lu blocks, %lu bytes\n",
+         blocks, transferred);
+
+  bench("GET JSON", get_json, APPLICATION_JSON);
+  bench("GET CBOR", get_cbor, APPLICATION_CBOR);
+
+  printf("cbor-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
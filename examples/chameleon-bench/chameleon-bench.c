@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         Per-packet cost of packing and unpacking Chameleon headers
+ *         for the Rime primitives. Each round trip creates the header
+ *         of a channel with chameleon_create() and parses it back
+ *         with chameleon_parse(). The checksum of the created headers
+ *         must not change between builds with different
+ *         CHAMELEON_CONF_MODULE or CHAMELEON_CONF_BITOPT_PLANS
+ *         settings.
+ */
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "lib/crc16.h"
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PAYLOAD_LEN 32
+
+static struct broadcast_conn broadcast;
+static struct unicast_conn unicast;
+static struct runicast_conn runicast;
+static struct multihop_conn multihop;
+static struct trickle_conn trickle;
+
+static const struct {
+  const char *name;
+  uint16_t channel;
+} channels[] = {
+  { "broadcast", 129 },
+  { "unicast", 130 },
+  { "runicast", 131 },
+  { "multihop", 132 },
+  { "trickle", 133 },
+};
+
+static uint8_t payload[PAYLOAD_LEN];
+static uint8_t frame[PACKETBUF_SIZE + PACKETBUF_HDR_SIZE];
+
+PROCESS(chameleon_bench_process, "Chameleon benchmark");
+AUTOSTART_PROCESSES(&chameleon_bench_process);
+/*---------------------------------------------------------------------------*/
+static packetbuf_attr_t
+attr_value(const struct packetbuf_attrlist *a, uint8_t seed)
+{
+  return (seed + a->type) & ((1UL << a->len) - 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+addr_value(const struct packetbuf_attrlist *a, uint8_t seed, linkaddr_t *addr)
+{
+  uint8_t i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    addr->u8[i] = seed + a->type + i;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_attributes(const struct channel *c, uint8_t seed)
+{
+  const struct packetbuf_attrlist *a;
+  linkaddr_t addr;
+
+  for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
+    if(PACKETBUF_IS_ADDR(a->type)) {
+      addr_value(a, seed, &addr);
+      packetbuf_set_addr(a->type, &addr);
+    } else {
+      packetbuf_set_attr(a->type, attr_value(a, seed));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+check_attributes(const struct channel *c, uint8_t seed)
+{
+  const struct packetbuf_attrlist *a;
+  linkaddr_t addr;
+
+  for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
+    if(PACKETBUF_IS_ADDR(a->type)) {
+      addr_value(a, seed, &addr);
+      if(!linkaddr_cmp(packetbuf_addr(a->type), &addr)) {
+        return 0;
+      }
+    } else if(packetbuf_attr(a->type) != attr_value(a, seed)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+round_trip(struct channel *c, uint8_t seed, unsigned short *crc)
+{
+  int len;
+
+  packetbuf_copyfrom(payload, sizeof(payload));
+  set_attributes(c, seed);
+  if(chameleon_create(c) == 0) {
+    return 0;
+  }
+  len = packetbuf_copyto(frame);
+  *crc = crc16_data(frame, packetbuf_hdrlen(), *crc);
+
+  packetbuf_copyfrom(frame, len);
+  return chameleon_parse() == c;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_channel(const char *name, uint16_t channelno)
+{
+  struct channel *c;
+  struct bench b;
+  unsigned short crc;
+  uint8_t i;
+
+  c = channel_lookup(channelno);
+  if(c == NULL) {
+    printf("chameleon-bench: %s channel %u not open\n", name, channelno);
+    return;
+  }
+
+  /* Headers from one batch, to compare between builds. */
+  crc = 0;
+  for(i = 0; i < BENCH_BATCH; i++) {
+    if(!round_trip(c, i, &crc) || !check_attributes(c, i)) {
+      printf("chameleon-bench: %s round trip failed\n", name);
+      return;
+    }
+  }
+
+  printf("chameleon-bench: %s hdr %u bits crc 0x%04x\n",
+         name, c->hdrsize, crc);
+
+  BENCH_RUN(&b, i, round_trip(c, i, &crc));
+
+  printf("chameleon-bench: %s %lu packets/s %lu ns/packet\n",
+         name, bench_per_second(&b, 1), bench_ns_per_op(&b));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(chameleon_bench_process, ev, data)
+{
+  static struct etimer et;
+  static uint8_t n;
+
+  PROCESS_BEGIN();
+
+  for(n = 0; n < sizeof(payload); n++) {
+    payload[n] = n;
+  }
+
+  broadcast_open(&broadcast, channels[0].channel, NULL);
+  unicast_open(&unicast, channels[1].channel, NULL);
+  runicast_open(&runicast, channels[2].channel, NULL);
+  multihop_open(&multihop, channels[3].channel, NULL);
+  trickle_open(&trickle, CLOCK_SECOND, channels[4].channel, NULL);
+
+  for(n = 0; n < sizeof(channels) / sizeof(channels[0]); n++) {
+    bench_channel(channels[n].name, channels[n].channel);
+    etimer_set(&et, 1);
+    PROCESS_WAIT_UNTIL(etimer_expired(&et));
+  }
+
+  printf("chameleon-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
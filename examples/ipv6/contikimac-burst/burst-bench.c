@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         ContikiMAC burst benchmark. Nodes with odd IDs announce
+ *         themselves on the link; nodes with even IDs stream UDP
+ *         datagrams that span several 6LoWPAN fragments to the first
+ *         one they hear. Both sides report the datagram and frame rate
+ *         and the radio-on time spent per kilobyte.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/netstack.h"
+#include "net/ip/simple-udp.h"
+#include "sys/energest.h"
+#include "sys/node-id.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define UDP_PORT          4321
+#define IS_RECEIVER       (node_id & 1)
+
+/* 320 bytes of payload take about five 802.15.4 frames */
+#define DATAGRAM_SIZE     320
+#define FRAMES_PER_DATAGRAM 5
+#define SEND_INTERVAL     (CLOCK_SECOND / 2)
+#define REPORT_INTERVAL   (30 * CLOCK_SECOND)
+#define ANNOUNCE_INTERVAL (5 * CLOCK_SECOND)
+
+static struct simple_udp_connection conn;
+static uip_ipaddr_t sink_addr;
+static uint8_t have_receiver;
+
+static unsigned long datagrams;
+static unsigned long bytes;
+static unsigned long radio_base;
+static clock_time_t start;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(burst_bench_process, "ContikiMAC burst benchmark");
+AUTOSTART_PROCESSES(&burst_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+radio_on_time(void)
+{
+  energest_flush();
+  return energest_type_time(ENERGEST_TYPE_LISTEN) +
+    energest_type_time(ENERGEST_TYPE_TRANSMIT);
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *role)
+{
+  unsigned long elapsed_ms;
+  unsigned long radio_ms;
+
+  elapsed_ms = (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND;
+  radio_ms = (radio_on_time() - radio_base) * 1000 / RTIMER_ARCH_SECOND;
+  if(elapsed_ms == 0 || bytes < 1024) {
+    return;
+  }
+  printf("burst-bench: %s datagrams %lu bytes %lu ms %lu pps %lu fps %lu radio-on %lu ms/KB\n",
+         role, datagrams, bytes, elapsed_ms,
+         datagrams * 1000 / elapsed_ms,
+         datagrams * FRAMES_PER_DATAGRAM * 1000 / elapsed_ms,
+         radio_ms / (bytes / 1024));
+}
+/*---------------------------------------------------------------------------*/
+static void
+start_measurement(void)
+{
+  datagrams = 0;
+  bytes = 0;
+  start = clock_time();
+  radio_base = radio_on_time();
+}
+/*---------------------------------------------------------------------------*/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  if(IS_RECEIVER) {
+    if(datagrams == 0 && bytes == 0) {
+      start_measurement();
+    }
+    datagrams++;
+    bytes += datalen;
+  } else if(!have_receiver) {
+    /* An announcement: this is who we stream to */
+    uip_ipaddr_copy(&sink_addr, sender_addr);
+    have_receiver = 1;
+    process_poll(&burst_bench_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(burst_bench_process, ev, data)
+{
+  static struct etimer et;
+  static struct etimer report_timer;
+  static uint8_t buf[DATAGRAM_SIZE];
+  uip_ipaddr_t addr;
+
+  PROCESS_BEGIN();
+
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, receiver);
+
+  if(IS_RECEIVER) {
+    /* Announce ourselves until the first datagram arrives */
+    while(bytes == 0) {
+      etimer_set(&et, ANNOUNCE_INTERVAL);
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+      uip_create_linklocal_allnodes_mcast(&addr);
+      simple_udp_sendto(&conn, "R", 1, &addr);
+    }
+    etimer_set(&report_timer, REPORT_INTERVAL);
+    while(1) {
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&report_timer));
+      etimer_reset(&report_timer);
+      report("rx");
+    }
+  }
+
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL && have_receiver);
+  printf("burst-bench: streaming, max burst %u\n", CONTIKIMAC_CONF_MAX_BURST);
+
+  memset(buf, 'b', sizeof(buf));
+  start_measurement();
+  etimer_set(&report_timer, REPORT_INTERVAL);
+  etimer_set(&et, SEND_INTERVAL);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et) ||
+                             etimer_expired(&report_timer));
+    if(etimer_expired(&report_timer)) {
+      etimer_reset(&report_timer);
+      report("tx");
+    }
+    if(etimer_expired(&et)) {
+      etimer_reset(&et);
+      simple_udp_sendto(&conn, buf, sizeof(buf), &sink_addr);
+      datagrams++;
+      bytes += sizeof(buf);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
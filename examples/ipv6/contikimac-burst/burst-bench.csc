@@ -0,0 +1,222 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[APPS_DIR]/mrm</project>
+  <project EXPORT="discard">[APPS_DIR]/mspsim</project>
+  <project EXPORT="discard">[APPS_DIR]/avrora</project>
+  <project EXPORT="discard">[APPS_DIR]/serial_socket</project>
+  <project EXPORT="discard">[APPS_DIR]/collect-view</project>
+  <project EXPORT="discard">[APPS_DIR]/powertracker</project>
+  <simulation>
+    <title>ContikiMAC burst benchmark, bursts and one frame per rendezvous</title>
+    <randomseed>1</randomseed>
+    <motedelay_us>10000000</motedelay_us>
+    <radiomedium>
+      org.contikios.cooja.radiomediums.UDGM
+      <transmitting_range>50.0</transmitting_range>
+      <interference_range>0.0</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>1.0</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      org.contikios.cooja.mspmote.SkyMoteType
+      <identifier>sky0</identifier>
+      <description>Burst bench, one frame per rendezvous</description>
+      <source EXPORT="discard">[CONTIKI_DIR]/examples/ipv6/contikimac-burst/burst-bench.c</source>
+      <commands EXPORT="discard">make clean TARGET=sky
+make burst-bench.sky TARGET=sky DEFINES=CONTIKIMAC_CONF_MAX_BURST=1
+cp burst-bench.sky burst-bench-baseline.sky</commands>
+      <firmware EXPORT="copy">[CONTIKI_DIR]/examples/ipv6/contikimac-burst/burst-bench-baseline.sky</firmware>
+      <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyLED</moteinterface>
+    </motetype>
+    <motetype>
+      org.contikios.cooja.mspmote.SkyMoteType
+      <identifier>sky1</identifier>
+      <description>Burst bench</description>
+      <source EXPORT="discard">[CONTIKI_DIR]/examples/ipv6/contikimac-burst/burst-bench.c</source>
+      <commands EXPORT="discard">make clean TARGET=sky
+make burst-bench.sky TARGET=sky</commands>
+      <firmware EXPORT="copy">[CONTIKI_DIR]/examples/ipv6/contikimac-burst/burst-bench.sky</firmware>
+      <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyLED</moteinterface>
+    </motetype>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>10.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>1.0</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>1</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>30.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>1.0</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>2</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>210.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>1.0</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>3</id>
+      </interface_config>
+      <motetype_identifier>sky0</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>230.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>1.0</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>4</id>
+      </interface_config>
+      <motetype_identifier>sky0</motetype_identifier>
+    </mote>
+  </simulation>
+  <plugin>
+    org.contikios.cooja.plugins.SimControl
+    <width>265</width>
+    <z>2</z>
+    <height>200</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.LogListener
+    <plugin_config>
+      <filter>burst-bench</filter>
+      <formatted_time />
+      <coloring />
+    </plugin_config>
+    <width>539</width>
+    <z>0</z>
+    <height>319</height>
+    <location_x>0</location_x>
+    <location_y>200</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>TIMEOUT(600000);
+
+/* Nodes 2 -&gt; 1 send in bursts, nodes 4 -&gt; 3 one frame per
+   rendezvous (CONTIKIMAC_CONF_MAX_BURST=1); the two pairs are out of
+   range of each other. The test fails if a node never reports. With
+   bursts, the receiver must keep up with the sender, and the sender
+   must spend clearly less radio-on time per kilobyte than the
+   baseline. */
+MIN_REPORTS = 5;
+MIN_DELIVERY = 0.9;
+MAX_RADIO_RATIO = 0.75;
+
+stats = {};
+reports = {};
+function enough(n) {
+  return reports[n] &amp;&amp; reports[n] &gt;= MIN_REPORTS;
+}
+while (!(enough(1) &amp;&amp; enough(2) &amp;&amp; enough(3) &amp;&amp; enough(4))) {
+  YIELD();
+  if (msg.startsWith('burst-bench:')) {
+    log.log(id + ": " + msg + "\n");
+    f = msg.split(' ');
+    if (f[2] == 'datagrams') {
+      stats[id] = {
+        datagrams: parseInt(f[3]),
+        ms: parseInt(f[7]),
+        fps: parseInt(f[11]),
+        radio: parseInt(f[13])
+      };
+      reports[id] = (reports[id] ? reports[id] : 0) + 1;
+    }
+  }
+}
+
+function rate(s) {
+  return s.datagrams * 1000 / s.ms;
+}
+delivery = rate(stats[1]) / rate(stats[2]);
+ratio = stats[2].radio / stats[4].radio;
+log.log("burst: " + rate(stats[1]).toFixed(2) + " datagrams/s received, " +
+        stats[1].fps + " frames/s, sender radio-on " + stats[2].radio + " ms/KB\n");
+log.log("baseline: " + rate(stats[3]).toFixed(2) + " datagrams/s received, " +
+        stats[3].fps + " frames/s, sender radio-on " + stats[4].radio + " ms/KB\n");
+log.log("delivery " + (100 * delivery).toFixed(1) + "%, radio-on " +
+        (100 * ratio).toFixed(1) + "% of baseline\n");
+
+if (delivery &lt; MIN_DELIVERY) {
+  log.log("burst receiver falls behind the sender\n");
+  log.testFailed();
+}
+if (ratio &gt; MAX_RADIO_RATIO) {
+  log.log("bursts do not save radio-on time\n");
+  log.testFailed();
+}
+log.testOK();</script>
+      <active>true</active>
+    </plugin_config>
+    <width>503</width>
+    <z>1</z>
+    <height>643</height>
+    <location_x>539</location_x>
+    <location_y>1</location_y>
+  </plugin>
+</simconf>
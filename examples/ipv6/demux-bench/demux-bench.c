@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         Per-packet cost of the uIPv6 receive path for UDP datagrams
+ *         and TCP segments of one of 10, 100 or 200 open connections,
+ *         and for TCP segments that match no connection. Build with
+ *         UIP_CONF_DEMUX_BUCKETS=0 to compare with searching the
+ *         connection tables.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PACKETS     2000000UL
+#define REMOTE_PORT 5683
+#define REMOTE_ISS  1000
+
+#define IP_BUF  ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+#define TCP_BUF ((struct uip_tcp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+/* TCP flags, as in uip6.c */
+#define TCP_RST 0x04
+#define TCP_SYN 0x02
+#define TCP_ACK 0x10
+
+static const uint16_t levels[] = { 10, 100, 200 };
+
+static struct uip_udp_conn *udp_conns[UIP_UDP_CONNS];
+static struct uip_conn *tcp_conns[UIP_CONNS];
+static uint16_t open_conns;
+
+static uip_ipaddr_t remote;
+static uip_ipaddr_t local;
+
+static uint8_t packets[16][UIP_IPTCPH_LEN];
+static uint16_t packet_len;
+/*---------------------------------------------------------------------------*/
+PROCESS(demux_bench_process, "uIP demux benchmark");
+AUTOSTART_PROCESSES(&demux_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ns_per_op(rtimer_clock_t start, rtimer_clock_t end, unsigned long ops)
+{
+  unsigned long elapsed = (rtimer_clock_t)(end - start);
+
+  return elapsed * (1000000000UL / RTIMER_ARCH_SECOND) / ops;
+}
+/*---------------------------------------------------------------------------*/
+static void
+ip_header(uint8_t proto, uint16_t len)
+{
+  memset(IP_BUF, 0, UIP_IPH_LEN);
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[0] = len >> 8;
+  IP_BUF->len[1] = len & 0xff;
+  IP_BUF->proto = proto;
+  IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, &remote);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, &local);
+  uip_len = UIP_IPH_LEN + len;
+  uip_ext_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_packet(struct uip_udp_conn *conn)
+{
+  ip_header(UIP_PROTO_UDP, UIP_UDPH_LEN);
+  UDP_BUF->srcport = UIP_HTONS(REMOTE_PORT);
+  UDP_BUF->destport = conn->lport;
+  UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN);
+  /* No checksum, so that only the demultiplexing differs */
+  UDP_BUF->udpchksum = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_packet(uint16_t lport, uint16_t rport, uint32_t seqno,
+           const uint8_t *ackno, uint8_t flags)
+{
+  ip_header(UIP_PROTO_TCP, UIP_TCPH_LEN);
+  memset(TCP_BUF, 0, UIP_TCPH_LEN);
+  TCP_BUF->srcport = rport;
+  TCP_BUF->destport = lport;
+  TCP_BUF->seqno[0] = seqno >> 24;
+  TCP_BUF->seqno[1] = seqno >> 16;
+  TCP_BUF->seqno[2] = seqno >> 8;
+  TCP_BUF->seqno[3] = seqno;
+  if(ackno != NULL) {
+    memcpy(TCP_BUF->ackno, ackno, 4);
+  }
+  TCP_BUF->tcpoffset = 5 << 4;
+  TCP_BUF->flags = flags;
+  TCP_BUF->wnd[0] = UIP_TCP_MSS >> 8;
+  TCP_BUF->wnd[1] = UIP_TCP_MSS & 0xff;
+  TCP_BUF->tcpchksum = ~(uip_tcpchksum());
+}
+/*---------------------------------------------------------------------------*/
+static void
+save_packet(int i)
+{
+  packet_len = uip_len;
+  memcpy(packets[i], &uip_buf[UIP_LLH_LEN], uip_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+input_packet(int i)
+{
+  memcpy(&uip_buf[UIP_LLH_LEN], packets[i], packet_len);
+  uip_len = packet_len;
+  uip_input();
+  uip_clear_buf();
+}
+/*---------------------------------------------------------------------------*/
+/* Opens UDP and TCP connections up to n, and completes the handshakes */
+static int
+open_connections(uint16_t n)
+{
+  uint8_t ackno[4];
+  struct uip_conn *conn;
+
+  for(; open_conns < n; open_conns++) {
+    udp_conns[open_conns] = udp_new(&remote, UIP_HTONS(REMOTE_PORT), NULL);
+    if(udp_conns[open_conns] == NULL) {
+      return 0;
+    }
+    udp_bind(udp_conns[open_conns], UIP_HTONS(20000 + open_conns));
+
+    conn = tcp_connect(&remote, UIP_HTONS(REMOTE_PORT + 1 + open_conns),
+                       NULL);
+    if(conn == NULL) {
+      return 0;
+    }
+    tcp_conns[open_conns] = conn;
+
+    /* The SYN-ACK from the remote end */
+    memcpy(ackno, conn->snd_nxt, 4);
+    if(++ackno[3] == 0 && ++ackno[2] == 0 && ++ackno[1] == 0) {
+      ++ackno[0];
+    }
+    tcp_packet(conn->lport, conn->rport, REMOTE_ISS, ackno,
+               TCP_SYN | TCP_ACK);
+    uip_input();
+    uip_clear_buf();
+    if(conn->tcpstateflags != UIP_ESTABLISHED) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+run(void (*make)(uint16_t))
+{
+  unsigned long i;
+  rtimer_clock_t start;
+  int k;
+
+  /* Packets for connections spread over the table */
+  for(k = 0; k < 16; k++) {
+    make((k * 37) % open_conns);
+    save_packet(k);
+  }
+
+  start = RTIMER_NOW();
+  for(i = 0; i < PACKETS; i++) {
+    input_packet(i & 15);
+  }
+  return ns_per_op(start, RTIMER_NOW(), PACKETS);
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_udp(uint16_t i)
+{
+  udp_packet(udp_conns[i]);
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_tcp(uint16_t i)
+{
+  /* An ACK without data, which changes nothing */
+  tcp_packet(tcp_conns[i]->lport, tcp_conns[i]->rport, REMOTE_ISS + 1,
+             tcp_conns[i]->snd_nxt, TCP_ACK);
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_tcp_miss(uint16_t i)
+{
+  /* A reset for a connection that does not exist is dropped */
+  tcp_packet(UIP_HTONS(9), UIP_HTONS(9 + i), REMOTE_ISS, NULL, TCP_RST);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(demux_bench_process, ev, data)
+{
+  static unsigned long udp, tcp, miss;
+  static uint8_t n;
+
+  PROCESS_BEGIN();
+
+  uip_ip6addr(&remote, 0xfe80, 0, 0, 0, 0x0212, 0x7400, 0x0001, 0x0002);
+  uip_ipaddr_copy(&local, &uip_ds6_get_link_local(-1)->ipaddr);
+
+  printf("demux-bench: %u buckets\n", UIP_DEMUX_BUCKETS);
+
+  for(n = 0; n < sizeof(levels) / sizeof(levels[0]); n++) {
+    if(!open_connections(levels[n])) {
+      printf("demux-bench: could not open %u connections\n", levels[n]);
+      break;
+    }
+    udp = run(make_udp);
+    tcp = run(make_tcp);
+    miss = run(make_tcp_miss);
+    printf("demux-bench: %3u connections udp %lu ns/pkt, tcp %lu ns/pkt, "
+           "tcp no match %lu ns/pkt\n", open_conns, udp, tcp, miss);
+    for(udp = 0; udp < open_conns; udp++) {
+      if(tcp_conns[udp]->tcpstateflags != UIP_ESTABLISHED) {
+        printf("demux-bench: connection %lu was closed\n", udp);
+      }
+    }
+  }
+
+  printf("demux-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Per-packet cost of the "is this destination ours" check on the
+ *         uIPv6 receive path, with the address list scans the input path
+ *         used to perform versus uip_ds6_is_my_dest().
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+
+#include <stdio.h>
+
+#define PACKETS 1000000UL
+/*---------------------------------------------------------------------------*/
+PROCESS(ds6_bench_process, "uip-ds6 benchmark");
+AUTOSTART_PROCESSES(&ds6_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ns_per_op(rtimer_clock_t start, rtimer_clock_t end, unsigned long ops)
+{
+  unsigned long elapsed = (rtimer_clock_t)(end - start);
+
+  return elapsed * (1000000000UL / RTIMER_ARCH_SECOND) / ops;
+}
+/*---------------------------------------------------------------------------*/
+/* What uip_process() did before: scan the unicast, then the multicast list */
+static int
+scan_lists(uip_ipaddr_t *addr)
+{
+  uip_ds6_element_t *e;
+
+  if(uip_ds6_list_loop((uip_ds6_element_t *)uip_ds6_if.addr_list,
+                       UIP_DS6_ADDR_NB, sizeof(uip_ds6_addr_t), addr, 128,
+                       &e) == FOUND) {
+    return 1;
+  }
+  return uip_ds6_list_loop((uip_ds6_element_t *)uip_ds6_if.maddr_list,
+                           UIP_DS6_MADDR_NB, sizeof(uip_ds6_maddr_t), addr,
+                           128, &e) == FOUND;
+}
+/*---------------------------------------------------------------------------*/
+static void
+run(const char *name, uip_ipaddr_t *dests, uint8_t n)
+{
+  unsigned long i;
+  unsigned long mine;
+  rtimer_clock_t start;
+  unsigned long before;
+  unsigned long after;
+
+  mine = 0;
+  start = RTIMER_NOW();
+  for(i = 0; i < PACKETS; i++) {
+    mine += scan_lists(&dests[i % n]);
+  }
+  before = ns_per_op(start, RTIMER_NOW(), PACKETS);
+
+  start = RTIMER_NOW();
+  for(i = 0; i < PACKETS; i++) {
+    mine -= uip_ds6_is_my_dest(&dests[i % n]);
+  }
+  after = ns_per_op(start, RTIMER_NOW(), PACKETS);
+
+  printf("ds6-bench: %-10s list scan %lu ns/pkt, filter %lu ns/pkt%s\n",
+         name, before, after, mine != 0 ? " MISMATCH" : "");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(ds6_bench_process, ev, data)
+{
+  static uip_ipaddr_t fwd[8];
+  static uip_ipaddr_t local[4];
+  uip_ipaddr_t addr;
+  uint8_t i;
+
+  PROCESS_BEGIN();
+
+  /* Fill the interface: global addresses, groups and an anycast address */
+  for(i = 0; i < UIP_DS6_ADDR_NBU; i++) {
+    uip_ip6addr(&addr, 0xaaaa, i, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(&addr, &uip_lladdr);
+    uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+  }
+  for(i = 0; i < UIP_DS6_MADDR_NBU; i++) {
+    uip_ip6addr(&addr, 0xff1e, 0, 0, 0, 0, 0, 0x89, 0xabc0 + i);
+    uip_ds6_maddr_add(&addr);
+  }
+  uip_ip6addr(&addr, 0xaaaa, 1, 0, 0, 0, 0, 0, 0);
+  uip_ds6_aaddr_add(&addr);
+
+  /* Forwarded traffic: same prefixes, other nodes */
+  for(i = 0; i < 8; i++) {
+    uip_ip6addr(&fwd[i], 0xaaaa, i & 3, 0, 0, 0x0212, 0x7400, i, 0x0101 * i);
+  }
+  /* Local traffic: our unicast, a joined group, all-nodes, solicited-node */
+  uip_ip6addr(&local[0], 0xaaaa, 2, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&local[0], &uip_lladdr);
+  uip_ip6addr(&local[1], 0xff1e, 0, 0, 0, 0, 0, 0x89, 0xabc2);
+  uip_create_linklocal_allnodes_mcast(&local[2]);
+  uip_create_solicited_node(&local[0], &local[3]);
+
+  run("forwarded", fwd, 8);
+  run("local", local, 4);
+
+  printf("ds6-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         Loss of bursts of UDP datagrams that arrive while uIP is
+ *         processing the first one, and input throughput, with a
+ *         single packet buffer or a pool of UIP_CONF_PACKET_BUFS.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BURSTS      1000
+#define PACKETS     200000UL
+#define PORT        7000
+#define PAYLOAD_LEN 32
+
+#define IP_BUF  ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+static const uint8_t bursts[] = { 2, 4, 8, 16 };
+
+static uint8_t packet[UIP_IPUDPH_LEN + PAYLOAD_LEN];
+
+/* The packets of a burst that arrive while the first one is processed */
+static uint8_t arriving;
+static unsigned long received, lost;
+/*---------------------------------------------------------------------------*/
+PROCESS(input_queue_bench_process, "uIP input queue benchmark");
+PROCESS(receiver_process, "Receiver");
+AUTOSTART_PROCESSES(&input_queue_bench_process, &receiver_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ns_per_op(rtimer_clock_t start, rtimer_clock_t end, unsigned long ops)
+{
+  unsigned long elapsed = (rtimer_clock_t)(end - start);
+
+  return elapsed * (1000000000UL / RTIMER_ARCH_SECOND) / ops;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(void)
+{
+  uint16_t len = UIP_UDPH_LEN + PAYLOAD_LEN;
+
+  memset(&uip_buf[UIP_LLH_LEN], 0, sizeof(packet));
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[0] = len >> 8;
+  IP_BUF->len[1] = len & 0xff;
+  IP_BUF->proto = UIP_PROTO_UDP;
+  IP_BUF->ttl = 64;
+  uip_ip6addr(&IP_BUF->srcipaddr, 0xfe80, 0, 0, 0, 0x0212, 0x7400, 1, 2);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, &uip_ds6_get_link_local(-1)->ipaddr);
+  UDP_BUF->srcport = UIP_HTONS(PORT);
+  UDP_BUF->destport = UIP_HTONS(PORT);
+  UDP_BUF->udplen = UIP_HTONS(len);
+  uip_len = UIP_IPH_LEN + len;
+  uip_ext_len = 0;
+  UDP_BUF->udpchksum = ~(uip_udpchksum());
+  if(UDP_BUF->udpchksum == 0) {
+    UDP_BUF->udpchksum = 0xffff;
+  }
+  memcpy(packet, &uip_buf[UIP_LLH_LEN], sizeof(packet));
+  uip_clear_buf();
+}
+/*---------------------------------------------------------------------------*/
+/* A packet from the driver while the stack is using uip_buf */
+static void
+driver_receive_busy(void)
+{
+#if UIP_PACKET_BUFS > 1
+  uip_buf_t *buf;
+
+  buf = tcpip_input_alloc();
+  if(buf != NULL) {
+    memcpy(&buf->u8[UIP_LLH_LEN], packet, sizeof(packet));
+    tcpip_input_queue(buf, sizeof(packet));
+    return;
+  }
+#endif /* UIP_PACKET_BUFS > 1 */
+  lost++;
+}
+/*---------------------------------------------------------------------------*/
+/* A packet from the driver while the stack is idle */
+static void
+driver_receive(int queue)
+{
+  memcpy(&uip_buf[UIP_LLH_LEN], packet, sizeof(packet));
+  uip_len = sizeof(packet);
+#if UIP_PACKET_BUFS > 1
+  if(queue) {
+    if(!tcpip_input_enqueue()) {
+      lost++;
+    }
+    return;
+  }
+#endif /* UIP_PACKET_BUFS > 1 */
+  tcpip_input();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(receiver_process, ev, data)
+{
+  static struct uip_udp_conn *conn;
+
+  PROCESS_BEGIN();
+
+  conn = udp_new(NULL, 0, NULL);
+  udp_bind(conn, UIP_HTONS(PORT));
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event && uip_newdata());
+    received++;
+    while(arriving > 0) {
+      arriving--;
+      driver_receive_busy();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(input_queue_bench_process, ev, data)
+{
+  static unsigned long i, sent;
+  static uint8_t b, batch;
+  static rtimer_clock_t start;
+
+  PROCESS_BEGIN();
+
+  /* Let the receiver set up its connection */
+  PROCESS_PAUSE();
+
+  make_packet();
+  printf("input-queue-bench: %u packet buffers\n", UIP_PACKET_BUFS);
+
+  for(b = 0; b < sizeof(bursts); b++) {
+    received = lost = 0;
+    for(i = 0; i < BURSTS; i++) {
+      arriving = bursts[b] - 1;
+      driver_receive(0);
+      /* Let the queued packets be processed */
+      PROCESS_PAUSE();
+    }
+    sent = (unsigned long)BURSTS * bursts[b];
+    printf("input-queue-bench: burst %2u lost %lu of %lu (%lu%%), "
+           "%lu received\n", bursts[b], lost, sent, lost * 100 / sent,
+           received);
+  }
+
+  /* Batches as large as the pool holds, one packet at a time with the
+     single buffer */
+  batch = UIP_PACKET_BUFS > 1 ? UIP_PACKET_BUFS - 1 : 1;
+  received = lost = 0;
+  start = RTIMER_NOW();
+  for(i = 0; i < PACKETS; i += batch) {
+    for(b = 0; b < batch; b++) {
+      driver_receive(1);
+    }
+    PROCESS_PAUSE();
+  }
+  printf("input-queue-bench: batches of %u: %lu ns/pkt, %lu received, "
+         "%lu lost\n", batch, ns_per_op(start, RTIMER_NOW(), i), received,
+         lost);
+
+  printf("input-queue-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
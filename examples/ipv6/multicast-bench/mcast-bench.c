@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Benchmark for the multicast routing table and the ROLL TM engine.
+ *         Floods many groups from many seeds through the engine's input
+ *         path and prints the CPU cost per datagram.
+ *
+ *         Build with MCAST_BENCH_CONF_INDEXED=0 to compare against the
+ *         unindexed code paths.
+ */
+
+#include "contiki.h"
+#include "contiki-lib.h"
+#include "contiki-net.h"
+#include "net/ipv6/multicast/uip-mcast6.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define GROUPS     UIP_MCAST6_ROUTE_CONF_ROUTES
+#define SEEDS      ROLL_TM_CONF_WINS
+#define LOOKUPS    2000000UL
+#define DATAGRAMS  200000UL
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_HBHO_BUF ((uint8_t *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+
+/* Trickle multicast HBH option with a long (elided) seed ID, padded to 8 */
+#define HBHO_LEN 8
+#define PAYLOAD_LEN 16
+/*---------------------------------------------------------------------------*/
+PROCESS(mcast_bench_process, "Multicast benchmark");
+AUTOSTART_PROCESSES(&mcast_bench_process);
+/*---------------------------------------------------------------------------*/
+static uint16_t seq[SEEDS];
+/*---------------------------------------------------------------------------*/
+static void
+group_addr(uip_ipaddr_t *addr, uint16_t g)
+{
+  uip_ip6addr(addr, 0xff1e, 0, 0, 0, 0, 0, 0x89, g);
+}
+/*---------------------------------------------------------------------------*/
+static void
+build_datagram(uint16_t seed, uint16_t group, uint16_t seq_val)
+{
+  uint8_t *hbho;
+
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN + HBHO_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  UIP_IP_BUF->ttl = 64;
+  UIP_IP_BUF->len[1] = HBHO_LEN + PAYLOAD_LEN;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xaaaa, 0, 0, 0, 0x0212, 0x7400, 0, seed + 1);
+  group_addr(&UIP_IP_BUF->destipaddr, group);
+
+  hbho = UIP_HBHO_BUF;
+  hbho[0] = UIP_PROTO_UDP;          /* Next header */
+  hbho[1] = 0;                      /* Length in 8-octet units, minus one */
+  hbho[2] = 0x0C;                   /* Trickle multicast option */
+  hbho[3] = 2;                      /* Option length, long seed */
+  hbho[4] = 0x80 | ((seq_val >> 8) & 0x7F);
+  hbho[5] = seq_val & 0xFF;
+  hbho[6] = UIP_EXT_HDR_OPT_PADN;
+  hbho[7] = 0;
+
+  uip_len = UIP_IPH_LEN + HBHO_LEN + PAYLOAD_LEN;
+  uip_ext_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ns_per_op(rtimer_clock_t start, rtimer_clock_t end, unsigned long ops)
+{
+  unsigned long elapsed = (rtimer_clock_t)(end - start);
+
+  return elapsed * (1000000000UL / RTIMER_ARCH_SECOND) / ops;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_routes(void)
+{
+  uip_ipaddr_t addr;
+  unsigned long i;
+  unsigned long hits;
+  rtimer_clock_t start;
+  uint16_t g;
+
+  uip_mcast6_route_init();
+  for(g = 0; g < GROUPS; g++) {
+    group_addr(&addr, g * 3);
+    uip_mcast6_route_add(&addr);
+  }
+
+  hits = 0;
+  start = RTIMER_NOW();
+  for(i = 0; i < LOOKUPS; i++) {
+    /* Two out of three lookups miss */
+    group_addr(&addr, i % (GROUPS * 3));
+    if(uip_mcast6_route_lookup(&addr) != NULL) {
+      hits++;
+    }
+  }
+  printf("mcast-bench: route lookup, %u groups: %lu ns/op (%lu hits)\n",
+         GROUPS, ns_per_op(start, RTIMER_NOW(), LOOKUPS), hits);
+
+  hits = 0;
+  start = RTIMER_NOW();
+  for(i = 0; i < LOOKUPS; i++) {
+    group_addr(&addr, (i * 3) % (GROUPS * 3));
+    if(uip_mcast6_route_decision(&addr) & UIP_MCAST6_ROUTE_FWD) {
+      hits++;
+    }
+  }
+  printf("mcast-bench: forwarding decision, %u groups: %lu ns/op (%lu fwd)\n",
+         GROUPS, ns_per_op(start, RTIMER_NOW(), LOOKUPS), hits);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_engine(void)
+{
+  unsigned long i;
+  unsigned long accepted;
+  rtimer_clock_t start;
+  uint16_t s;
+
+  /* New datagrams: every seed floods every group in turn */
+  accepted = 0;
+  start = RTIMER_NOW();
+  for(i = 0; i < DATAGRAMS; i++) {
+    s = i % SEEDS;
+    seq[s] = (seq[s] + 1) & 0x7FFF;
+    build_datagram(s, i % GROUPS, seq[s]);
+    UIP_MCAST6.in();
+    accepted++;
+  }
+  printf("mcast-bench: %s in, new datagrams, %u seeds: %lu ns/pkt\n",
+         UIP_MCAST6.name, SEEDS, ns_per_op(start, RTIMER_NOW(), accepted));
+
+  /* Duplicates: replay the most recent datagram of each seed */
+  start = RTIMER_NOW();
+  for(i = 0; i < DATAGRAMS; i++) {
+    s = i % SEEDS;
+    build_datagram(s, i % GROUPS, seq[s]);
+    UIP_MCAST6.in();
+  }
+  printf("mcast-bench: %s in, duplicates, %u seeds: %lu ns/pkt\n",
+         UIP_MCAST6.name, SEEDS, ns_per_op(start, RTIMER_NOW(), DATAGRAMS));
+
+  uip_clear_buf();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(mcast_bench_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  /* Let the stack come up before we start feeding it datagrams */
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  bench_routes();
+  bench_engine();
+
+  printf("mcast-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -39,6 +39,10 @@
 #undef UIP_CONF_BUFFER_SIZE
 #define UIP_CONF_BUFFER_SIZE    1280
 
+/* Receive bursts from tun into a pool of packet buffers */
+#undef UIP_CONF_PACKET_BUFS
+#define UIP_CONF_PACKET_BUFS     8
+
 #undef UIP_CONF_RECEIVE_WINDOW
 #define UIP_CONF_RECEIVE_WINDOW  60
 
@@ -242,6 +242,21 @@ tun_input(unsigned char *data, int maxlen)
   return size;
 }
 
+/*---------------------------------------------------------------------------*/
+#if UIP_PACKET_BUFS > 1
+static int
+tun_readable(void)
+{
+  fd_set rset;
+  struct timeval tv;
+
+  FD_ZERO(&rset);
+  FD_SET(tunfd, &rset);
+  tv.tv_sec = 0;
+  tv.tv_usec = 0;
+  return select(tunfd + 1, &rset, NULL, NULL, &tv) > 0;
+}
+#endif /* UIP_PACKET_BUFS > 1 */
 /*---------------------------------------------------------------------------*/
 static void
 init(void)
@@ -294,10 +309,20 @@ handle_fd(fd_set *rset, fd_set *wset)
     int size;
 
     if(FD_ISSET(tunfd, rset)) {
-      size = tun_input(&uip_buf[UIP_LLH_LEN], sizeof(uip_buf));
+#if UIP_PACKET_BUFS > 1
+      /* Read the whole burst into the buffer pool, to be processed in
+         one go, unless packets are to be delayed */
+      do {
+        size = tun_input(&uip_buf[UIP_LLH_LEN], UIP_BUFSIZE - UIP_LLH_LEN);
+        uip_len = size;
+      } while(tcpip_input_enqueue() && !slip_config_basedelay &&
+              tun_readable());
+#else /* UIP_PACKET_BUFS > 1 */
+      size = tun_input(&uip_buf[UIP_LLH_LEN], UIP_BUFSIZE - UIP_LLH_LEN);
       /* printf("TUN data incoming read:%d\n", size); */
       uip_len = size;
       tcpip_input();
+#endif /* UIP_PACKET_BUFS > 1 */
 
       if(slip_config_basedelay) {
         struct timeval tv;
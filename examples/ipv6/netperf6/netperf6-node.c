@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         A node with the netperf6 shell command. Two nodes measure
+ *         the link between them; a native node measures its own
+ *         stack over a loopback, or with NETPERF6_NODE_CONF_TAP the
+ *         link to another native node on a tap interface.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "shell.h"
+#include "serial-shell.h"
+#include "shell-netperf6.h"
+#include "netperf6.h"
+
+#include <string.h>
+
+#ifdef NETPERF6_NODE_CONF_TAP
+#define NETPERF6_NODE_TAP NETPERF6_NODE_CONF_TAP
+#else /* NETPERF6_NODE_CONF_TAP */
+#define NETPERF6_NODE_TAP 0
+#endif /* NETPERF6_NODE_CONF_TAP */
+
+#if CONTIKI_TARGET_NATIVE && NETPERF6_NODE_TAP
+#include "net/ip/uip-debug.h"
+#include "net/tapdev-drv.h"
+#include "tapdev6.h"
+#include <stdio.h>
+#include <stdlib.h>
+#endif /* CONTIKI_TARGET_NATIVE && NETPERF6_NODE_TAP */
+
+/*---------------------------------------------------------------------------*/
+PROCESS(netperf6_node_process, "netperf6 node");
+AUTOSTART_PROCESSES(&netperf6_node_process);
+/*---------------------------------------------------------------------------*/
+#if CONTIKI_TARGET_NATIVE && NETPERF6_NODE_TAP
+/*
+ * Ethernet on a tap interface. Every instance opens its own tap
+ * interface, and two instances bridged on the host measure the stack
+ * between two nodes. The node keeps its 802.15.4 address for IPv6 and
+ * neighbor discovery, and maps it to a locally administered Ethernet
+ * address on the wire.
+ */
+#define UIP_IP_BUF  ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_ETH_BUF ((struct uip_eth_hdr *)&uip_buf[0])
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+static void
+eth_addr(struct uip_eth_addr *eth, const uip_lladdr_t *lladdr)
+{
+  eth->addr[0] = 0x02;
+  memcpy(&eth->addr[1], &lladdr->addr[UIP_LLADDR_LEN - 5], 5);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+tap_output(const uip_lladdr_t *lladdr)
+{
+  if(lladdr == NULL) {
+    /* The multicast mapping of RFC 2464, section 7 */
+    UIP_ETH_BUF->dest.addr[0] = 0x33;
+    UIP_ETH_BUF->dest.addr[1] = 0x33;
+    memcpy(&UIP_ETH_BUF->dest.addr[2], &UIP_IP_BUF->destipaddr.u8[12], 4);
+  } else {
+    eth_addr(&UIP_ETH_BUF->dest, lladdr);
+  }
+  eth_addr(&UIP_ETH_BUF->src, &uip_lladdr);
+  UIP_ETH_BUF->type = UIP_HTONS(UIP_ETHTYPE_IPV6);
+  uip_len += sizeof(struct uip_eth_hdr);
+  tapdev_do_send();
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+tap_set_fd(fd_set *rset, fd_set *wset)
+{
+  FD_SET(tapdev_fd(), rset);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tap_handle_fd(fd_set *rset, fd_set *wset)
+{
+  if(FD_ISSET(tapdev_fd(), rset)) {
+    process_poll(&tapdev_process);
+  }
+}
+static const struct select_callback tap_callback = { tap_set_fd, tap_handle_fd };
+/*---------------------------------------------------------------------------*/
+/* Gives the node the number from the command line as the last byte of
+   its link-layer address, so that instances have addresses of their
+   own, and starts the tap interface. */
+static void
+tap_init(void)
+{
+  uip_ds6_addr_t *addr;
+  uip_ipaddr_t ipaddr;
+  linkaddr_t lladdr;
+
+  if(contiki_argc > 1) {
+    uip_lladdr.addr[UIP_LLADDR_LEN - 1] = atoi(contiki_argv[1]);
+    linkaddr_copy(&lladdr, &linkaddr_node_addr);
+    lladdr.u8[LINKADDR_SIZE - 1] = uip_lladdr.addr[UIP_LLADDR_LEN - 1];
+    linkaddr_set_node_addr(&lladdr);
+
+    addr = uip_ds6_get_link_local(-1);
+    if(addr != NULL) {
+      uip_ds6_addr_rm(addr);
+    }
+    uip_create_linklocal_prefix(&ipaddr);
+    uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
+    uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
+  }
+
+  process_start(&tapdev_process, NULL);
+  tcpip_set_outputfunc(tap_output);
+  select_set_callback(tapdev_fd(), &tap_callback);
+
+  addr = uip_ds6_get_link_local(-1);
+  if(addr != NULL) {
+    printf("netperf6-node: tap link-local address ");
+    uip_debug_ipaddr_print(&addr->ipaddr);
+    printf("\n");
+  }
+}
+/*---------------------------------------------------------------------------*/
+#elif CONTIKI_TARGET_NATIVE && UIP_PACKET_BUFS > 1
+/*
+ * The native platform has no radio to a second node, so packets to
+ * this node's own addresses come straight back as input. This measures
+ * the protocol stack alone.
+ */
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+static uint8_t
+loopback_output(const uip_lladdr_t *lladdr)
+{
+  union uip_packet_buf *buf;
+
+  /* Multicasts such as duplicate address detection stay on the node */
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
+    return 0;
+  }
+  buf = tcpip_input_alloc();
+  if(buf != NULL) {
+    memcpy(buf, uip_buf, UIP_LLH_LEN + uip_len);
+    tcpip_input_queue(buf, uip_len);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+loopback_init(void)
+{
+  uip_ds6_addr_t *addr;
+
+  addr = uip_ds6_get_link_local(-1);
+  if(addr != NULL) {
+    uip_ds6_nbr_add(&addr->ipaddr, &uip_lladdr, 0, NBR_REACHABLE);
+  }
+  tcpip_set_outputfunc(loopback_output);
+}
+#endif /* CONTIKI_TARGET_NATIVE && UIP_PACKET_BUFS > 1 */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(netperf6_node_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+#if CONTIKI_TARGET_NATIVE && NETPERF6_NODE_TAP
+  tap_init();
+#elif CONTIKI_TARGET_NATIVE && UIP_PACKET_BUFS > 1
+  loopback_init();
+#endif /* CONTIKI_TARGET_NATIVE && UIP_PACKET_BUFS > 1 */
+
+  netperf6_init();
+  serial_shell_init();
+  shell_netperf6_init();
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
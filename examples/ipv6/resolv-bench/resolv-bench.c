@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         Hit rate of the DNS resolver cache for clients that keep
+ *         looking up a few names, some of which do not exist, as
+ *         clients do that reconnect often. A simulated name server
+ *         answers each question after a delay, as over a mesh.
+ */
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "net/ip/resolv.h"
+#include "net/ip/uip-nameserver.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CLIENTS       4
+#define NAMES         8
+/* The last names do not exist */
+#define MISSING_NAMES 2
+#define TTL           4
+#define DELAY         (CLOCK_SECOND * 3 / 10)
+#define DURATION      (CLOCK_SECOND * 20)
+
+#define IP_BUF  ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UDP_BUF ((struct uip_udp_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+#define DNS_BUF (&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN])
+
+#define DNS_HDR_LEN  12
+#define MAX_QUESTION 48
+
+/* A question from the resolver that the server has yet to answer */
+static struct question {
+  clock_time_t time;
+  uint8_t data[MAX_QUESTION];
+  uint8_t len;
+  uint16_t port;
+} questions[NAMES];
+static uint8_t nquestions;
+
+static uip_ipaddr_t server;
+static uip_ipaddr_t local;
+static unsigned long answered;
+
+static char names[NAMES][16];
+/*---------------------------------------------------------------------------*/
+PROCESS(resolv_bench_process, "Resolver benchmark");
+PROCESS(server_process, "Name server");
+AUTOSTART_PROCESSES(&resolv_bench_process, &server_process);
+/*---------------------------------------------------------------------------*/
+/* Takes the questions sent to the server, and drops other packets */
+static uint8_t
+server_output(const uip_lladdr_t *lladdr)
+{
+  struct question *q;
+
+  if(IP_BUF->proto == UIP_PROTO_UDP &&
+     UDP_BUF->destport == UIP_HTONS(53) &&
+     uip_len - UIP_IPUDPH_LEN <= MAX_QUESTION &&
+     nquestions < NAMES) {
+    q = &questions[nquestions++];
+    q->time = clock_time();
+    q->len = uip_len - UIP_IPUDPH_LEN;
+    q->port = UDP_BUF->srcport;
+    memcpy(q->data, DNS_BUF, q->len);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+put16(uint8_t *p, uint16_t v)
+{
+  *p++ = v >> 8;
+  *p++ = v;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+put32(uint8_t *p, uint32_t v)
+{
+  return put16(put16(p, v >> 16), v);
+}
+/*---------------------------------------------------------------------------*/
+/* Answers a question with an address, or with "not found" and an SOA */
+static void
+answer(const struct question *q)
+{
+  uint8_t *p;
+  uint16_t len;
+  int missing;
+
+  /* The first label of the name, "hostN" */
+  missing = q->data[DNS_HDR_LEN + 5] - '0' >= NAMES - MISSING_NAMES;
+
+  p = DNS_BUF;
+  memcpy(p, q->data, q->len);
+  p[2] = 0x81;
+  p[3] = 0x80 | (missing ? 3 : 0);
+  put16(p + 6, missing ? 0 : 1);
+  put16(p + 8, missing ? 1 : 0);
+  p += q->len;
+
+  p = put16(p, 0xc00c);
+  if(missing) {
+    p = put16(p, 6);
+    p = put16(p, 1);
+    p = put32(p, TTL);
+    p = put16(p, 22);
+    *p++ = 0;
+    *p++ = 0;
+    p = put32(p, 1);
+    p = put32(p, TTL);
+    p = put32(p, TTL);
+    p = put32(p, TTL);
+    p = put32(p, TTL);
+  } else {
+    p = put16(p, 28);
+    p = put16(p, 1);
+    p = put32(p, TTL);
+    p = put16(p, 16);
+    uip_ip6addr((uip_ipaddr_t *)p, 0x2001, 0xdb8, 0, 0, 0, 0, 0,
+                q->data[DNS_HDR_LEN + 5]);
+    p += 16;
+  }
+  len = p - &uip_buf[UIP_LLH_LEN + UIP_IPH_LEN];
+
+  memset(IP_BUF, 0, UIP_IPUDPH_LEN);
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[0] = len >> 8;
+  IP_BUF->len[1] = len & 0xff;
+  IP_BUF->proto = UIP_PROTO_UDP;
+  IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, &server);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, &local);
+  UDP_BUF->srcport = UIP_HTONS(53);
+  UDP_BUF->destport = q->port;
+  UDP_BUF->udplen = UIP_HTONS(len);
+  uip_len = UIP_IPH_LEN + len;
+  uip_ext_len = 0;
+  UDP_BUF->udpchksum = ~(uip_udpchksum());
+  if(UDP_BUF->udpchksum == 0) {
+    UDP_BUF->udpchksum = 0xffff;
+  }
+  tcpip_input();
+  answered++;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(server_process, ev, data)
+{
+  static struct etimer et;
+  static struct question q;
+  uint8_t i;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    etimer_set(&et, CLOCK_SECOND / 20);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    while(nquestions > 0 &&
+          clock_time() - questions[0].time >= DELAY) {
+      q = questions[0];
+      for(i = 1; i < nquestions; i++) {
+        questions[i - 1] = questions[i];
+      }
+      nquestions--;
+      answer(&q);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+/* Names that come first are looked up more often */
+static const char *
+pick_name(void)
+{
+  uint16_t r;
+  uint8_t i;
+
+  r = random_rand();
+  for(i = 0; i < NAMES - 1 && (r & 1); i++) {
+    r >>= 1;
+  }
+  /* Make the missing names as common as the middle ones */
+  return names[(i + 3) % NAMES];
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(resolv_bench_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+  static unsigned long used, waited;
+  static const uip_lladdr_t server_lladdr = {{ 0x02, 0, 0, 0, 0, 0, 0, 0x53 }};
+  uip_ipaddr_t *addr;
+  uint8_t i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < NAMES; i++) {
+    sprintf(names[i], "host%u.example", i);
+  }
+
+  /* The name server is a neighbor, and gets what the node sends */
+  uip_ip6addr(&server, 0xfe80, 0, 0, 0, 0, 0, 0, 0x53);
+  uip_ipaddr_copy(&local, &uip_ds6_get_link_local(-1)->ipaddr);
+  uip_ds6_nbr_add(&server, &server_lladdr, 0, NBR_REACHABLE);
+  uip_nameserver_update(&server, UIP_NAMESERVER_INFINITE_LIFETIME);
+  tcpip_set_outputfunc(server_output);
+
+  printf("resolv-bench: %u clients, %u names (%u missing), ttl %u s, "
+         "prefetch %u s\n", CLIENTS, NAMES, MISSING_NAMES, TTL,
+         RESOLV_CONF_PREFETCH);
+
+  start = clock_time();
+  while(clock_time() - start < DURATION) {
+    etimer_set(&et, CLOCK_SECOND / 10);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+    /* Each client looks up a name, and asks for it unless it knows */
+    for(i = 0; i < CLIENTS; i++) {
+      const char *name = pick_name();
+
+      switch(resolv_lookup(name, &addr)) {
+      case RESOLV_STATUS_CACHED:
+      case RESOLV_STATUS_NOT_FOUND:
+        used++;
+        break;
+      default:
+        waited++;
+        resolv_query(name);
+        break;
+      }
+    }
+  }
+
+  printf("resolv-bench: %lu lookups answered, %lu had to wait\n",
+         used, waited);
+  printf("resolv-bench: hit rate %u%% (%u hits, %u not found, "
+         "%u lookups)\n",
+         (resolv_stats.hits + resolv_stats.negative_hits) * 100 /
+         resolv_stats.lookups, resolv_stats.hits,
+         resolv_stats.negative_hits, resolv_stats.lookups);
+  printf("resolv-bench: %u queries, %u coalesced, %u from the cache, "
+         "%u prefetches, %u questions sent, %lu answered\n",
+         resolv_stats.queries, resolv_stats.coalesced,
+         resolv_stats.cache_answers, resolv_stats.prefetches,
+         resolv_stats.sent, answered);
+
+  printf("resolv-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -44,6 +44,11 @@
 #if WITH_ORCHESTRA
 #include "orchestra.h"
 #endif /* WITH_ORCHESTRA */
+#if WITH_TRAFFIC
+#include "simple-udp.h"
+#include "lib/random.h"
+#include "net/mac/tsch/tsch-private.h"
+#endif /* WITH_TRAFFIC */
 
 #define DEBUG DEBUG_PRINT
 #include "net/ip/uip-debug.h"
@@ -61,6 +66,55 @@ AUTOSTART_PROCESSES(&node_process, &sensors_process);
 AUTOSTART_PROCESSES(&node_process);
 #endif /* CONFIG_VIA_BUTTON */
 
+/*---------------------------------------------------------------------------*/
+#if WITH_TRAFFIC
+#define TRAFFIC_PORT 5678
+
+/* What each node sends to the root: the root logs the latency in slots */
+struct traffic_msg {
+  uint16_t seq;
+  uint32_t asn;
+};
+
+static struct simple_udp_connection traffic_conn;
+/*---------------------------------------------------------------------------*/
+static void
+traffic_receiver(struct simple_udp_connection *c,
+                 const uip_ipaddr_t *sender_addr,
+                 uint16_t sender_port,
+                 const uip_ipaddr_t *receiver_addr,
+                 uint16_t receiver_port,
+                 const uint8_t *data,
+                 uint16_t datalen)
+{
+  struct traffic_msg msg;
+
+  if(datalen != sizeof(msg)) {
+    return;
+  }
+  memcpy(&msg, data, sizeof(msg));
+  printf("Traffic: received from %u seq %u latency %lu slots\n",
+         sender_addr->u8[15], msg.seq,
+         (unsigned long)(current_asn.ls4b - msg.asn));
+}
+/*---------------------------------------------------------------------------*/
+static void
+traffic_send(void)
+{
+  static uint16_t seq;
+  struct traffic_msg msg;
+  rpl_dag_t *dag;
+
+  dag = rpl_get_any_dag();
+  if(dag == NULL || !tsch_is_associated) {
+    return;
+  }
+  msg.seq = ++seq;
+  msg.asn = current_asn.ls4b;
+  printf("Traffic: sent seq %u\n", msg.seq);
+  simple_udp_sendto(&traffic_conn, &msg, sizeof(msg), &dag->dag_id);
+}
+#endif /* WITH_TRAFFIC */
 /*---------------------------------------------------------------------------*/
 static void
 print_network_status(void)
@@ -131,6 +185,9 @@ net_init(uip_ipaddr_t *br_prefix)
 PROCESS_THREAD(node_process, ev, data)
 {
   static struct etimer et;
+#if WITH_TRAFFIC
+  static struct etimer traffic_et;
+#endif /* WITH_TRAFFIC */
   PROCESS_BEGIN();
 
   /* 3 possible roles:
@@ -142,8 +199,8 @@ PROCESS_THREAD(node_process, ev, data)
   static enum { role_6ln, role_6dr, role_6dr_sec } node_role;
   node_role = role_6ln;
   
-  /* Set node with ID == 1 as coordinator, convenient in Cooja. */
-  if(node_id == 1) {
+  /* Set node with ID == ROOT_ID as coordinator, convenient in Cooja. */
+  if(node_id == ROOT_ID) {
     if(LLSEC802154_CONF_SECURITY_LEVEL) {
       node_role = role_6dr_sec;
     } else {
@@ -197,12 +254,33 @@ PROCESS_THREAD(node_process, ev, data)
   orchestra_init();
 #endif /* WITH_ORCHESTRA */
   
+#if WITH_TRAFFIC
+  simple_udp_register(&traffic_conn, TRAFFIC_PORT, NULL, TRAFFIC_PORT,
+                      traffic_receiver);
+  etimer_set(&traffic_et, TRAFFIC_INTERVAL);
+#endif /* WITH_TRAFFIC */
+
   /* Print out routing tables every minute */
   etimer_set(&et, CLOCK_SECOND * 60);
-  while(1) {      
-    print_network_status();
-    PROCESS_YIELD_UNTIL(etimer_expired(&et));
-    etimer_reset(&et);
+  print_network_status();
+  while(1) {
+    PROCESS_YIELD();
+#if WITH_TRAFFIC
+    if(ev == PROCESS_EVENT_TIMER && data == &traffic_et) {
+      /* Nodes send a burst every TRAFFIC_INTERVAL, at a random time */
+      etimer_set(&traffic_et, TRAFFIC_INTERVAL / 2 + random_rand() % (TRAFFIC_INTERVAL / 2));
+      if(!is_coordinator) {
+        static int i;
+        for(i = 0; i < TRAFFIC_BURST; i++) {
+          traffic_send();
+        }
+      }
+    }
+#endif /* WITH_TRAFFIC */
+    if(etimer_expired(&et)) {
+      print_network_status();
+      etimer_reset(&et);
+    }
   }
   
   PROCESS_END();
@@ -40,6 +40,21 @@
 #define WITH_ORCHESTRA 0
 #endif /* WITH_ORCHESTRA */
 
+/* Set to add Orchestra's traffic-adaptive unicast rule */
+#ifndef WITH_ORCHESTRA_ADAPTIVE
+#define WITH_ORCHESTRA_ADAPTIVE 0
+#endif /* WITH_ORCHESTRA_ADAPTIVE */
+
+/* Set to have nodes send bursts of UDP packets to the root */
+#ifndef WITH_TRAFFIC
+#define WITH_TRAFFIC 0
+#endif /* WITH_TRAFFIC */
+
+/* The node that acts as coordinator and RPL root, convenient in Cooja */
+#ifndef ROOT_ID
+#define ROOT_ID 1
+#endif /* ROOT_ID */
+
 /* Set to enable TSCH security */
 #ifndef WITH_SECURITY
 #define WITH_SECURITY 0
@@ -108,6 +123,9 @@
 /* TSCH uses the ASN rather than frame counter to construct the Nonce */
 #undef LLSEC802154_CONF_USES_FRAME_COUNTER
 #define LLSEC802154_CONF_USES_FRAME_COUNTER 0
+/* Keep the schedules of both k1 and k2 expanded */
+#undef AES_128_CONF_KEY_CACHE_SIZE
+#define AES_128_CONF_KEY_CACHE_SIZE 2
 
 #endif /* WITH_SECURITY */
 
@@ -122,8 +140,20 @@
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_ADDED_CALLBACK orchestra_callback_child_added
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed
 
+#if WITH_ORCHESTRA_ADAPTIVE
+#define ORCHESTRA_CONF_RULES { &eb_per_time_source, &unicast_adaptive, &unicast_per_neighbor, &default_common }
+#define RPL_CALLBACK_DAO_OPTION_OUTPUT orchestra_callback_dao_option_output
+#define RPL_CALLBACK_DAO_OPTION_INPUT orchestra_callback_dao_option_input
+#endif /* WITH_ORCHESTRA_ADAPTIVE */
+
 #endif /* WITH_ORCHESTRA */
 
+#if WITH_TRAFFIC
+/* Each node sends TRAFFIC_BURST packets every TRAFFIC_INTERVAL on average */
+#define TRAFFIC_INTERVAL (4 * CLOCK_SECOND)
+#define TRAFFIC_BURST 3
+#endif /* WITH_TRAFFIC */
+
 /*******************************************************/
 /************* Other system configuration **************/
 /*******************************************************/
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         Parse and serialize throughput of the JSON library: a 2 KB
+ *         document parsed with jsonparse and with the streaming
+ *         tokenizer in one chunk and in 64 byte chunks, and a tree
+ *         written with jsontree through putchar and into 64 byte
+ *         buffers.
+ */
+
+#include "contiki.h"
+#include "jsonparse.h"
+#include "jsonsax.h"
+#include "jsontree.h"
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define DOC_SIZE   2048
+#define CHUNK_SIZE 64
+
+static char doc[DOC_SIZE];
+static int doc_len;
+
+static char output[DOC_SIZE];
+static int output_len;
+static char reference[DOC_SIZE];
+static int reference_len;
+
+static unsigned long tokens;
+
+/* Eight sensors and the time since boot, written by a callback */
+static int output_uptime(struct jsontree_context *js_ctx);
+
+#define SENSOR(n, name, unit, value)                                    \
+  static struct jsontree_string sensor_name_##n = JSONTREE_STRING(name); \
+  static struct jsontree_string sensor_unit_##n = JSONTREE_STRING(unit); \
+  static struct jsontree_int sensor_value_##n = { JSON_TYPE_INT, value }; \
+  JSONTREE_OBJECT(sensor_##n,                                           \
+                  JSONTREE_PAIR("name", &sensor_name_##n),              \
+                  JSONTREE_PAIR("unit", &sensor_unit_##n),              \
+                  JSONTREE_PAIR("value", &sensor_value_##n))
+
+SENSOR(0, "temperature", "mC", 21375);
+SENSOR(1, "humidity", "permille", 412);
+SENSOR(2, "pressure", "Pa", 10132);
+SENSOR(3, "light", "lx", 320);
+SENSOR(4, "battery", "mV", 2975);
+SENSOR(5, "rssi", "dBm", -71);
+SENSOR(6, "co2", "ppm", 611);
+SENSOR(7, "noise", "dB", 38);
+
+static struct jsontree_callback uptime_callback =
+  JSONTREE_CALLBACK(output_uptime, NULL);
+
+JSONTREE_OBJECT(sensors_tree,
+                JSONTREE_PAIR("temperature", &sensor_0),
+                JSONTREE_PAIR("humidity", &sensor_1),
+                JSONTREE_PAIR("pressure", &sensor_2),
+                JSONTREE_PAIR("light", &sensor_3),
+                JSONTREE_PAIR("battery", &sensor_4),
+                JSONTREE_PAIR("rssi", &sensor_5),
+                JSONTREE_PAIR("co2", &sensor_6),
+                JSONTREE_PAIR("noise", &sensor_7));
+JSONTREE_OBJECT(tree,
+                JSONTREE_PAIR("node", &sensors_tree),
+                JSONTREE_PAIR("uptime", &uptime_callback));
+
+static struct jsontree_context js_ctx;
+static struct jsonsax_state sax;
+
+PROCESS(json_bench_process, "JSON benchmark");
+AUTOSTART_PROCESSES(&json_bench_process);
+/*---------------------------------------------------------------------------*/
+static int
+output_uptime(struct jsontree_context *js_ctx)
+{
+  jsontree_write_int(js_ctx, 86400);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_doc(void)
+{
+  int i;
+
+  doc_len = snprintf(doc, DOC_SIZE, "{\"node\":\"bench\",\"readings\":[");
+  for(i = 0; doc_len < DOC_SIZE - 200; i++) {
+    doc_len += snprintf(doc + doc_len, DOC_SIZE - doc_len,
+                        "%s{\"id\":%d,\"name\":\"sensor-%d\","
+                        "\"value\":%d,\"tags\":[\"indoor\",\"level %d\"]}",
+                        i > 0 ? "," : "", i, i, i * 137, i % 4);
+  }
+  doc_len += snprintf(doc + doc_len, DOC_SIZE - doc_len, "]}");
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+parse_jsonparse(void)
+{
+  struct jsonparse_state state;
+  unsigned long count;
+  int type;
+
+  count = 0;
+  jsonparse_setup(&state, doc, doc_len);
+  while((type = jsonparse_next(&state)) != 0) {
+    if(type == JSON_TYPE_OBJECT || type == JSON_TYPE_ARRAY ||
+       type == JSON_TYPE_PAIR_NAME || type == JSON_TYPE_STRING ||
+       type == JSON_TYPE_NUMBER) {
+      count++;
+    }
+  }
+  return state.error == JSON_ERROR_OK ? count : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+count_event(struct jsonsax_state *state, int type, const char *value, int len)
+{
+  if(!state->partial && type != JSONSAX_END_OBJECT &&
+     type != JSONSAX_END_ARRAY) {
+    tokens++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+parse_jsonsax(int chunk)
+{
+  int pos;
+  int len;
+
+  tokens = 0;
+  jsonsax_setup(&sax, count_event, NULL);
+  for(pos = 0; pos < doc_len; pos += len) {
+    len = doc_len - pos < chunk ? doc_len - pos : chunk;
+    if(jsonsax_feed(&sax, doc + pos, len) != JSON_ERROR_OK) {
+      return 0;
+    }
+  }
+  return jsonsax_end(&sax) == JSON_ERROR_OK ? tokens : 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+parse_one_chunk(void)
+{
+  return parse_jsonsax(DOC_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+parse_chunks(void)
+{
+  return parse_jsonsax(CHUNK_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static int
+output_putchar(int c)
+{
+  if(output_len < DOC_SIZE) {
+    output[output_len++] = c;
+  }
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+serialize_putchar(void)
+{
+  output_len = 0;
+  jsontree_setup(&js_ctx, (struct jsontree_value *)&tree, output_putchar);
+  while(jsontree_print_next(&js_ctx) && js_ctx.path <= js_ctx.depth);
+  return output_len;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+serialize_buffer(int size)
+{
+  int len;
+
+  output_len = 0;
+  jsontree_setup(&js_ctx, (struct jsontree_value *)&tree, output_putchar);
+  do {
+    len = jsontree_print_buffer(&js_ctx, output + output_len, size);
+    output_len += len;
+  } while(len == size && output_len + size <= DOC_SIZE);
+  return output_len;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+serialize_one_buffer(void)
+{
+  return serialize_buffer(DOC_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+serialize_buffers(void)
+{
+  return serialize_buffer(CHUNK_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, unsigned long (*run)(void), unsigned long expect,
+      int bytes)
+{
+  struct bench b;
+  unsigned long result;
+  int i;
+
+  result = run();
+  if(result != expect) {
+    printf("json-bench: %s: got %lu, expected %lu\n", name, result, expect);
+    return;
+  }
+  if(run == serialize_one_buffer || run == serialize_buffers) {
+    if(output_len != reference_len ||
+       memcmp(output, reference, reference_len) != 0) {
+      printf("json-bench: %s: output differs\n", name);
+      return;
+    }
+  }
+
+  BENCH_RUN(&b, i, run());
+
+  printf("json-bench: %s %lu ns/run %lu kB/s\n", name,
+         bench_ns_per_op(&b), bench_per_second(&b, bytes) / 1000);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(json_bench_process, ev, data)
+{
+  static unsigned long count;
+
+  PROCESS_BEGIN();
+
+  make_doc();
+  count = parse_jsonparse();
+  printf("json-bench: document %d bytes, %lu tokens\n", doc_len, count);
+
+  bench("parse jsonparse", parse_jsonparse, count, doc_len);
+  bench("parse jsonsax", parse_one_chunk, count, doc_len);
+  bench("parse jsonsax 64 byte chunks", parse_chunks, count, doc_len);
+
+  reference_len = serialize_putchar();
+  memcpy(reference, output, reference_len);
+  printf("json-bench: tree %d bytes\n", reference_len);
+
+  bench("serialize putchar", serialize_putchar, reference_len, reference_len);
+  bench("serialize buffer", serialize_one_buffer, reference_len,
+        reference_len);
+  bench("serialize 64 byte buffers", serialize_buffers, reference_len,
+        reference_len);
+
+  printf("json-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
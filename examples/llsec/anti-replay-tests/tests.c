@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Tests for the anti-replay window
+ */
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/llsec/anti-replay.h"
+#include "net/llsec/llsec802154.h"
+#include <stdio.h>
+
+static struct anti_replay_info info;
+
+/*---------------------------------------------------------------------------*/
+static void
+set_frame(uint32_t counter, int broadcast)
+{
+  frame802154_frame_counter_t reordered_counter;
+
+  packetbuf_clear();
+  reordered_counter.u32 = LLSEC802154_HTONL(counter);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_0_1, reordered_counter.u16[0]);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_2_3, reordered_counter.u16[1]);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER,
+      broadcast ? &linkaddr_null : &linkaddr_node_addr);
+}
+/*---------------------------------------------------------------------------*/
+static int
+replayed(uint32_t counter, int broadcast)
+{
+  set_frame(counter, broadcast);
+  return anti_replay_was_replayed(&info);
+}
+/*---------------------------------------------------------------------------*/
+static void
+result(int success)
+{
+  printf("%s\n", success ? "Success" : "Failure");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(anti_replay_tests_process, "Anti-replay tests process");
+AUTOSTART_PROCESSES(&anti_replay_tests_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(anti_replay_tests_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  set_frame(100, 0);
+  anti_replay_init_info(&info);
+
+  printf("Testing increasing counters ... ");
+  result(!replayed(101, 0) && !replayed(105, 0) && !replayed(106, 1));
+
+  printf("Testing replayed counters ... ");
+  result(replayed(100, 0) && replayed(101, 0) && replayed(105, 0)
+      && replayed(106, 1) && replayed(100, 1));
+
+#if ANTI_REPLAY_WINDOW
+  printf("Testing reordered counters ... ");
+  result(!replayed(103, 0) && !replayed(102, 0) && !replayed(104, 1));
+
+  printf("Testing reordered counters replayed ... ");
+  result(replayed(103, 0) && replayed(102, 0) && replayed(104, 1));
+
+  printf("Testing counters below the window ... ");
+  result(replayed(105 - ANTI_REPLAY_WINDOW, 0)
+      && !replayed(105 + ANTI_REPLAY_WINDOW - 1, 0)
+      && replayed(105, 0)
+      && replayed(104, 0)
+      && !replayed(106, 0)
+      && replayed(106, 0));
+#endif /* ANTI_REPLAY_WINDOW */
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
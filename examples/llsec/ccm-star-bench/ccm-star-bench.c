@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Throughput of the AES-128 drivers and of CCM* on frame-sized
+ *         inputs, in bytes per second. CCM* runs on the configured
+ *         AES_128; rebuild with DEFINES=AES_128_CONF=<driver> to
+ *         compare drivers.
+ */
+
+#include "contiki.h"
+#include "lib/aes-128.h"
+#include "lib/ccm-star.h"
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MIC_LEN 8
+
+static const struct {
+  const char *name;
+  const struct aes_128_driver *driver;
+} drivers[] = {
+  { "software", &aes_128_driver },
+  { "table", &aes_128_table_driver },
+  { "default", &AES_128 },
+};
+
+/* Header and payload lengths of typical 802.15.4 frames */
+static const struct {
+  uint8_t a_len;
+  uint8_t m_len;
+} frames[] = {
+  { 21, 0 },
+  { 21, 16 },
+  { 21, 48 },
+  { 21, 80 },
+  { 11, 102 },
+};
+
+static uint8_t key[AES_128_KEY_LENGTH];
+static uint8_t nonce[CCM_STAR_NONCE_LENGTH];
+static uint8_t frame[127];
+
+PROCESS(ccm_star_bench_process, "CCM* benchmark");
+AUTOSTART_PROCESSES(&ccm_star_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+bench_aes(const char *name, const struct aes_128_driver *driver)
+{
+  uint8_t block[AES_128_BLOCK_SIZE];
+  struct bench b;
+  uint8_t i;
+
+  memset(block, 0, sizeof(block));
+  driver->set_key(key);
+  BENCH_RUN(&b, i, driver->encrypt(block));
+
+  printf("ccm-star-bench: aes %s %lu bytes/s\n",
+         name, bench_per_second(&b, AES_128_BLOCK_SIZE));
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_ccm_star(uint8_t a_len, uint8_t m_len, int forward)
+{
+  uint8_t mic[MIC_LEN];
+  struct bench b;
+  uint8_t i;
+
+  CCM_STAR.set_key(key);
+  BENCH_RUN(&b, i, {
+      nonce[CCM_STAR_NONCE_LENGTH - 1] = i;
+      CCM_STAR.aead(nonce, frame + a_len, m_len, frame, a_len,
+                    mic, MIC_LEN, forward);
+    });
+
+  printf("ccm-star-bench: ccm* %s a %u m %u %lu bytes/s\n",
+         forward ? "encrypt" : "decrypt", a_len, m_len,
+         bench_per_second(&b, a_len + m_len));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(ccm_star_bench_process, ev, data)
+{
+  static struct etimer et;
+  static uint8_t n;
+
+  PROCESS_BEGIN();
+
+  for(n = 0; n < sizeof(key); n++) {
+    key[n] = n;
+  }
+  for(n = 0; n < sizeof(frame); n++) {
+    frame[n] = n;
+  }
+
+  for(n = 0; n < sizeof(drivers) / sizeof(drivers[0]); n++) {
+    bench_aes(drivers[n].name, drivers[n].driver);
+    etimer_set(&et, 1);
+    PROCESS_WAIT_UNTIL(etimer_expired(&et));
+  }
+
+  for(n = 0; n < sizeof(frames) / sizeof(frames[0]); n++) {
+    bench_ccm_star(frames[n].a_len, frames[n].m_len, 1);
+    bench_ccm_star(frames[n].a_len, frames[n].m_len, 0);
+    etimer_set(&et, 1);
+    PROCESS_WAIT_UNTIL(etimer_expired(&et));
+  }
+
+  printf("ccm-star-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
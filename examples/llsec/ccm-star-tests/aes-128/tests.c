@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Known-answer tests for the AES-128 drivers and CCM*
+ */
+
+#include "contiki.h"
+#include "lib/aes-128.h"
+#include "lib/ccm-star.h"
+#include <stdio.h>
+#include <string.h>
+
+#define LONG_M_LEN   100
+#define LONG_A_LEN   21
+
+static const struct {
+  const char *name;
+  const struct aes_128_driver *driver;
+} drivers[] = {
+  { "software", &aes_128_driver },
+  { "table", &aes_128_table_driver },
+  { "default", &AES_128 },
+};
+
+/* FIPS-197, Appendix C.1 */
+static const uint8_t fips_key[AES_128_KEY_LENGTH] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+  0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+};
+static const uint8_t fips_plaintext[AES_128_BLOCK_SIZE] = {
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+  0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+static const uint8_t fips_ciphertext[AES_128_BLOCK_SIZE] = {
+  0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30,
+  0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A
+};
+
+/* RFC 3610, Packet Vector #1 */
+static const uint8_t ccm_key[AES_128_KEY_LENGTH] = {
+  0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+  0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF
+};
+static const uint8_t ccm_nonce[CCM_STAR_NONCE_LENGTH] = {
+  0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0,
+  0xA1, 0xA2, 0xA3, 0xA4, 0xA5
+};
+static const uint8_t ccm_a[8] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07
+};
+static const uint8_t ccm_m[23] = {
+  0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+  0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E
+};
+static const uint8_t ccm_oracle[23 + 8] = {
+  0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2,
+  0xF0, 0x66, 0xD0, 0xC2, 0xC0, 0xF9, 0x89, 0x80,
+  0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84, 0x17,
+  0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0
+};
+
+/* A frame-sized message spanning several blocks, with a full-length MIC */
+static const uint8_t long_oracle[LONG_M_LEN + 16] = {
+  0x53, 0x8F, 0x8C, 0x89, 0x72, 0xED, 0x40, 0xE9,
+  0xDB, 0x35, 0x8B, 0x81, 0x83, 0xB2, 0xFA, 0xFB,
+  0x06, 0x3C, 0xF0, 0xF2, 0x49, 0x48, 0x07, 0x5B,
+  0xCF, 0xBE, 0x25, 0xC6, 0x19, 0xA3, 0xD8, 0x53,
+  0xFD, 0xC8, 0x64, 0xD2, 0x13, 0x39, 0x66, 0x9F,
+  0xA9, 0x8C, 0x3B, 0x6F, 0xC0, 0xDD, 0xDD, 0x20,
+  0x3F, 0xEE, 0x8B, 0xE2, 0x3A, 0x67, 0xAF, 0xE5,
+  0x5E, 0x76, 0xB0, 0xAB, 0x20, 0x2D, 0x3B, 0x65,
+  0x4C, 0x11, 0x03, 0x0E, 0xB5, 0xD6, 0x89, 0xAB,
+  0xA0, 0x82, 0xF4, 0xF0, 0x6F, 0xB3, 0xFC, 0x95,
+  0xB3, 0x5E, 0xBF, 0xB3, 0xB3, 0x2D, 0x5F, 0x29,
+  0xF8, 0xDC, 0x0E, 0x62, 0xEA, 0x96, 0x97, 0x6F,
+  0x3A, 0x4C, 0x16, 0xCB, 0x8A, 0x3D, 0x05, 0xD3,
+  0x02, 0xAB, 0x83, 0xEB, 0x8E, 0xE0, 0x7A, 0xBE,
+  0x5A, 0xD5, 0xAD, 0x42
+};
+
+/*---------------------------------------------------------------------------*/
+static void
+result(int success)
+{
+  printf("%s\n", success ? "Success" : "Failure");
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_aes_128(void)
+{
+  uint8_t block[AES_128_BLOCK_SIZE];
+  uint8_t i;
+
+  for(i = 0; i < sizeof(drivers) / sizeof(drivers[0]); i++) {
+    printf("Testing %s AES-128 ... ", drivers[i].name);
+    drivers[i].driver->set_key(fips_key);
+    memcpy(block, fips_plaintext, AES_128_BLOCK_SIZE);
+    drivers[i].driver->encrypt(block);
+    result(memcmp(block, fips_ciphertext, AES_128_BLOCK_SIZE) == 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Alternating between two keys does not expand them again */
+static void
+test_key_cache(void)
+{
+  uint8_t block[AES_128_BLOCK_SIZE];
+  uint32_t expansions;
+  uint8_t i;
+  int success;
+
+  printf("Testing key cache ... ");
+  success = 1;
+  aes_128_table_driver.set_key(fips_key);
+  aes_128_table_driver.set_key(ccm_key);
+  expansions = aes_128_key_expansions;
+  for(i = 0; i < 4; i++) {
+    aes_128_table_driver.set_key(fips_key);
+    memcpy(block, fips_plaintext, AES_128_BLOCK_SIZE);
+    aes_128_table_driver.encrypt(block);
+    success &= memcmp(block, fips_ciphertext, AES_128_BLOCK_SIZE) == 0;
+    aes_128_table_driver.set_key(ccm_key);
+  }
+  result(success && aes_128_key_expansions - expansions
+      == (AES_128_KEY_CACHE_SIZE > 1 ? 0 : 8));
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_ccm_star(const char *name,
+    uint8_t *a, uint8_t a_len,
+    uint8_t *m, uint8_t m_len,
+    uint8_t mic_len,
+    const uint8_t *oracle)
+{
+  uint8_t mic[16];
+
+  CCM_STAR.set_key(ccm_key);
+
+  printf("Testing %s CCM* encryption ... ", name);
+  CCM_STAR.aead(ccm_nonce, m, m_len, a, a_len, mic, mic_len, 1);
+  result(memcmp(m, oracle, m_len) == 0 &&
+      memcmp(mic, oracle + m_len, mic_len) == 0);
+
+  printf("Testing %s CCM* decryption ... ", name);
+  CCM_STAR.aead(ccm_nonce, m, m_len, a, a_len, mic, mic_len, 0);
+  result(memcmp(mic, oracle + m_len, mic_len) == 0);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(aes_128_tests_process, "AES-128 tests process");
+AUTOSTART_PROCESSES(&aes_128_tests_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(aes_128_tests_process, ev, data)
+{
+  static uint8_t a[LONG_A_LEN];
+  static uint8_t m[LONG_M_LEN];
+  uint8_t i;
+
+  PROCESS_BEGIN();
+
+  test_aes_128();
+  test_key_cache();
+
+  memcpy(a, ccm_a, sizeof(ccm_a));
+  memcpy(m, ccm_m, sizeof(ccm_m));
+  test_ccm_star("short", a, sizeof(ccm_a), m, sizeof(ccm_m), 8, ccm_oracle);
+
+  for(i = 0; i < LONG_A_LEN; i++) {
+    a[i] = i * 5 + 1;
+  }
+  for(i = 0; i < LONG_M_LEN; i++) {
+    m[i] = i * 7 + 3;
+  }
+  test_ccm_star("long", a, LONG_A_LEN, m, LONG_M_LEN, 16, long_oracle);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+
+/**
+ * \file
+ *         Measures the cost of process_poll() and the scheduler pass
+ *         that delivers the poll, with many processes running.
+ */
+
+#include "contiki.h"
+#include "bench.h"
+#include <stdio.h>
+
+#define PROCESSES 32
+
+static struct process idle[PROCESSES];
+static unsigned long polls;
+
+PROCESS(idle_process, "idle");
+PROCESS(process_bench_process, "Process benchmark");
+AUTOSTART_PROCESSES(&process_bench_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(idle_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT();
+    if(ev == PROCESS_EVENT_POLL) {
+      polls++;
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static int
+count_processes(void)
+{
+  struct process *p;
+  int n;
+
+  n = 0;
+  for(p = process_list; p != NULL; p = p->next) {
+    n++;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Polls `burst` of the idle processes, starting with `next`, and runs
+ * the scheduler until they have been called. Returns the process to
+ * start the next burst with.
+ */
+static int
+poll_burst(int next, int burst)
+{
+  int i;
+
+  for(i = 0; i < burst; i++) {
+    process_poll(&idle[next]);
+    next = (next + 7) % PROCESSES;
+  }
+  while(process_run() > 0);
+  return next;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Times bursts of `burst` polls, as interrupt handlers would post
+ * them. The benchmark process is itself being called, so the scheduler
+ * skips it.
+ */
+static void
+bench(const char *name, int burst)
+{
+  struct bench b;
+  unsigned long expect;
+  int next;
+  int i;
+
+  next = 0;
+  polls = 0;
+  BENCH_RUN(&b, i, next = poll_burst(next, burst));
+
+  expect = b.ops * burst;
+  if(polls != expect) {
+    printf("process-bench: %s: %lu polls delivered, expected %lu\n",
+           name, polls, expect);
+    return;
+  }
+  printf("process-bench: %s %lu ns/run\n", name, bench_ns_per_op(&b));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(process_bench_process, ev, data)
+{
+  static int i;
+
+  PROCESS_BEGIN();
+
+  /* Let the system processes settle */
+  PROCESS_PAUSE();
+
+  for(i = 0; i < PROCESSES; i++) {
+    idle[i] = idle_process;
+    process_start(&idle[i], NULL);
+  }
+  printf("process-bench: %d processes\n", count_processes());
+
+  bench("poll 1", 1);
+  bench("poll 4", 4);
+  bench("poll 8", 8);
+  bench("poll 16", 16);
+
+  printf("process-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
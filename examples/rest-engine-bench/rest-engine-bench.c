@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         Cost of dispatching a request to its resource in the REST
+ *         engine with 10, 100 and 1000 resources, for requests to a
+ *         resource, to a sub-resource of a parent resource, and to a
+ *         path that has no resource. Build with
+ *         REST_ENGINE_CONF_INDEX_NODES=0 to compare with dispatching
+ *         through the list of resources. Both must send a sub-resource
+ *         to the parent with the longest path.
+ */
+
+#include "contiki.h"
+#include "rest-engine.h"
+#include "er-coap.h"
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_RESOURCES 1000
+#define PATH_LEN      24
+
+static void res_get_handler(void *request, void *response, uint8_t *buffer,
+                            uint16_t preferred_size, int32_t *offset);
+
+static void res_logs_get_handler(void *request, void *response, uint8_t *buffer,
+                                 uint16_t preferred_size, int32_t *offset);
+
+PARENT_RESOURCE(res_files, "title=\"Files\"",
+                res_get_handler, NULL, NULL, NULL);
+PARENT_RESOURCE(res_logs, "title=\"Logs\"",
+                res_logs_get_handler, NULL, NULL, NULL);
+
+static resource_t resources[MAX_RESOURCES];
+static char paths[MAX_RESOURCES][PATH_LEN];
+static unsigned active;
+static unsigned long handled;
+static unsigned long logs_handled;
+
+static const unsigned sizes[] = { 10, 100, 1000 };
+
+static coap_packet_t request;
+static coap_packet_t response;
+static uint8_t buffer[REST_MAX_CHUNK_SIZE];
+
+PROCESS(rest_engine_bench_process, "REST engine benchmark");
+AUTOSTART_PROCESSES(&rest_engine_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer,
+                uint16_t preferred_size, int32_t *offset)
+{
+  handled++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_logs_get_handler(void *request, void *response, uint8_t *buffer,
+                     uint16_t preferred_size, int32_t *offset)
+{
+  handled++;
+  logs_handled++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+activate(unsigned n)
+{
+  for(; active < n; active++) {
+    snprintf(paths[active], PATH_LEN, "sensors/%u/value", active);
+    resources[active].flags = NO_FLAGS;
+    resources[active].get_handler = res_get_handler;
+    rest_activate_resource(&resources[active], paths[active]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+dispatch(const char *path)
+{
+  int32_t offset = 0;
+
+  coap_set_header_uri_path(&request, path);
+  return rest_invoke_restful_service(&request, &response,
+                                     buffer, sizeof(buffer), &offset);
+}
+/*---------------------------------------------------------------------------*/
+/* Picks the resources in a scattered order */
+static const char *
+hit_path(unsigned i)
+{
+  return paths[(i * 7919UL) % active];
+}
+/*---------------------------------------------------------------------------*/
+static const char *
+sub_path(unsigned i)
+{
+  return "files/logs/today";
+}
+/*---------------------------------------------------------------------------*/
+static const char *
+miss_path(unsigned i)
+{
+  return "sensors/none/value";
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(const char *name, const char *(*path)(unsigned), int expect)
+{
+  struct bench b;
+  unsigned i;
+
+  handled = 0;
+  logs_handled = 0;
+  for(i = 0; i < BENCH_BATCH; i++) {
+    if(dispatch(path(i)) != expect) {
+      printf("rest-engine-bench: %u resources %s: wrong result for %s\n",
+             active, name, path(i));
+      return;
+    }
+  }
+  if(handled != (expect ? BENCH_BATCH : 0)) {
+    printf("rest-engine-bench: %u resources %s: handler called %lu times\n",
+           active, name, handled);
+    return;
+  }
+  if(path == sub_path && logs_handled != BENCH_BATCH) {
+    printf("rest-engine-bench: %u resources %s: not the longest parent\n",
+           active, name);
+    return;
+  }
+
+  BENCH_RUN(&b, i, dispatch(path(b.ops + i)));
+
+  printf("rest-engine-bench: %u resources %s %lu requests/s %lu ns/request\n",
+         active, name, bench_per_second(&b, 1), bench_ns_per_op(&b));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rest_engine_bench_process, ev, data)
+{
+  static struct etimer et;
+  static uint8_t n;
+
+  PROCESS_BEGIN();
+
+  rest_init_engine();
+  rest_activate_resource(&res_files, "files");
+  rest_activate_resource(&res_logs, "files/logs");
+
+  coap_init_message(&request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_init_message(&response, COAP_TYPE_ACK, CONTENT_2_05, 0);
+
+  printf("rest-engine-bench: index nodes %u\n", REST_ENGINE_CONF_INDEX_NODES);
+
+  for(n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++) {
+    activate(sizes[n]);
+    bench("resource", hit_path, 1);
+    bench("sub-resource", sub_path, 1);
+    bench("not found", miss_path, 0);
+    etimer_set(&et, 1);
+    PROCESS_WAIT_UNTIL(etimer_expired(&et));
+  }
+
+  printf("rest-engine-bench: done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -56,11 +56,18 @@
 PROCESS(deluge_test_process, "Deluge test process");
 AUTOSTART_PROCESSES(&deluge_test_process);
 /*---------------------------------------------------------------------------*/
+static void
+deluge_complete(unsigned version)
+{
+  printf("Object complete, version %u\n", version);
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(deluge_test_process, ev, data)
 {
   int fd, r;
   char buf[32];
   static struct etimer et;
+  static char last[32];
 
   PROCESS_BEGIN();
 
@@ -85,10 +92,14 @@ PROCESS_THREAD(deluge_test_process, ev, data)
     printf("failed to seek to the end\n");
   }
 
+  deluge_set_callback(deluge_complete);
   deluge_disseminate("test", node_id == SINK_ID);
   cfs_close(fd);
 
-  etimer_set(&et, CLOCK_SECOND * 5);
+  /* Poll the file every second but only report changes, so that the
+     time at which a node received the new version can be read from
+     the log. */
+  etimer_set(&et, CLOCK_SECOND);
   for(;;) {
     PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
     if(node_id != SINK_ID) {
@@ -100,8 +111,9 @@ PROCESS_THREAD(deluge_test_process, ev, data)
 	buf[sizeof(buf) - 1] = '\0';
 	if(r <= 0) {
 	  printf("failed to read data from the file\n");
-	} else {
+	} else if(strcmp(buf, last) != 0) {
 	  printf("File contents: %s\n", buf);
+	  strcpy(last, buf);
 	}
 	cfs_close(fd);
       }
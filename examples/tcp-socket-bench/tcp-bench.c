@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Bulk transfer throughput benchmark for tcp-socket.
+ *
+ *         The instance given a server address connects to port 5001
+ *         there and sends TCP_BENCH_BYTES; an instance started
+ *         without one listens on port 5001 and counts what it
+ *         receives through the zero-copy input callback. Both report
+ *         the throughput. Against a sink on the host side of tap0:
+ *
+ *           nc -l 5001 > /dev/null &
+ *           sudo ./tcp-bench.native 172.18.0.2 172.18.0.1
+ */
+
+#include "contiki-net.h"
+#include "sys/cc.h"
+#include "net/tapdev-drv.h"
+#include "tapdev.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SERVER_PORT      5001
+#define TCP_BENCH_BYTES  (4UL * 1024 * 1024)
+
+static struct tcp_socket socket;
+
+/* Room for a full flight of segments plus the next one */
+static uint8_t outputbuf[(TCP_SOCKET_MAX_SEGMENTS + 1) * UIP_TCP_MSS];
+static uint8_t pattern[UIP_TCP_MSS];
+
+static unsigned long bytes;
+static unsigned long bytes_to_send;
+static clock_time_t start;
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+PROCESS(tcp_bench_process, "tcp-socket benchmark");
+AUTOSTART_PROCESSES(&tcp_bench_process);
+/*---------------------------------------------------------------------------*/
+/* The native platform does not drive the tap interface for IPv4 by
+   itself, so hook it into the main select() loop */
+static int
+tap_set_fd(fd_set *rset, fd_set *wset)
+{
+  FD_SET(tapdev_fd(), rset);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tap_handle_fd(fd_set *rset, fd_set *wset)
+{
+  if(FD_ISSET(tapdev_fd(), rset)) {
+    process_poll(&tapdev_process);
+  }
+}
+static const struct select_callback tap_callback = { tap_set_fd, tap_handle_fd };
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *role)
+{
+  unsigned long elapsed_ms;
+
+  elapsed_ms = (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND;
+  if(elapsed_ms == 0) {
+    elapsed_ms = 1;
+  }
+  printf("tcp-bench: %s %lu bytes in %lu ms, %lu kB/s (mss %u, %s)\n",
+         role, bytes, elapsed_ms, bytes / elapsed_ms, UIP_TCP_MSS,
+         TCP_BENCH_CONF_WINDOWED ? "windowed" : "single segment");
+}
+/*---------------------------------------------------------------------------*/
+static void
+fill(struct tcp_socket *s)
+{
+  int len;
+
+  while(bytes_to_send > 0 && tcp_socket_max_sendlen(s) > 0) {
+    len = MIN(bytes_to_send, sizeof(pattern));
+    len = tcp_socket_send(s, pattern, len);
+    if(len <= 0) {
+      break;
+    }
+    bytes_to_send -= len;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+input(struct tcp_socket *s, void *ptr,
+      const uint8_t *inputptr, int inputdatalen)
+{
+  if(bytes == 0) {
+    start = clock_time();
+  }
+  bytes += inputdatalen;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t ev)
+{
+  int is_client = (ptr != NULL);
+
+  switch(ev) {
+  case TCP_SOCKET_CONNECTED:
+    if(is_client) {
+      printf("tcp-bench: connected, sending %lu bytes\n", TCP_BENCH_BYTES);
+      bytes_to_send = TCP_BENCH_BYTES;
+      start = clock_time();
+      fill(s);
+    }
+    break;
+  case TCP_SOCKET_DATA_SENT:
+    if(is_client) {
+      bytes = TCP_BENCH_BYTES - bytes_to_send - s->output_data_len;
+      fill(s);
+      if(bytes_to_send == 0 && s->output_data_len == 0) {
+        bytes = TCP_BENCH_BYTES;
+        report("sent");
+        tcp_socket_close(s);
+      }
+    }
+    break;
+  case TCP_SOCKET_CLOSED:
+    if(!is_client) {
+      report("received");
+      bytes = 0;
+    }
+    break;
+  case TCP_SOCKET_TIMEDOUT:
+  case TCP_SOCKET_ABORTED:
+    printf("tcp-bench: connection lost after %lu bytes\n", bytes);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tcp_bench_process, ev, data)
+{
+  static uip_ipaddr_t server;
+  uip_ipaddr_t addr;
+
+  PROCESS_BEGIN();
+
+  if(contiki_argc < 2 || uiplib_ipaddrconv(contiki_argv[1], &addr) == 0) {
+    printf("usage: %s <own address> [<server address>]\n", contiki_argv[0]);
+    PROCESS_EXIT();
+  }
+  uip_sethostaddr(&addr);
+  uip_ipaddr(&addr, 255,255,0,0);
+  uip_setnetmask(&addr);
+
+  process_start(&tapdev_process, NULL);
+  select_set_callback(tapdev_fd(), &tap_callback);
+
+  memset(pattern, 'x', sizeof(pattern));
+
+  if(contiki_argc > 2 && uiplib_ipaddrconv(contiki_argv[2], &server)) {
+    /* Client: no input buffer needed, the server sends nothing */
+    tcp_socket_register(&socket, &socket, NULL, 0,
+                        outputbuf, sizeof(outputbuf), NULL, event);
+#if TCP_BENCH_CONF_WINDOWED
+    tcp_socket_windowed(&socket);
+#endif
+    /* Give the other instance and the bridge time to come up */
+    {
+      static struct etimer et;
+      etimer_set(&et, CLOCK_SECOND * 2);
+      PROCESS_WAIT_UNTIL(etimer_expired(&et));
+    }
+    tcp_socket_connect(&socket, &server, SERVER_PORT);
+  } else {
+    /* Server: the zero-copy input callback counts bytes in place */
+    tcp_socket_register(&socket, NULL, NULL, 0,
+                        outputbuf, sizeof(outputbuf), input, event);
+    tcp_socket_listen(&socket, SERVER_PORT);
+    printf("tcp-bench: listening on port %u\n", SERVER_PORT);
+  }
+
+  while(1) {
+    PROCESS_WAIT_EVENT();
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
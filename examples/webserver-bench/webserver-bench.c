@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+
+/**
+ * \file
+ *         Load generator for the httpd and httpd-cfs web servers:
+ *         requests per second and time to first byte.
+ *
+ *         An instance started with only its own address runs the web
+ *         server on port 80; build with HTTPD-CFS=1 for httpd-cfs,
+ *         which serves the files in the current directory on native.
+ *         An instance given a server address fetches each of a set of
+ *         pages WEBSERVER_BENCH_REQUESTS times, with
+ *         WEBSERVER_BENCH_CLIENTS connections in parallel, and reports
+ *         the request rate and the mean time from the start of a
+ *         request (including the connection setup when it needs a new
+ *         connection) to the first byte of the response. Pages may be
+ *         given after the server address. With
+ *         WEBSERVER_BENCH_CONF_KEEPALIVE the clients send HTTP/1.1
+ *         requests on persistent connections, and with
+ *         WEBSERVER_BENCH_CONF_CONDITIONAL they send the ETag of the
+ *         previous response in If-None-Match. httpd-cfs only sends
+ *         ETags, and only buffers pipelined requests, when the server
+ *         is built with WEBSERVER_CONF_CFS_FILE_CACHE.
+ *
+ *         The client side can also be any HTTP client on the host side
+ *         of tap0:
+ *
+ *           sudo ./webserver-bench.native 172.18.0.2
+ *           curl -s -o /dev/null -w "%{time_starttransfer}\n" \
+ *             http://172.18.0.2/index.html
+ */
+
+#include "contiki-net.h"
+#include "sys/cc.h"
+#include "net/tapdev-drv.h"
+#include "tapdev.h"
+#include "webserver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SERVER_PORT  80
+
+#ifdef WEBSERVER_BENCH_CONF_REQUESTS
+#define WEBSERVER_BENCH_REQUESTS WEBSERVER_BENCH_CONF_REQUESTS
+#else
+#define WEBSERVER_BENCH_REQUESTS 200
+#endif
+
+#ifdef WEBSERVER_BENCH_CONF_CLIENTS
+#define WEBSERVER_BENCH_CLIENTS WEBSERVER_BENCH_CONF_CLIENTS
+#else
+#define WEBSERVER_BENCH_CLIENTS 1
+#endif
+
+#ifdef WEBSERVER_BENCH_CONF_KEEPALIVE
+#define WEBSERVER_BENCH_KEEPALIVE WEBSERVER_BENCH_CONF_KEEPALIVE
+#else
+#define WEBSERVER_BENCH_KEEPALIVE 0
+#endif
+
+#ifdef WEBSERVER_BENCH_CONF_CONDITIONAL
+#define WEBSERVER_BENCH_CONDITIONAL WEBSERVER_BENCH_CONF_CONDITIONAL
+#else
+#define WEBSERVER_BENCH_CONDITIONAL 0
+#endif
+
+/* The web server's signature, used to set it up */
+void httpd_init(void);
+void httpd_appcall(void *state);
+
+/* A static page, the first page of the file system, a page with
+   scripts and a missing page of httpd's built-in file system */
+static const char *default_paths[] = {
+  "/style.css", "/index.html", "/files.shtml", "/missing.html"
+};
+static const char **paths;
+static int num_paths;
+
+#define CLIENT_IDLE       0
+#define CLIENT_CONNECTING 1
+#define CLIENT_OPEN       2
+#define CLIENT_BUSY       3
+#define CLIENT_DONE       4
+
+#define LENGTH_UNKNOWN    -1L
+
+struct client {
+  struct tcp_socket socket;
+  uint8_t inputbuf[UIP_TCP_MSS];
+  uint8_t outputbuf[128];
+  clock_time_t request_start;
+  long remaining;
+  char line[48];
+  uint8_t linelen;
+  uint8_t state;
+  uint8_t in_body;
+  uint8_t first_byte;
+  char etag[24];
+};
+
+static struct client clients[WEBSERVER_BENCH_CLIENTS];
+
+static uip_ipaddr_t server;
+static int path;
+static unsigned issued;
+static unsigned requests;
+static unsigned not_modified;
+static unsigned failed;
+static unsigned long bytes;
+static unsigned long ttfb;
+static clock_time_t start;
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+PROCESS(webserver_bench_process, "Web server benchmark");
+AUTOSTART_PROCESSES(&webserver_bench_process);
+/*---------------------------------------------------------------------------*/
+/* The native platform does not drive the tap interface for IPv4 by
+   itself, so hook it into the main select() loop */
+static int
+tap_set_fd(fd_set *rset, fd_set *wset)
+{
+  FD_SET(tapdev_fd(), rset);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tap_handle_fd(fd_set *rset, fd_set *wset)
+{
+  if(FD_ISSET(tapdev_fd(), rset)) {
+    process_poll(&tapdev_process);
+  }
+}
+static const struct select_callback tap_callback = { tap_set_fd, tap_handle_fd };
+/*---------------------------------------------------------------------------*/
+/* The web servers log every request through the web server front-end */
+void
+webserver_log_file(uip_ipaddr_t *requester, char *file)
+{
+}
+/*---------------------------------------------------------------------------*/
+void
+webserver_log(char *msg)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(void)
+{
+  unsigned long elapsed_ms;
+
+  elapsed_ms = (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND;
+  if(elapsed_ms == 0) {
+    elapsed_ms = 1;
+  }
+  ttfb = ttfb * 1000 / CLOCK_SECOND;
+  printf("webserver-bench: %s %u requests in %lu ms, %lu requests/s, "
+         "%lu bytes/request, ttfb %lu.%02lu ms, %u not modified, "
+         "%u failed\n",
+         paths[path], requests, elapsed_ms,
+         (unsigned long)requests * 1000 / elapsed_ms,
+         bytes / requests,
+         ttfb / requests, (ttfb * 100 / requests) % 100,
+         not_modified, failed);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_request(struct client *c)
+{
+  issued++;
+  c->state = CLIENT_BUSY;
+  c->remaining = LENGTH_UNKNOWN;
+  c->in_body = 0;
+  c->linelen = 0;
+  c->first_byte = 0;
+  if(WEBSERVER_BENCH_KEEPALIVE) {
+    c->request_start = clock_time();
+  }
+  tcp_socket_send_str(&c->socket, "GET ");
+  tcp_socket_send_str(&c->socket, paths[path]);
+  tcp_socket_send_str(&c->socket, WEBSERVER_BENCH_KEEPALIVE ?
+                      " HTTP/1.1\r\n" : " HTTP/1.0\r\n");
+  if(WEBSERVER_BENCH_CONDITIONAL && c->etag[0] != 0) {
+    tcp_socket_send_str(&c->socket, "If-None-Match: ");
+    tcp_socket_send_str(&c->socket, c->etag);
+    tcp_socket_send_str(&c->socket, "\r\n");
+  }
+  tcp_socket_send_str(&c->socket, "\r\n");
+  /* Do not wait for the periodic poll to send the request */
+  tcpip_poll_tcp(c->socket.c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_done(struct client *c)
+{
+  /* Without keep-alive, wait for the server to close the connection */
+  c->state = WEBSERVER_BENCH_KEEPALIVE ? CLIENT_OPEN : CLIENT_DONE;
+  if(++requests == WEBSERVER_BENCH_REQUESTS) {
+    report();
+    path++;
+    requests = issued = not_modified = failed = 0;
+    bytes = ttfb = 0;
+    start = clock_time();
+  }
+  /* Send the next request from the process, not from within tcp-socket */
+  process_poll(&webserver_bench_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+header_line(struct client *c)
+{
+  c->line[c->linelen] = 0;
+  if(strncmp(c->line, "HTTP/", 5) == 0 &&
+     strncmp(&c->line[9], "304", 3) == 0) {
+    not_modified++;
+    c->remaining = 0;
+  } else if(strncmp(c->line, "Content-Length: ", 16) == 0 &&
+            c->remaining == LENGTH_UNKNOWN) {
+    c->remaining = atol(&c->line[16]);
+  } else if(strncmp(c->line, "ETag: ", 6) == 0) {
+    strncpy(c->etag, &c->line[6], sizeof(c->etag) - 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+input(struct tcp_socket *s, void *ptr,
+      const uint8_t *inputptr, int inputdatalen)
+{
+  struct client *c = ptr;
+  int i;
+
+  if(c->state != CLIENT_BUSY) {
+    return 0;
+  }
+  if(!c->first_byte) {
+    ttfb += clock_time() - c->request_start;
+    c->first_byte = 1;
+  }
+  bytes += inputdatalen;
+
+  for(i = 0; i < inputdatalen && !c->in_body; i++) {
+    if(inputptr[i] == '\n') {
+      if(c->linelen == 0) {
+        c->in_body = 1;
+      } else {
+        header_line(c);
+      }
+      c->linelen = 0;
+    } else if(inputptr[i] != '\r' && c->linelen < sizeof(c->line) - 1) {
+      c->line[c->linelen++] = inputptr[i];
+    }
+  }
+  if(c->in_body && c->remaining != LENGTH_UNKNOWN) {
+    c->remaining -= inputdatalen - i;
+    if(c->remaining <= 0) {
+      response_done(c);
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t ev)
+{
+  struct client *c = ptr;
+
+  switch(ev) {
+  case TCP_SOCKET_CONNECTED:
+    c->state = CLIENT_OPEN;
+    process_poll(&webserver_bench_process);
+    break;
+  case TCP_SOCKET_CLOSED:
+  case TCP_SOCKET_TIMEDOUT:
+  case TCP_SOCKET_ABORTED:
+    if(c->state == CLIENT_BUSY) {
+      if(ev == TCP_SOCKET_CLOSED && c->in_body &&
+         c->remaining == LENGTH_UNKNOWN) {
+        /* The end of a response without a length */
+        response_done(c);
+      } else {
+        /* Count it as done so that the run finishes */
+        failed++;
+        response_done(c);
+      }
+    }
+    c->state = CLIENT_IDLE;
+    process_poll(&webserver_bench_process);
+    break;
+  case TCP_SOCKET_DATA_SENT:
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_clients(void)
+{
+  struct client *c;
+
+  if(path == num_paths) {
+    return;
+  }
+  for(c = clients; c < &clients[WEBSERVER_BENCH_CLIENTS]; c++) {
+    if(issued == WEBSERVER_BENCH_REQUESTS) {
+      break;
+    }
+    if(c->state == CLIENT_IDLE) {
+      c->state = CLIENT_CONNECTING;
+      c->request_start = clock_time();
+      tcp_socket_connect(&c->socket, &server, SERVER_PORT);
+    } else if(c->state == CLIENT_OPEN) {
+      send_request(c);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(webserver_bench_process, ev, data)
+{
+  uip_ipaddr_t addr;
+  struct client *c;
+
+  PROCESS_BEGIN();
+
+  if(contiki_argc < 2 || uiplib_ipaddrconv(contiki_argv[1], &addr) == 0) {
+    printf("usage: %s <own address> [<server address> [<page>...]]\n",
+           contiki_argv[0]);
+    PROCESS_EXIT();
+  }
+  uip_sethostaddr(&addr);
+  uip_ipaddr(&addr, 255,255,0,0);
+  uip_setnetmask(&addr);
+
+  process_start(&tapdev_process, NULL);
+  select_set_callback(tapdev_fd(), &tap_callback);
+
+  if(contiki_argc > 2 && uiplib_ipaddrconv(contiki_argv[2], &server)) {
+    if(contiki_argc > 3) {
+      paths = (const char **)&contiki_argv[3];
+      num_paths = contiki_argc - 3;
+    } else {
+      paths = default_paths;
+      num_paths = sizeof(default_paths) / sizeof(default_paths[0]);
+    }
+    for(c = clients; c < &clients[WEBSERVER_BENCH_CLIENTS]; c++) {
+      tcp_socket_register(&c->socket, c, c->inputbuf, sizeof(c->inputbuf),
+                          c->outputbuf, sizeof(c->outputbuf), input, event);
+    }
+    /* Give the server and the bridge time to come up */
+    {
+      static struct etimer et;
+      etimer_set(&et, CLOCK_SECOND * 2);
+      PROCESS_WAIT_UNTIL(etimer_expired(&et));
+    }
+    printf("webserver-bench: %u clients, %s, %s\n", WEBSERVER_BENCH_CLIENTS,
+           WEBSERVER_BENCH_KEEPALIVE ? "keep-alive" : "one request per connection",
+           WEBSERVER_BENCH_CONDITIONAL ? "conditional" : "unconditional");
+    start = clock_time();
+    while(path < num_paths) {
+      run_clients();
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    }
+    for(c = clients; c < &clients[WEBSERVER_BENCH_CLIENTS]; c++) {
+      tcp_socket_close(&c->socket);
+    }
+    printf("webserver-bench: done\n");
+  } else {
+    httpd_init();
+    printf("webserver-bench: listening on port %u\n", SERVER_PORT);
+    while(1) {
+      PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+      httpd_appcall(data);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
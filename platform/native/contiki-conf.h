@@ -49,6 +49,14 @@ int select_set_callback(int fd, const struct select_callback *callback);
 #define CC_CONF_VA_ARGS                1
 /*#define CC_CONF_INLINE                 inline*/
 
+#ifndef AES_128_CONF
+#define AES_128_CONF aes_128_ni_driver
+#endif /* AES_128_CONF */
+
+#ifndef AES_128_CONF_KEY_CACHE_SIZE
+#define AES_128_CONF_KEY_CACHE_SIZE 2
+#endif /* AES_128_CONF_KEY_CACHE_SIZE */
+
 #ifndef EEPROM_CONF_SIZE
 #define EEPROM_CONF_SIZE				1024
 #endif
@@ -119,6 +127,12 @@ typedef unsigned short uip_stats_t;
 #define UIP_CONF_IPV6_REASSEMBLY 0
 #define UIP_CONF_NETIF_MAX_ADDRESSES  3
 #define UIP_CONF_ICMP6           1
+#ifndef UIP_DS6_CONF_DEST_FILTER_SIZE
+#define UIP_DS6_CONF_DEST_FILTER_SIZE 8
+#endif /* UIP_DS6_CONF_DEST_FILTER_SIZE */
+#ifndef UIP_CONF_DEMUX_BUCKETS
+#define UIP_CONF_DEMUX_BUCKETS   16
+#endif /* UIP_CONF_DEMUX_BUCKETS */
 
 /* configure number of neighbors and routes */
 #ifndef NBR_TABLE_CONF_MAX_NEIGHBORS
@@ -0,0 +1,227 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[APPS_DIR]/mrm</project>
+  <project EXPORT="discard">[APPS_DIR]/mspsim</project>
+  <project EXPORT="discard">[APPS_DIR]/avrora</project>
+  <project EXPORT="discard">[APPS_DIR]/serial_socket</project>
+  <project EXPORT="discard">[APPS_DIR]/collect-view</project>
+  <project EXPORT="discard">[APPS_DIR]/powertracker</project>
+  <simulation>
+    <title>ContikiMAC phase lock, baseline and drift model</title>
+    <randomseed>1</randomseed>
+    <motedelay_us>10000000</motedelay_us>
+    <radiomedium>
+      org.contikios.cooja.radiomediums.UDGM
+      <transmitting_range>50.0</transmitting_range>
+      <interference_range>0.0</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>1.0</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      org.contikios.cooja.mspmote.SkyMoteType
+      <identifier>sky0</identifier>
+      <description>Phase node, baseline</description>
+      <source EXPORT="discard">[CONTIKI_DIR]/regression-tests/04-rime/code/phase-node.c</source>
+      <commands EXPORT="discard">make clean TARGET=sky
+make phase-node.sky TARGET=sky DEFINES=CONTIKIMAC_CONF_WITH_PHASE_OPTIMIZATION=1,PHASE_CONF_DRIFT_CORRECT=0,PHASE_CONF_STATS=1
+cp phase-node.sky phase-node-baseline.sky</commands>
+      <firmware EXPORT="copy">[CONTIKI_DIR]/regression-tests/04-rime/code/phase-node-baseline.sky</firmware>
+      <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyLED</moteinterface>
+    </motetype>
+    <motetype>
+      org.contikios.cooja.mspmote.SkyMoteType
+      <identifier>sky1</identifier>
+      <description>Phase node, drift model</description>
+      <source EXPORT="discard">[CONTIKI_DIR]/regression-tests/04-rime/code/phase-node.c</source>
+      <commands EXPORT="discard">make clean TARGET=sky
+make phase-node.sky TARGET=sky DEFINES=CONTIKIMAC_CONF_WITH_PHASE_OPTIMIZATION=1,PHASE_CONF_DRIFT_CORRECT=1,PHASE_CONF_STATS=1</commands>
+      <firmware EXPORT="copy">[CONTIKI_DIR]/regression-tests/04-rime/code/phase-node.sky</firmware>
+      <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyLED</moteinterface>
+    </motetype>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>10.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>1.0</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>1</id>
+      </interface_config>
+      <motetype_identifier>sky0</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>30.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>0.9995</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>2</id>
+      </interface_config>
+      <motetype_identifier>sky0</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>310.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>1.0</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>3</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>330.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspClock
+        <deviation>0.9995</deviation>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>4</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+  </simulation>
+  <plugin>
+    org.contikios.cooja.plugins.SimControl
+    <width>265</width>
+    <z>2</z>
+    <height>200</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.LogListener
+    <plugin_config>
+      <filter>phase</filter>
+      <formatted_time />
+      <coloring />
+    </plugin_config>
+    <width>539</width>
+    <z>0</z>
+    <height>319</height>
+    <location_x>0</location_x>
+    <location_y>200</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>TIMEOUT(600000);
+
+/* Nodes 2 and 4 run 0.05% slow, so their senders have to track their
+   phase drift. Node 1 runs the baseline, without drift correction, and
+   node 3 the drift model; the two pairs are out of range of each other.
+   With the model, unicasts should need fewer strobes than the baseline
+   and only a handful once locked on. */
+MIN_SENT = 200;
+MAX_STROBES_PER_LOCKED = 8;
+
+stats = {};
+while (!(stats[1] &amp;&amp; stats[1].sent &gt;= MIN_SENT &amp;&amp;
+         stats[3] &amp;&amp; stats[3].sent &gt;= MIN_SENT)) {
+  YIELD();
+  if ((id == 1 || id == 3) &amp;&amp; msg.startsWith('phase: sent')) {
+    log.log(id + ": " + msg + "\n");
+    f = msg.split(' ');
+    stats[id] = {
+      sent: parseInt(f[2]),
+      unicasts: parseInt(f[4]),
+      strobes: parseInt(f[6]),
+      locked: parseInt(f[8]),
+      locked_strobes: parseInt(f[10]),
+      misses: parseInt(f[12]),
+      tx: parseInt(f[14])
+    };
+  }
+}
+
+function report(name, s) {
+  log.log(name + ": unicasts=" + s.unicasts +
+          " strobes/unicast=" + (s.strobes / s.unicasts).toFixed(2) +
+          " locked=" + s.locked +
+          " strobes/locked=" + (s.locked_strobes / s.locked).toFixed(2) +
+          " misses=" + s.misses + " tx=" + s.tx + "\n");
+}
+base = stats[1];
+model = stats[3];
+report("baseline", base);
+report("drift model", model);
+log.log("strobes/unicast " + (100 * (1 - (model.strobes / model.unicasts) /
+                                     (base.strobes / base.unicasts))).toFixed(1) +
+        "% lower, tx time " + (100 * (1 - model.tx / base.tx)).toFixed(1) +
+        "% lower than the baseline\n");
+
+if (model.locked &lt; model.unicasts * 9 / 10) {
+  log.log("Error: too few unicasts were phase-locked\n");
+  log.testFailed();
+} else if (model.locked_strobes / model.locked &gt; MAX_STROBES_PER_LOCKED) {
+  log.log("Error: too many strobes per phase-locked unicast\n");
+  log.testFailed();
+} else if (model.misses &gt; model.locked / 20) {
+  log.log("Error: too many missed wake-ups\n");
+  log.testFailed();
+} else if (model.strobes / model.unicasts &gt;= base.strobes / base.unicasts) {
+  log.log("Error: no fewer strobes than the baseline\n");
+  log.testFailed();
+} else {
+  log.testOK();
+}</script>
+      <active>true</active>
+    </plugin_config>
+    <width>503</width>
+    <z>1</z>
+    <height>643</height>
+    <location_x>539</location_x>
+    <location_y>1</location_y>
+  </plugin>
+</simconf>
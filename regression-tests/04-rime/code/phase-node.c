@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Phase-lock regression test node: each odd-numbered node sends
+ *         periodic unicasts to the next node and reports ContikiMAC
+ *         strobe statistics.
+ */
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/mac/phase.h"
+#include "lib/random.h"
+#include "sys/energest.h"
+#include "sys/node-id.h"
+
+#include <stdio.h>
+
+#define SEND_INTERVAL     (2 * CLOCK_SECOND)
+#define REPORT_INTERVAL   20
+
+/*---------------------------------------------------------------------------*/
+PROCESS(phase_node_process, "Phase node");
+AUTOSTART_PROCESSES(&phase_node_process);
+/*---------------------------------------------------------------------------*/
+static void
+recv_uc(struct unicast_conn *c, const linkaddr_t *from)
+{
+}
+static const struct unicast_callbacks unicast_callbacks = {recv_uc};
+static struct unicast_conn uc;
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(phase_node_process, ev, data)
+{
+  static struct etimer et;
+  static unsigned sent;
+  linkaddr_t addr;
+
+  PROCESS_BEGIN();
+
+  unicast_open(&uc, 146, &unicast_callbacks);
+
+  if((node_id & 1) == 0) {
+    PROCESS_EXIT();
+  }
+
+  /* Let the receiver boot */
+  etimer_set(&et, CLOCK_SECOND * 4);
+  PROCESS_WAIT_UNTIL(etimer_expired(&et));
+
+  while(1) {
+    etimer_set(&et, SEND_INTERVAL + random_rand() % (CLOCK_SECOND / 4));
+    PROCESS_WAIT_UNTIL(etimer_expired(&et));
+
+    packetbuf_copyfrom("Hello", 6);
+    addr.u8[0] = (node_id + 1) & 0xff;
+    addr.u8[1] = (node_id + 1) >> 8;
+    unicast_send(&uc, &addr);
+    sent++;
+
+#if PHASE_STATS
+    if(sent % REPORT_INTERVAL == 0) {
+      energest_flush();
+      printf("phase: sent %u unicasts %lu strobes %lu locked %lu locked-strobes %lu misses %lu tx %lu\n",
+             sent, phase_stats.unicasts, phase_stats.strobes,
+             phase_stats.locked_unicasts, phase_stats.locked_strobes,
+             phase_stats.locked_misses,
+             energest_type_time(ENERGEST_TYPE_TRANSMIT));
+    }
+#endif /* PHASE_STATS */
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -348,6 +348,9 @@ print_stats()
 	  "% tx " + 100 * total_transmit / (total_cpu + total_lpm) +
   	  "% average latency " + total_latency / (4096 * total_received) +
 	  " ms \n");
+  log.log("Sink goodput: " + total_unique + " unique messages, " +
+	  (1000000 * total_unique / time) + " messages/s, " +
+	  (1000000 * total_unique_bytes / time) + " bytes/s\n");
 }
 
 TIMEOUT(500000);
@@ -363,6 +366,8 @@ total_lost = 0;
 total_hops = 0;
 total_dups = 0;
 total_reorder = 0;
+total_unique = 0;
+total_unique_bytes = 0;
 
 total_cpu = total_lpm = total_listen = total_transmit = 0;
 
@@ -455,6 +460,10 @@ while(true) {
     }
     received[source] = received[source].substr(0, seqno) + dups +
         received[source].substr(seqno + 1, 10 - seqno);
+    if(dups == 1) {
+        total_unique++;
+        total_unique_bytes += 2 * len;
+    }
 
     if(hop &gt; 9) {
         hop = "+";
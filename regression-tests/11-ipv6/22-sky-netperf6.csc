@@ -0,0 +1,144 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[CONTIKI_DIR]/tools/cooja/apps/mrm</project>
+  <project EXPORT="discard">[CONTIKI_DIR]/tools/cooja/apps/mspsim</project>
+  <project EXPORT="discard">[CONTIKI_DIR]/tools/cooja/apps/avrora</project>
+  <simulation>
+    <title>netperf6 between two sky nodes</title>
+    <delaytime>0</delaytime>
+    <randomseed>generated</randomseed>
+    <motedelay_us>1000000</motedelay_us>
+    <radiomedium>
+      org.contikios.cooja.radiomediums.UDGM
+      <transmitting_range>50.0</transmitting_range>
+      <interference_range>100.0</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>1.0</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      org.contikios.cooja.mspmote.SkyMoteType
+      <identifier>sky1</identifier>
+      <description>netperf6 node</description>
+      <source EXPORT="discard">[CONTIKI_DIR]/examples/ipv6/netperf6/netperf6-node.c</source>
+      <commands EXPORT="discard">make netperf6-node.sky TARGET=sky</commands>
+      <firmware EXPORT="copy">[CONTIKI_DIR]/examples/ipv6/netperf6/netperf6-node.sky</firmware>
+      <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyLED</moteinterface>
+    </motetype>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>65.934608127183</x>
+        <y>63.70462190529231</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>1</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>67.66105781539623</x>
+        <y>63.13924301161143</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>2</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+  </simulation>
+  <plugin>
+    org.contikios.cooja.plugins.SimControl
+    <width>248</width>
+    <z>0</z>
+    <height>200</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.LogListener
+    <plugin_config>
+      <filter />
+    </plugin_config>
+    <width>816</width>
+    <z>3</z>
+    <height>333</height>
+    <location_x>1</location_x>
+    <location_y>365</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.Visualizer
+    <plugin_config>
+      <skin>org.contikios.cooja.plugins.skins.IDVisualizerSkin</skin>
+      <skin>org.contikios.cooja.plugins.skins.AddressVisualizerSkin</skin>
+      <skin>org.contikios.cooja.plugins.skins.UDGMVisualizerSkin</skin>
+      <viewport>123.21660699387752 0.0 0.0 123.21660699387752 -8113.602333266065 -7760.635326525308</viewport>
+    </plugin_config>
+    <width>246</width>
+    <z>2</z>
+    <height>167</height>
+    <location_x>0</location_x>
+    <location_y>198</location_y>
+  </plugin>
+  <plugin>
+    org.contikios.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>TIMEOUT(600000, log.log("last msg: " + msg + "\n"));
+
+/* Wait for both nodes to boot and finish duplicate address detection */
+mote2 = null;
+while (mote2 == null) {
+  if (id == 2) {
+    mote2 = mote;
+  }
+  YIELD();
+}
+GENERATE_MSG(20000, "continue");
+YIELD_THEN_WAIT_UNTIL(msg.equals("continue"));
+
+/* Mote 2 measures the link towards mote 1 */
+commands = [
+  "netperf6 udp stream fe80::212:7401:1:101 64 50",
+  "netperf6 udp rr fe80::212:7401:1:101 64 20",
+  "netperf6 udp pingpong fe80::212:7401:1:101 64 20",
+  "netperf6 tcp rr fe80::212:7401:1:101 64 10",
+  "netperf6 tcp pingpong fe80::212:7401:1:101 64 10"
+];
+for (i = 0; i &lt; commands.length; i++) {
+  log.log("mote2&gt; " + commands[i] + "\n");
+  write(mote2, commands[i]);
+  YIELD_THEN_WAIT_UNTIL(id == 2 &amp;&amp; msg.contains("netperf6 proto="));
+  log.log(msg + "\n");
+  if (msg.contains("completed=0 ")) {
+    log.testFailed();
+  }
+}
+
+log.testOK(); /* Report test success and quit */</script>
+      <active>true</active>
+    </plugin_config>
+    <width>572</width>
+    <z>1</z>
+    <height>700</height>
+    <location_x>441</location_x>
+    <location_y>2</location_y>
+  </plugin>
+</simconf>
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2015, Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/*
+ * nettrace-decode: turn the binary netstack trace of a node (see
+ * core/net/nettrace.h) into text, one event per line. Reads the files
+ * given, or the standard input, e.g. a trace file from a native node or
+ * the output of serialdump. Text the node prints between records is
+ * passed through unless -q is given.
+ *
+ *   nettrace-decode [-q] [-c] [-r ticks-per-second] [file...]
+ *
+ * -c prints comma-separated values instead: time,event,arg0,...,arg4.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FRAME_START1 0xa5
+#define FRAME_START2 0x5a
+#define RECORD_LEN 16
+
+struct event {
+  const char *name;
+  const char *label[5];
+};
+
+static const struct event events[] = {
+#define NETTRACE_EVENT(id, name, a0, a1, a2, a3, a4) { name, { a0, a1, a2, a3, a4 } },
+#include "../core/net/nettrace-events.h"
+#undef NETTRACE_EVENT
+};
+#define NUM_EVENTS (sizeof(events) / sizeof(events[0]))
+
+static int quiet;
+static int csv;
+
+/* Timestamps are unwrapped with the width and rate of the node's rtimer,
+   which the start record tells */
+static unsigned long ticks_per_second = 32768;
+static int rtimer_bits = 16;
+static uint32_t last_ticks;
+static uint64_t total_ticks;
+static int have_ticks;
+
+static unsigned long records;
+static unsigned long bad_frames;
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get16(const uint8_t *p)
+{
+  return p[0] | p[1] << 8;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return get16(p) | (uint32_t)get16(p + 2) << 16;
+}
+/*---------------------------------------------------------------------------*/
+/* TSCH records are stamped in the slot and written later, so a record
+   may be a little older than the one before it: a step of more than half
+   the timer range is taken as a step back */
+static double
+unwrap_time(uint32_t ticks)
+{
+  uint32_t mask;
+  uint32_t step;
+
+  mask = rtimer_bits >= 32 ? 0xffffffff : ((uint32_t)1 << rtimer_bits) - 1;
+  ticks &= mask;
+  if(have_ticks) {
+    step = (ticks - last_ticks) & mask;
+    if(step > mask / 2) {
+      total_ticks -= (last_ticks - ticks) & mask;
+    } else {
+      total_ticks += step;
+    }
+  } else {
+    total_ticks = ticks;
+    have_ticks = 1;
+  }
+  last_ticks = ticks;
+  return (double)total_ticks / ticks_per_second;
+}
+/*---------------------------------------------------------------------------*/
+static void
+decode(const uint8_t *r)
+{
+  const struct event *e;
+  long args[5];
+  double time;
+  int i;
+
+  args[0] = r[1];
+  args[1] = get16(&r[2]);
+  args[2] = (long)get32(&r[8]);
+  args[3] = (int16_t)get16(&r[12]);
+  args[4] = (int16_t)get16(&r[14]);
+  e = r[0] < NUM_EVENTS ? &events[r[0]] : NULL;
+
+  if(e != NULL && strcmp(e->name, "start") == 0) {
+    /* A node (re)started: take its timer settings, and restart time */
+    if(args[2] > 0) {
+      ticks_per_second = args[2];
+    }
+    if(args[4] > 0) {
+      rtimer_bits = args[4];
+    }
+    have_ticks = 0;
+  }
+  time = unwrap_time(get32(&r[4]));
+  records++;
+
+  if(csv) {
+    printf("%.6f,%s", time, e != NULL ? e->name : "unknown");
+    for(i = 0; i < 5; i++) {
+      printf(",%ld", args[i]);
+    }
+    printf("\n");
+    return;
+  }
+
+  if(e == NULL) {
+    printf("%12.6f event-%u", time, r[0]);
+    for(i = 0; i < 5; i++) {
+      printf(" %ld", args[i]);
+    }
+    printf("\n");
+    return;
+  }
+  printf("%12.6f %-12s", time, e->name);
+  for(i = 0; i < 5; i++) {
+    if(e->label[i] != NULL) {
+      printf(" %s=%ld", e->label[i], args[i]);
+    }
+  }
+  printf("\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+text(int c)
+{
+  if(!quiet && !csv) {
+    putchar(c);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Bytes read ahead of a damaged frame, to scan again */
+static uint8_t pushback[RECORD_LEN + 1];
+static int pushback_len;
+/*---------------------------------------------------------------------------*/
+static int
+next_byte(FILE *f)
+{
+  if(pushback_len > 0) {
+    return pushback[--pushback_len];
+  }
+  return getc(f);
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_trace(FILE *f)
+{
+  uint8_t frame[RECORD_LEN + 1];
+  uint8_t sum;
+  int c;
+  int i;
+
+  pushback_len = 0;
+  while((c = next_byte(f)) != EOF) {
+    if(c != FRAME_START1) {
+      text(c);
+      continue;
+    }
+    c = next_byte(f);
+    if(c != FRAME_START2) {
+      text(FRAME_START1);
+      if(c == EOF) {
+        break;
+      }
+      pushback[pushback_len++] = c;
+      continue;
+    }
+    sum = 0;
+    for(i = 0; i < sizeof(frame); i++) {
+      c = next_byte(f);
+      if(c == EOF) {
+        break;
+      }
+      frame[i] = c;
+      sum += c;
+    }
+    if(i < sizeof(frame)) {
+      bad_frames++;
+      break;
+    }
+    if(sum != 0) {
+      /* Not a record after all, or a damaged one: pass the start marker
+         on as text and scan the bytes that followed it again */
+      bad_frames++;
+      text(FRAME_START1);
+      text(FRAME_START2);
+      for(i = sizeof(frame) - 1; i >= 0; i--) {
+        pushback[pushback_len++] = frame[i];
+      }
+      continue;
+    }
+    decode(frame);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr, "usage: nettrace-decode [-q] [-c] [-r ticks-per-second] [file...]\n");
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  FILE *f;
+  int c;
+
+  while((c = getopt(argc, argv, "qcr:")) != -1) {
+    switch(c) {
+    case 'q':
+      quiet = 1;
+      break;
+    case 'c':
+      csv = 1;
+      break;
+    case 'r':
+      ticks_per_second = strtoul(optarg, NULL, 0);
+      if(ticks_per_second == 0) {
+        usage();
+      }
+      break;
+    default:
+      usage();
+    }
+  }
+
+  if(optind == argc) {
+    read_trace(stdin);
+  }
+  for(; optind < argc; optind++) {
+    f = fopen(argv[optind], "rb");
+    if(f == NULL) {
+      perror(argv[optind]);
+      return 1;
+    }
+    have_ticks = 0;
+    read_trace(f);
+    fclose(f);
+  }
+
+  fprintf(stderr, "nettrace-decode: %lu records, %lu bad frames\n",
+          records, bad_frames);
+  return 0;
+}